@@ -134,6 +134,9 @@ project "gluttony"
 
 	filter "files:vendor/ImGuizmo/**.cpp"
 		flags { "NoPCH" }
+
+	filter "files:src/**_AVX2.cpp"									-- kernels dispatched at runtime, AVX2 is enabled inside the file (#pragma GCC target), see util/math/simd.h
+		buildoptions { "-ffp-contract=off" }								-- no implicit FMA, keeps the edge tests of the watertight kernels exactly antisymmetric
 	
 	filter "system:linux"
 		systemversion "latest"
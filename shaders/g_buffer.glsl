@@ -0,0 +1,38 @@
+#version 430
+
+// Rasterized primary visibility for the hybrid mode of the ray tracer, see g_buffer.h.
+// Compiled twice, create_program() (shader_program.cpp) defines VERTEX_STAGE or FRAGMENT_STAGE after the #version line.
+// Outputs match what traverseBVH() in [include/bvh_traversal.glsl] would return for the pixel center.
+
+uniform mat4 u_view_proj;
+uniform vec3 u_cam_pos;
+
+#ifdef VERTEX_STAGE
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+
+out vec3 v_position;
+out vec3 v_normal;
+
+void main() {
+    v_position = a_position;
+    v_normal = a_normal;
+    gl_Position = u_view_proj * vec4(a_position, 1.0);
+}
+
+#endif
+#ifdef FRAGMENT_STAGE
+
+in vec3 v_position;
+in vec3 v_normal;
+
+layout(location = 0) out vec4 SurfaceOut;       // interpolated normal, distance along the camera ray
+layout(location = 1) out uint TriangleOut;      // index of the triangle + 1, 0 is cleared background
+
+void main() {
+    SurfaceOut = vec4(normalize(v_normal), length(v_position - u_cam_pos));
+    TriangleOut = uint(gl_PrimitiveID) + 1u;
+}
+
+#endif
@@ -0,0 +1,154 @@
+// BVH traversal of the mesh in [mesh_data.glsl]: closest hit for camera rays and an any-hit occlusion query for shadow rays.
+
+#include "mesh_data.glsl"
+#include "traversal_stats.glsl"
+
+const float EPSILON = 1e-4;
+
+bool intersect_ray_sphere(ray r, vec3 center, float radius, out float t_out) {
+    const vec3 oc = r.origin - center;
+    const float b = dot(oc, r.dir);
+    const float c = dot(oc, oc) - radius * radius;
+    const float disc = b * b - c;
+    if (disc < 0.0) return false;
+    
+    const float sqrt_disc = sqrt(disc);
+    t_out = -b - sqrt_disc;
+    return t_out > 0.0;
+}
+
+bool intersect_ray_triangle(ray r, vec3 v0, vec3 v1, vec3 v2, out float t, out float u, out float v) {
+    const vec3 e1 = v1 - v0;
+    const vec3 e2 = v2 - v0;
+    const vec3 h = cross(r.dir, e2);
+    const float a = dot(e1, h);
+    
+    if (abs(a) < EPSILON) return false;
+    
+    const float f = 1.0 / a;
+    const vec3 s = r.origin - v0;
+    u = f * dot(s, h);
+    if (u < 0.0 || u > 1.0) return false;
+    
+    const vec3 q = cross(s, e1);
+    v = f * dot(r.dir, q);
+    if (v < 0.0 || u + v > 1.0) return false;
+    
+    t = f * dot(e2, q);
+    return t > EPSILON;
+}
+
+bool intersectAABB(ray r, vec3 aabbMin, vec3 aabbMax, out float t_min, out float t_max) {
+    vec3 invDir = 1.0 / r.dir;
+    vec3 t0 = (aabbMin - r.origin) * invDir;
+    vec3 t1 = (aabbMax - r.origin) * invDir;
+    
+    // Handle NaN when direction component is 0
+    vec3 tmin = min(t0, t1);
+    vec3 tmax = max(t0, t1);
+    
+    t_min = max(max(tmin.x, tmin.y), tmin.z);
+    t_max = min(min(tmax.x, tmax.y), tmax.z);
+    
+    return t_max >= max(t_min, 0.0);
+}
+
+
+struct HitInfo {
+    float t;
+    vec3 normal;
+    bool hit;
+};
+
+HitInfo traverseBVH(ray r) {
+
+    HitInfo bestHit;
+    bestHit.t = 1e30;
+    bestHit.hit = false;
+    STATS_COUNT(STATS_RAYS);
+    
+    uint stack[32];
+    int ptr = 0;
+    stack[ptr++] = 0; // Start with root node
+    while (ptr > 0) {
+        
+        // Check ray against AABB
+        BVHNode node = get_node(stack[--ptr]);
+        uint left_node = node.left_and_count & 0xFFFFu;
+        uint tri_count = (node.left_and_count >> 16) & 0xFFFFu;
+
+        STATS_COUNT(STATS_NODES_VISITED);
+        float t_min, t_max;
+        if (!intersectAABB(r, node.AABB_min, node.AABB_max, t_min, t_max)) continue;
+        if (t_min > bestHit.t) continue;
+
+        if (tri_count > 0) { // Leaf node
+            for (uint i = 0; i < tri_count; i++) {
+                uint triIndex = get_tri_index(node.first_tri_index + i);
+                uint idx0 = get_index(triIndex * 3);
+                uint idx1 = get_index(triIndex * 3 + 1);
+                uint idx2 = get_index(triIndex * 3 + 2);
+                
+                Vertex v0 = get_vertex(idx0);
+                Vertex v1 = get_vertex(idx1);
+                Vertex v2 = get_vertex(idx2);
+                
+                STATS_COUNT(STATS_TRIANGLES_TESTED);
+                float t, u, v;
+                if (intersect_ray_triangle(r, v0.position, v1.position, v2.position, t, u, v)) {
+                    if (t < bestHit.t && t > EPSILON) {
+                        bestHit.t = t;
+                        bestHit.normal = normalize((1.0 - u - v) * v0.normal + u * v1.normal + v * v2.normal);
+                        bestHit.hit = true;
+                    }
+                }
+            }
+        } else { // Internal node
+            stack[ptr++] = left_node + 1; // Right child
+            stack[ptr++] = left_node;     // Left child
+        }
+    }
+    return bestHit;
+}
+
+// Occlusion query for shadow rays: returns at the first triangle in [t_min, t_max],
+// skips normal interpolation and visits the child closer along the ray direction first
+bool occluded(ray r, float t_min, float t_max) {
+
+    STATS_COUNT(STATS_RAYS);
+    uint stack[32];
+    int ptr = 0;
+    stack[ptr++] = 0; // Start with root node
+    while (ptr > 0) {
+
+        BVHNode node = get_node(stack[--ptr]);
+        uint left_node = node.left_and_count & 0xFFFFu;
+        uint tri_count = (node.left_and_count >> 16) & 0xFFFFu;
+
+        STATS_COUNT(STATS_NODES_VISITED);
+        float box_min, box_max;
+        if (!intersectAABB(r, node.AABB_min, node.AABB_max, box_min, box_max)) continue;
+        if (box_min > t_max || box_max < t_min) continue;
+
+        if (tri_count > 0) { // Leaf node
+            for (uint i = 0; i < tri_count; i++) {
+                uint triIndex = get_tri_index(node.first_tri_index + i);
+                vec3 p0 = get_vertex(get_index(triIndex * 3)).position;
+                vec3 p1 = get_vertex(get_index(triIndex * 3 + 1)).position;
+                vec3 p2 = get_vertex(get_index(triIndex * 3 + 2)).position;
+
+                STATS_COUNT(STATS_TRIANGLES_TESTED);
+                float t, u, v;
+                if (intersect_ray_triangle(r, p0, p1, p2, t, u, v) && t >= t_min && t <= t_max)
+                    return true;
+            }
+        } else { // Internal node, push far child first so the near one is popped next
+            vec3 left_center = get_node(left_node).AABB_min + get_node(left_node).AABB_max;
+            vec3 right_center = get_node(left_node + 1).AABB_min + get_node(left_node + 1).AABB_max;
+            bool left_first = dot(right_center - left_center, r.dir) >= 0.0;
+            stack[ptr++] = left_first ? left_node + 1 : left_node;
+            stack[ptr++] = left_first ? left_node : left_node + 1;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,44 @@
+// Mesh data of the ray tracer: shared buffers of all meshes (mesh_pool.h), the arrays of a mesh keep mesh relative indices.
+// Layouts are the std430 twins of geometry::vertex and geometry::BVH_node.
+
+uniform uvec4 u_mesh_offsets;       // first vertex, first index, first BVH node and first triIdx entry of the traced mesh
+
+struct ray {
+    vec3 origin;
+    vec3 dir;
+};
+
+struct Vertex {
+    vec3 position;
+    float uv_x;
+    vec3 normal;
+    float uv_y;
+};
+
+struct BVHNode {
+    vec3 AABB_min;
+    uint left_and_count;
+    vec3 AABB_max;
+    uint first_tri_index;
+};
+
+layout(std430, binding = 0) buffer verticesBuffer {
+    Vertex vertices[];
+};
+
+layout(std430, binding = 1) buffer indicesBuffer {
+    uint indices[];
+};
+
+layout(std430, binding = 2) buffer bvhBuffer {
+    BVHNode bvh_nodes[];
+};
+
+layout(std430, binding = 3) buffer triIdxBuffer {
+    uint triIdx[];
+};
+
+Vertex get_vertex(uint index) { return vertices[u_mesh_offsets.x + index]; }
+uint get_index(uint index) { return indices[u_mesh_offsets.y + index]; }
+BVHNode get_node(uint index) { return bvh_nodes[u_mesh_offsets.z + index]; }
+uint get_tri_index(uint index) { return triIdx[u_mesh_offsets.w + index]; }
@@ -0,0 +1,173 @@
+// Ray tracer of the editor viewport, the body of ray_tracer_intor.frag and RT_optimize_BVH_struct.frag (included after their #version line).
+// Permutations (COLLECT_TRAVERSAL_STATS, ANY_HIT_SHADOWS) are defined by GL_renderer, see shader_preprocessor.h.
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+// 1 => shadow rays stop at the first occluder (occluded()), 0 => closest hit traversal, the reference to measure the any-hit query against.
+//      GL_renderer defines it from [soft_shadow_settings::any_hit]
+#ifndef ANY_HIT_SHADOWS
+#define ANY_HIT_SHADOWS 1
+#endif
+
+uniform int u_bvh_viz_bounds_depth;
+uniform int u_bvh_viz_triangle_depth;
+uniform vec4 u_bvh_viz_color;
+
+// ------ camera and frame data, written once per frame (std140 twin of [frame_uniforms] in GL_renderer.h) ------
+layout(std140, binding = 0) uniform frame_block {
+    mat4 u_inv_proj;
+    mat4 u_inv_view;
+    vec3 u_cam_pos;
+    float u_time;
+    vec2 u_resolution;
+    vec2 u_mouse;
+
+    // temporal reuse: last frame's hits reprojected into this camera by reproject.comp (normal.xyz, t  -  t > 0 hit, t < 0 miss, 0 invalid)
+    int u_reuse_enabled;
+    int u_refresh_period;           // every pixel is traced again at least once per period, in a rotating pattern
+    int u_frame_index;
+
+    // time slicing, only every [u_slice_count]th scanline is traced per frame
+    int u_slice_count;              // 1 traces every pixel
+    int u_slice_index;
+
+    // soft shadows from a disk light, samples come from the sampling functions below
+    float u_light_radius;           // tangent of the angular radius of the light, 0 => hard shadows
+    int u_shadow_samples;           // shadow rays per lit pixel and frame
+    int u_sample_pattern;           // SAMPLE_PATTERN_*
+
+    // hybrid rendering, primary hits come from the rasterized G-buffer (g_buffer.h), only shadow rays are traced
+    int u_rasterized_primary;
+};
+
+layout(binding = 1, rgba32f) uniform readonly image2D u_reprojected;
+layout(binding = 0, offset = 0) uniform atomic_uint u_traced_pixels;
+layout(binding = 2) uniform sampler2D u_blue_noise;
+layout(binding = 4, rgba32f) uniform readonly image2D u_g_buffer_surface;     // normal.xyz, distance along the camera ray
+layout(binding = 5, r32ui) uniform readonly uimage2D u_g_buffer_triangle;     // triangle index + 1, 0 => no surface
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 HistoryOut;   // this frame's hit in the same encoding, reprojected next frame
+
+// ================================ define data ================================
+
+const float SHADOW_BIAS = 1e-3;     // offset along the normal so shadow rays do not start inside the surface
+
+#include "bvh_traversal.glsl"
+#include "sampling.glsl"
+
+// ================================ functions ================================
+
+ray create_camera_ray(vec2 pixel_coord) {
+
+    const vec2 uv = (pixel_coord / u_resolution) * 2.0 - 1.0;
+    const vec4 ray_clip = vec4(uv.x, uv.y, -1.0, 1.0);
+    vec4 ray_eye = u_inv_proj * ray_clip;
+    ray_eye = vec4(ray_eye.xy, -1.0, 0.0);  // Forward direction
+    const vec3 ray_world = normalize((u_inv_view * ray_eye).xyz);
+    return ray(u_cam_pos, ray_world);
+}
+
+bool shadow_ray_blocked(ray r) {
+#if ANY_HIT_SHADOWS
+    return occluded(r, EPSILON, 1e30);
+#else
+    return traverseBVH(r).hit;
+#endif
+}
+
+// fraction of the light disk visible from [origin], a single ray to its center without [u_light_radius]
+float light_visibility(vec3 origin, vec3 light_dir, uvec2 pixel) {
+    if (u_light_radius <= 0.0)
+        return shadow_ray_blocked(ray(origin, light_dir)) ? 0.0 : 1.0;
+
+    const vec3 helper = abs(light_dir.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    const vec3 tangent = normalize(cross(helper, light_dir));
+    const vec3 bitangent = cross(light_dir, tangent);
+    const uint samples = uint(max(u_shadow_samples, 1));
+    float visible = 0.0;
+    for (uint x = 0u; x < samples; x++) {
+        const vec2 disk = concentric_disk(sample_2D(pixel, uint(u_frame_index) * samples + x)) * u_light_radius;
+        if (!shadow_ray_blocked(ray(origin, normalize(light_dir + tangent * disk.x + bitangent * disk.y))))
+            visible += 1.0;
+    }
+    return visible / float(samples);
+}
+
+// ================================ temporal reuse ================================
+
+bool is_refresh_pixel(ivec2 pixel) {
+    return (uint(pixel.x) + uint(pixel.y) * 7u) % uint(u_refresh_period) == uint(u_frame_index) % uint(u_refresh_period);
+}
+
+// primary hit of this pixel, from the G-buffer or the reprojected hits when possible
+HitInfo primary_hit(ray cam_ray) {
+
+    const ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (u_rasterized_primary != 0) {
+        HitInfo hit;
+        const vec4 surface = imageLoad(u_g_buffer_surface, pixel);
+        hit.hit = imageLoad(u_g_buffer_triangle, pixel).r != 0u;
+        hit.t = hit.hit ? surface.w : 1e30;
+        hit.normal = surface.xyz;
+        return hit;
+    }
+
+#if !COLLECT_TRAVERSAL_STATS            // statistics and heatmap need the traversal of every pixel
+    if (u_reuse_enabled != 0 && !is_refresh_pixel(pixel)) {
+
+        const vec4 cached = imageLoad(u_reprojected, pixel);
+        if (cached.w != 0.0) {
+            HitInfo hit;
+            hit.hit = cached.w > 0.0;
+            hit.t = hit.hit ? cached.w : 1e30;
+            hit.normal = cached.xyz;
+            return hit;
+        }
+    }
+#endif
+    atomicCounterIncrement(u_traced_pixels);
+    return traverseBVH(cam_ray);
+}
+
+// ================================ main ================================
+
+void main() {
+    // scanlines of other slices keep the color they got when they were traced last
+    if (u_slice_count > 1 && int(gl_FragCoord.y) % u_slice_count != u_slice_index)
+        discard;
+
+    ray cam_ray = create_camera_ray(gl_FragCoord.xy);
+    const vec3 light_source = normalize(u_cam_pos + vec3(1.0 + sin(u_time * 2.0), 1.0, -1.0));
+    vec3 color = vec3(0.0);
+    
+    HitInfo hitInfo = primary_hit(cam_ray);
+    HistoryOut = hitInfo.hit ? vec4(hitInfo.normal, hitInfo.t) : vec4(0.0, 0.0, 0.0, -1.0);
+    // vec3 viz_color = visualizeBVH(cam_ray, hitInfo.hit ? hitInfo.t : 1e30);
+
+    if (hitInfo.hit) {
+        float brightness = max(dot(light_source, hitInfo.normal), 0.0);
+        if (brightness > 0.0) {
+            const vec3 hit_pos = cam_ray.origin + cam_ray.dir * hitInfo.t + hitInfo.normal * SHADOW_BIAS;
+            brightness *= light_visibility(hit_pos, light_source, uvec2(gl_FragCoord.xy));
+        }
+        color = vec3(0.5, 0.5, 0.8) * brightness; // Use mesh color or material
+    } else {
+        // Background color
+        color = mix(vec3(0.2, 0.2, 0.3), vec3(0.1, 0.4, 0.9), max(0.0, cam_ray.dir.y));
+    }
+    
+    // color = mix(color, viz_color, length(viz_color));
+
+#if COLLECT_TRAVERSAL_STATS
+    for (uint counter = STATS_RAYS; counter <= STATS_TRIANGLES_TESTED; counter++)
+        stats_flush(counter);
+    const uint cost = g_stats[STATS_NODES_VISITED] + g_stats[STATS_TRIANGLES_TESTED];
+    imageStore(u_traversal_cost, ivec2(gl_FragCoord.xy), uvec4(cost));
+    if (u_show_heatmap != 0)
+        color = heatmap_color(cost, u_heatmap_max);
+#endif
+    FragColor = vec4(color, 1.0);
+}
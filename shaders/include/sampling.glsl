@@ -0,0 +1,90 @@
+// Sampling functions, twins of util/math/sampling.h (keep them identical).
+// Expects [u_blue_noise] (the void-and-cluster tile) and [u_sample_pattern] to be declared by the including shader.
+
+const float HALF_PI = 1.57079632679;
+const float QUARTER_PI = 0.78539816339;
+
+const int SAMPLE_PATTERN_SOBOL_OWEN = 0;
+const int SAMPLE_PATTERN_BLUE_NOISE = 1;
+const uint BLUE_NOISE_TILE_SIZE = 64u;
+
+const uint SOBOL_DIRECTIONS[4 * 32] = uint[](
+    0x80000000u, 0x40000000u, 0x20000000u, 0x10000000u, 0x08000000u, 0x04000000u, 0x02000000u, 0x01000000u,
+    0x00800000u, 0x00400000u, 0x00200000u, 0x00100000u, 0x00080000u, 0x00040000u, 0x00020000u, 0x00010000u,
+    0x00008000u, 0x00004000u, 0x00002000u, 0x00001000u, 0x00000800u, 0x00000400u, 0x00000200u, 0x00000100u,
+    0x00000080u, 0x00000040u, 0x00000020u, 0x00000010u, 0x00000008u, 0x00000004u, 0x00000002u, 0x00000001u,
+    0x80000000u, 0xc0000000u, 0xa0000000u, 0xf0000000u, 0x88000000u, 0xcc000000u, 0xaa000000u, 0xff000000u,
+    0x80800000u, 0xc0c00000u, 0xa0a00000u, 0xf0f00000u, 0x88880000u, 0xcccc0000u, 0xaaaa0000u, 0xffff0000u,
+    0x80008000u, 0xc000c000u, 0xa000a000u, 0xf000f000u, 0x88008800u, 0xcc00cc00u, 0xaa00aa00u, 0xff00ff00u,
+    0x80808080u, 0xc0c0c0c0u, 0xa0a0a0a0u, 0xf0f0f0f0u, 0x88888888u, 0xccccccccu, 0xaaaaaaaau, 0xffffffffu,
+    0x80000000u, 0xc0000000u, 0x60000000u, 0x90000000u, 0xe8000000u, 0x5c000000u, 0x8e000000u, 0xc5000000u,
+    0x68800000u, 0x9cc00000u, 0xee600000u, 0x55900000u, 0x80680000u, 0xc09c0000u, 0x60ee0000u, 0x90550000u,
+    0xe8808000u, 0x5cc0c000u, 0x8e606000u, 0xc5909000u, 0x6868e800u, 0x9c9c5c00u, 0xeeee8e00u, 0x5555c500u,
+    0x8000e880u, 0xc0005cc0u, 0x60008e60u, 0x9000c590u, 0xe8006868u, 0x5c009c9cu, 0x8e00eeeeu, 0xc5005555u,
+    0x80000000u, 0xc0000000u, 0x20000000u, 0x50000000u, 0xf8000000u, 0x74000000u, 0xa2000000u, 0x93000000u,
+    0xd8800000u, 0x25400000u, 0x59e00000u, 0xe6d00000u, 0x78080000u, 0xb40c0000u, 0x82020000u, 0xc3050000u,
+    0x208f8000u, 0x51474000u, 0xfbea2000u, 0x75d93000u, 0xa0858800u, 0x914e5400u, 0xdbe79e00u, 0x25db6d00u,
+    0x58800080u, 0xe54000c0u, 0x79e00020u, 0xb6d00050u, 0x800800f8u, 0xc00c0074u, 0x200200a2u, 0x50050093u
+);
+
+uint sobol(uint index, uint dimension) {
+    uint result = 0u;
+    for (uint bit = 0u; index != 0u; index >>= 1u, bit++)
+        if ((index & 1u) != 0u)
+            result ^= SOBOL_DIRECTIONS[dimension * 32u + bit];
+    return result;
+}
+
+uint nested_uniform_scramble(uint value, uint seed) {
+    value = bitfieldReverse(value);
+    value += seed;
+    value ^= value * 0x6c50b47cu;
+    value ^= value * 0xb82f1e52u;
+    value ^= value * 0xc7afe638u;
+    value ^= value * 0x8d22f6e6u;
+    return bitfieldReverse(value);
+}
+
+uint hash_combine(uint seed, uint value) { return seed ^ (value + (seed << 6) + (seed >> 2)); }
+
+uint hash(uint value) {
+    value = value * 747796405u + 2891336453u;
+    value = ((value >> ((value >> 28u) + 4u)) ^ value) * 277803737u;
+    return (value >> 22u) ^ value;
+}
+
+uint pixel_seed(uvec2 pixel) { return hash(hash_combine(hash(pixel.x), pixel.y)); }
+
+float to_unit_float(uint value) { return float(value >> 8) * (1.0 / 16777216.0); }
+
+vec2 sobol_owen_2D(uint index, uint seed) {
+    const uint shuffled_index = nested_uniform_scramble(index, seed);
+    return vec2(to_unit_float(nested_uniform_scramble(sobol(shuffled_index, 0u), hash_combine(seed, 0u))),
+                to_unit_float(nested_uniform_scramble(sobol(shuffled_index, 1u), hash_combine(seed, 1u))));
+}
+
+vec2 blue_noise_2D(uvec2 pixel, uint index) {
+    const vec2 rotation = vec2(texelFetch(u_blue_noise, ivec2(pixel % BLUE_NOISE_TILE_SIZE), 0).r,
+                               texelFetch(u_blue_noise, ivec2((pixel + BLUE_NOISE_TILE_SIZE / 2u) % BLUE_NOISE_TILE_SIZE), 0).r);
+    return fract(rotation + vec2(to_unit_float(sobol(index, 0u)), to_unit_float(sobol(index, 1u))));
+}
+
+vec2 sample_2D(uvec2 pixel, uint index) {
+    return (u_sample_pattern == SAMPLE_PATTERN_BLUE_NOISE) ? blue_noise_2D(pixel, index) : sobol_owen_2D(index, pixel_seed(pixel));
+}
+
+vec2 concentric_disk(vec2 u) {
+    const vec2 offset = u * 2.0 - 1.0;
+    if (offset.x == 0.0 && offset.y == 0.0)
+        return vec2(0.0);
+
+    float radius, theta;
+    if (abs(offset.x) > abs(offset.y)) {
+        radius = offset.x;
+        theta = QUARTER_PI * (offset.y / offset.x);
+    } else {
+        radius = offset.y;
+        theta = HALF_PI - QUARTER_PI * (offset.x / offset.y);
+    }
+    return radius * vec2(cos(theta), sin(theta));
+}
@@ -0,0 +1,40 @@
+// 1 => count rays, visited BVH nodes and tested triangles of every pixel (see traversal_statistics.h), costs registers and bandwidth on every ray.
+//      GL_renderer builds this permutation by defining it while [traversal_stats_settings] are enabled
+#ifndef COLLECT_TRAVERSAL_STATS
+#define COLLECT_TRAVERSAL_STATS 0
+#endif
+
+#if COLLECT_TRAVERSAL_STATS
+const uint STATS_RAYS = 0u;
+const uint STATS_NODES_VISITED = 1u;
+const uint STATS_TRIANGLES_TESTED = 2u;
+
+uniform int u_show_heatmap;         // 1 => the pixel shows its cost instead of the shading
+uniform uint u_heatmap_max;         // cost shown as the hottest color
+layout(binding = 3, r32ui) uniform writeonly uimage2D u_traversal_cost;
+
+// 64 bit counters of the whole frame as (low, high) word pairs
+layout(std430, binding = 4) buffer traversalStatsBuffer {
+    uint stats_counters[];
+};
+
+// work of this invocation, kept in registers and flushed once at the end of main()
+uint g_stats[3] = uint[](0u, 0u, 0u);
+#define STATS_COUNT(counter) g_stats[counter]++
+
+void stats_flush(uint counter) {
+    const uint previous = atomicAdd(stats_counters[counter * 2u], g_stats[counter]);
+    if (previous + g_stats[counter] < previous)         // carry into the high word
+        atomicAdd(stats_counters[counter * 2u + 1u], 1u);
+}
+
+// blue over green to red up to [max_cost], white above it, twin of heatmap_color() in traversal_heatmap.h
+vec3 heatmap_color(uint cost, uint max_cost) {
+    if (cost > max_cost)
+        return vec3(1.0);
+    const float x = float(cost) / float(max(max_cost, 1u));
+    return clamp(vec3(1.5) - abs(vec3(4.0 * x - 3.0, 4.0 * x - 2.0, 4.0 * x - 1.0)), 0.0, 1.0);
+}
+#else
+#define STATS_COUNT(counter)
+#endif
@@ -0,0 +1,53 @@
+#version 430
+
+// Scales the traced image to the window, see upscaler.h.
+// Compiled twice, create_program() (shader_program.cpp) defines VERTEX_STAGE or FRAGMENT_STAGE after the #version line.
+
+#ifdef VERTEX_STAGE
+
+out vec2 v_uv;
+
+void main() {
+    // one triangle covering the window, no vertex buffer
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    v_uv = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+#endif
+#ifdef FRAGMENT_STAGE
+
+uniform sampler2D u_source;             // bilinear sampler
+uniform vec2 u_source_scale;            // render extent / texture size, the frame covers the lower left part of the target
+uniform float u_sharpness;              // 0 => plain bilinear
+
+in vec2 v_uv;
+
+layout(location = 0) out vec4 FragColor;
+
+// keeps the bilinear footprint inside the render extent, the rest of the target holds older or bigger frames
+vec3 fetch(vec2 uv, vec2 texel) {
+    return texture(u_source, clamp(uv, texel * 0.5, u_source_scale - texel * 0.5)).rgb;
+}
+
+void main() {
+    vec2 texel = 1.0 / vec2(textureSize(u_source, 0));
+    vec2 uv = v_uv * u_source_scale;
+    vec3 center = fetch(uv, texel);
+
+    if (u_sharpness > 0.0) {
+        // unsharp mask over the direct neighbours of the source texel, clamped to their range so edges get no halos
+        vec3 north = fetch(uv + vec2(0.0, texel.y), texel);
+        vec3 south = fetch(uv - vec2(0.0, texel.y), texel);
+        vec3 east = fetch(uv + vec2(texel.x, 0.0), texel);
+        vec3 west = fetch(uv - vec2(texel.x, 0.0), texel);
+        vec3 minimum = min(center, min(min(north, south), min(east, west)));
+        vec3 maximum = max(center, max(max(north, south), max(east, west)));
+        vec3 blurred = (north + south + east + west) * 0.25;
+        center = clamp(center + (center - blurred) * (2.0 * u_sharpness), minimum, maximum);
+    }
+
+    FragColor = vec4(center, 1.0);
+}
+
+#endif
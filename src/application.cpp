@@ -2,15 +2,19 @@
 #include "util/pch.h"
 
 #define GLFW_INCLUDE_VULKAN
+#include <charconv>
 #include <GLFW/glfw3.h>
 
 #include "util/util.h"
+#include "util/jobs/job_system.h"
 #include "engine/events/event.h"
 #include "engine/events/application_event.h"
 #include "engine/events/mouse_event.h"
 #include "engine/events/key_event.h"
 #include "engine/render/renderer.h"
 #include "engine/render/open_GL/GL_renderer.h"
+#include "engine/render/CPU/batch_renderer.h"
+#include "benchmark/benchmark.h"
 #include "engine/platform/window.h"
 
 #include "layer/layer.h"
@@ -44,6 +48,18 @@ namespace GLT {
         s_instance = this;
     
         LOG(Trace, "init engine")
+        parse_arguments(argc, argv);
+
+        jobs::settings job_settings{};
+        job_settings.worker_count = m_job_threads;
+        job_settings.pin_workers = m_pin_job_threads;
+        jobs::init(job_settings);
+
+        if (m_headless) {
+
+            LOG(Info, "Running in headless batch mode, skipping window and renderer creation")
+            return;
+        }
     
         // ---------------------------------------- general subsystems ----------------------------------------
         set_fps_settings(m_target_fps);
@@ -68,13 +84,20 @@ namespace GLT {
     
     application::~application() {
     
-        m_layerstack->pop_overlay(m_imgui_layer);
-		delete m_imgui_layer;
-		m_imgui_layer = nullptr;
+        // finish the jobs and the coroutines waiting for the main thread while the layers and the renderer still exist
+        jobs::shutdown();
+        jobs::run_main_thread_tasks();
+
+        if (m_layerstack) {
 
-		m_layerstack->pop_layer(m_world_layer);
-		delete m_world_layer;
-		m_world_layer = nullptr;
+            m_layerstack->pop_overlay(m_imgui_layer);
+            delete m_imgui_layer;
+            m_imgui_layer = nullptr;
+
+            m_layerstack->pop_layer(m_world_layer);
+            delete m_world_layer;
+            m_world_layer = nullptr;
+        }
 
 		m_renderer.reset();
 		m_layerstack.reset();
@@ -87,26 +110,38 @@ namespace GLT {
     // ==================================================================== main loop ====================================================================
     
     void application::run() {
+
+        if (m_headless) {
+
+            run_headless();
+            return;
+        }
     
         // ---------------------------------------- finished setup ----------------------------------------
         // m_renderer->set_state(system_state::active);
         m_running = true;
         m_window->show_window(true);
         m_window->poll_events();
+        m_renderer->start_render_thread();         // draws frame N while this thread simulates frame N+1
         start_fps_measurement();
     
         while (m_running) {
     
             // PROFILE_SCOPE("run");			
+            m_renderer->begin_frame();				// waits until the render thread started the last frame, input is at most one frame ahead of the image
             m_window->poll_events();				// update internal state
+            jobs::run_main_thread_tasks();			// coroutines continuing on the main thread, e.g. finished asset loads
             
             for (layer* layer : *m_layerstack)		// engine update for all layers [world_layer, debug_layer, imgui_layer]
                 layer->on_update(m_delta_time);
     
-            m_renderer->draw_frame(m_delta_time);
+            m_renderer->draw_frame(m_delta_time);	// builds the UI and hands the frame to the render thread
             limit_fps();
+            // the traced resolution only changes the render side, so its GPU time (packet metrics, a few frames old) drives the scale
+            m_renderer->get_dynamic_resolution_ref().update(m_renderer->get_general_performance_metrik_pointer()->get_GPU_frame_time() / 1000.f, target_duration);
         }
     
+        m_renderer->stop_render_thread();
         LOG(Trace, "Exiting main run loop")
         // application::get().get_renderer().wait_idle();
     }
@@ -150,6 +185,102 @@ namespace GLT {
 
 
     // ==================================================================== PRIVATE ====================================================================
+
+    void application::parse_arguments(int argc, char** argv) {
+
+        // a broken command line ends the run with an error, opening the GUI instead would fail on machines without a display
+        const auto fail = [&](const std::string_view argument, const char* expected) {
+
+            LOG(Error, "Command line argument [" << argument << "] expects " << expected << ", see --help")
+            m_headless = true;
+            m_exit_code = EXIT_FAILURE;
+        };
+        const auto parse_count = [](const char* text, u32& value) {
+
+            const char* end = text + std::strlen(text);
+            const auto [last, error] = std::from_chars(text, end, value);
+            return error == std::errc() && last == end;
+        };
+
+        for (int x = 1; x < argc; x++) {
+
+            const std::string_view argument = argv[x];
+            const bool has_value = (x + 1 < argc);
+            if (argument == "--batch" || argument == "-b") {
+
+                if (!has_value)
+                    return fail(argument, "<config.yml>");
+                m_headless = true;
+                m_batch_config = std::filesystem::absolute(argv[++x]);
+
+            } else if (argument == "--benchmark") {
+
+                if (!has_value)
+                    return fail(argument, "<name>");
+                m_headless = true;
+                m_benchmark = argv[++x];
+
+            } else if (argument == "--mesh") {
+
+                if (!has_value)
+                    return fail(argument, "<path>");
+                m_benchmark_mesh = std::filesystem::absolute(argv[++x]);
+
+            } else if (argument == "--iterations") {
+
+                if (!has_value || !parse_count(argv[++x], m_benchmark_iterations) || m_benchmark_iterations == 0)
+                    return fail(argument, "a <count> above 0");
+
+            } else if (argument == "--job-threads") {
+
+                if (!has_value || !parse_count(argv[++x], m_job_threads))
+                    return fail(argument, "a <count>");
+
+            } else if (argument == "--pin-threads") {
+                m_pin_job_threads = true;
+
+            } else if (argument == "--help" || argument == "-h") {
+
+                std::cout << "usage: gluttony [options]\n"
+                          << "  -b, --batch <config.yml>    render the camera poses of the config to images without opening a window\n"
+                          << "  --benchmark <name>          run a CPU benchmark without opening a window, results are logged\n"
+                          << "  --mesh <path>               mesh used by the benchmark\n"
+                          << "  --iterations <count>        measured iterations per benchmark case (default " << m_benchmark_iterations << ")\n"
+                          << "  --job-threads <count>       worker threads of the job system (default: one per hardware thread)\n"
+                          << "  --pin-threads               bind every job worker to its own core\n"
+                          << "  -h, --help                  show this message\n"
+                          << "benchmarks:";
+                for (const std::string& name : benchmark::get_names())
+                    std::cout << " " << name;
+                std::cout << "\n";
+                m_headless = true;                                      // nothing to do, run() returns immediately
+
+            } else
+                LOG(Warn, "Unknown command line argument [" << argument << "] IGNORED")
+        }
+    }
+
+    void application::run_headless() {
+
+        if (m_exit_code != EXIT_SUCCESS)                                // invalid command line, already reported
+            return;
+
+        if (!m_benchmark.empty()) {
+
+            benchmark::settings settings{};
+            settings.mesh = m_benchmark_mesh;
+            settings.iterations = m_benchmark_iterations;
+            m_exit_code = benchmark::run(m_benchmark, settings) ? EXIT_SUCCESS : EXIT_FAILURE;
+            return;
+        }
+
+        if (m_batch_config.empty())
+            return;
+
+        render::CPU::batch_renderer batch(m_batch_config);
+        m_exit_code = batch.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+        LOG(Info, "Batch render finished " << (m_exit_code == EXIT_SUCCESS ? "successfully" : "with errors"))
+    }
     
     void application::set_fps_settings(u32 target_fps) { target_duration = static_cast<f32>(1.0 / target_fps); }
     
@@ -35,6 +35,8 @@ namespace GLT {
         DEFAULT_GETTER(static ref<window>,							        window);
         DEFAULT_GETTER(UI::imgui_layer*,								    imgui_layer);
         DEFAULT_GETTER(world_layer*,								        world_layer);
+        DEFAULT_GETTER_C(int,											    exit_code)
+        DEFAULT_GETTER_C(bool,											    headless)
         const std::filesystem::path get_project_path();
 
         FORCEINLINE static application& get()								{ return *s_instance; }
@@ -61,6 +63,8 @@ namespace GLT {
     private:
 
         void init_engine();
+        void parse_arguments(int argc, char** argv);
+        void run_headless();
 
         void on_event(event& event);
         bool on_window_close(window_close_event& event);
@@ -77,8 +81,8 @@ namespace GLT {
         static bool					        m_running;
 
         ref<layer_stack>			        m_layerstack{};
-		UI::imgui_layer*			        m_imgui_layer;
-		world_layer*				        m_world_layer;
+		UI::imgui_layer*			        m_imgui_layer{};
+		world_layer*				        m_world_layer{};
 
         std::vector<event>			        m_event_queue;		// TODO: change to queue
         // ref<map>					        m_current_map = nullptr;
@@ -95,6 +99,16 @@ namespace GLT {
         f32							        target_duration{};
         f32							        m_last_frame_time = 0.f;
 
+        // ---------------------- command line ---------------------- 
+        bool                                m_headless = false;             // no window/GPU, set by [--batch] or [--benchmark]
+        std::filesystem::path               m_batch_config{};
+        std::string                         m_benchmark{};
+        std::filesystem::path               m_benchmark_mesh{};
+        u32                                 m_benchmark_iterations = 10;
+        u32                                 m_job_threads = 0;              // workers of the job system, 0 => one per hardware thread
+        bool                                m_pin_job_threads = false;
+        int                                 m_exit_code = EXIT_SUCCESS;
+
     };
 
 }
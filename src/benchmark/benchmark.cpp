@@ -0,0 +1,92 @@
+
+#include "util/pch.h"
+
+#include "geometry/static_mesh.h"
+#include "game_object/camera.h"
+#include "factories/mesh/asset_importer.h"
+
+#include "benchmark.h"
+
+
+namespace GLT::benchmark {
+
+    struct entry {
+        const char*                         name;
+        bool                                (*function)(const settings&);
+    };
+
+    static const entry s_benchmarks[] = {
+        { "shadow_rays",                    shadow_rays },
+        { "intersection_kernels",           intersection_kernels },
+        { "sample_convergence",             sample_convergence },
+        { "primary_visibility",             primary_visibility },
+    };
+
+
+    bool run(const std::string& name, const settings& settings) {
+
+        for (const entry& benchmark : s_benchmarks) {
+
+            if (name != benchmark.name)
+                continue;
+
+            LOG(Info, "running benchmark [" << name << "] mesh [" << settings.mesh.generic_string() << "] resolution [" << settings.width << "x" << settings.height << "] iterations [" << settings.iterations << "]");
+            return benchmark.function(settings);
+        }
+
+        LOG(Error, "Unknown benchmark [" << name << "]");
+        return false;
+    }
+
+    std::vector<std::string> get_names() {
+
+        std::vector<std::string> names{};
+        for (const entry& benchmark : s_benchmarks)
+            names.emplace_back(benchmark.name);
+        return names;
+    }
+
+
+    bool load_mesh(const settings& settings, ref<geometry::static_mesh>& mesh) {
+
+        VALIDATE(!settings.mesh.empty(), return false, "", "No mesh provided, use [--mesh <path>]");
+
+        mesh = create_ref<geometry::static_mesh>();
+        VALIDATE(factory::geometry::load_static_mesh(settings.mesh, mesh), return false, "", "Failed to import mesh [" << settings.mesh.generic_string() << "]");
+        mesh->build_BVH(16);
+        LOG(Info, "mesh triangles [" << mesh->indices.size() / 3 << "] BVH nodes [" << mesh->BVH_nodes.size() << "]");
+        return true;
+    }
+
+    void generate_camera_rays(const geometry::static_mesh& mesh, const u32 width, const u32 height, std::vector<geometry::ray>& rays, glm::vec3& camera_position) {
+
+        glm::vec3 center{0.f};
+        f32 radius = 1.f;
+        if (!mesh.BVH_nodes.empty()) {
+            center = (mesh.BVH_nodes[0].AABB_min + mesh.BVH_nodes[0].AABB_max) * .5f;
+            radius = math::max(glm::length(mesh.BVH_nodes[0].AABB_max - center), 0.001f);
+        }
+
+        camera loc_camera{};
+        camera_position = center + glm::vec3(0.f, 0.f, radius * 1.5f);             // camera with zero rotation looks along -Z
+        loc_camera.set_view_XYZ(camera_position, glm::vec3(0.f));
+        const glm::mat4 inv_proj = loc_camera.get_inverse_projection(static_cast<f32>(width) / static_cast<f32>(height));
+        const glm::mat4 inv_view = loc_camera.get_inverse_view();
+
+        rays.resize(static_cast<size_t>(width) * height);
+        for (u32 y = 0; y < height; y++) {
+            for (u32 x = 0; x < width; x++) {
+
+                const glm::vec2 uv = glm::vec2((x + .5f) / width, (y + .5f) / height) * 2.f - 1.f;
+                glm::vec4 ray_eye = inv_proj * glm::vec4(uv.x, uv.y, -1.f, 1.f);
+                ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.f, 0.f);
+
+                geometry::ray& cam_ray = rays[static_cast<size_t>(y) * width + x];
+                cam_ray = geometry::ray{};
+                cam_ray.origin = camera_position;
+                cam_ray.direction = glm::normalize(glm::vec3(inv_view * ray_eye));
+            }
+        }
+    }
+
+}
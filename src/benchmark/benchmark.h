@@ -0,0 +1,76 @@
+#pragma once
+
+#include "geometry/ray_query.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::benchmark {
+
+    // @brief Settings shared by all benchmarks, filled from the command line ([--benchmark <name> --mesh <path> ...])
+    struct settings {
+
+        std::filesystem::path               mesh{};
+        u32                                 width = 1280;
+        u32                                 height = 720;
+        u32                                 iterations = 10;
+    };
+
+    struct timing {
+        f64                                 min_ms = 0.0;
+        f64                                 average_ms = 0.0;
+    };
+
+    // @brief Runs the benchmark with the given name, results are written to the log
+    // @return [bool] false if the benchmark does not exist or could not be set up
+    bool run(const std::string& name, const settings& settings);
+
+    // @brief Names of all registered benchmarks, used for [--help]
+    std::vector<std::string> get_names();
+
+    // ---------------------------------------------------- helpers for individual benchmarks ----------------------------------------------------
+
+    // @brief Imports [settings.mesh] and builds its BVH the same way the renderer does
+    bool load_mesh(const settings& settings, ref<geometry::static_mesh>& mesh);
+
+    // @brief Creates one primary ray per pixel (row by row) from a camera placed in front of the mesh bounds, looking at it
+    // @param [camera_position] receives the camera position, used by shading based benchmarks
+    void generate_camera_rays(const geometry::static_mesh& mesh, const u32 width, const u32 height, std::vector<geometry::ray>& rays, glm::vec3& camera_position);
+
+    // @brief Calls [function] once for warm up and then [iterations] times, measuring each call
+    template<typename func>
+    timing measure(const u32 iterations, func&& function) {
+
+        function();
+        timing result{};
+        result.min_ms = std::numeric_limits<f64>::max();
+        for (u32 x = 0; x < iterations; x++) {
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            function();
+            const f64 duration = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            result.min_ms = math::min(result.min_ms, duration);
+            result.average_ms += duration;
+        }
+        result.average_ms /= math::max(iterations, 1u);
+        return result;
+    }
+
+    // ---------------------------------------------------- benchmarks ----------------------------------------------------
+
+    // @brief Shadow rays from every lit primary hit, traced with geometry::occluded() vs. geometry::intersect() (closest and any hit)
+    bool shadow_rays(const settings& settings);
+
+    // @brief Ray-triangle (Möller-Trumbore, Plücker, watertight) and ray-AABB (slab) kernels in scalar, SSE4.1 and AVX2 against a double precision reference.
+    //        Does not use [settings.mesh], reports throughput, false hits/misses and leaks through shared edges
+    bool intersection_kernels(const settings& settings);
+
+    // @brief Error against sample count of random, Owen-scrambled Sobol and blue noise samples (util/math/sampling.h) on integrals with a known solution.
+    //        With [settings.mesh] also compares soft shadows rendered by the CPU ray tracer against a high sample count reference
+    bool sample_convergence(const settings& settings);
+
+    // @brief Primary visibility from one ray per pixel (geometry::intersect) vs. the binned tile rasterizer of the CPU backend plus hit reconstruction,
+    //        also full CPU frames in both modes. Reports mismatching triangle ids, [settings.mesh] can be a directory to run every mesh in it
+    bool primary_visibility(const settings& settings);
+
+}
@@ -0,0 +1,189 @@
+
+#include "util/pch.h"
+
+#include <random>
+
+#include "intersection_kernels_measure.h"
+
+
+namespace GLT::benchmark {
+
+    using namespace kernels;
+
+    constexpr u32 RAY_COUNT = 4096;                         // multiple of the widest instruction set
+    constexpr u32 TRIANGLE_COUNT = 256;
+    constexpr u32 BOX_COUNT = 256;
+    constexpr u32 EDGE_GRID_SIZE = 16;                      // quads per side of the watertightness test mesh
+
+    static void push_ray(ray_set& rays, const glm::vec3& origin, const glm::vec3& direction) {
+
+        for (u32 axis = 0; axis < 3; axis++) {
+            rays.origin[axis].push_back(origin[axis]);
+            rays.dir[axis].push_back(direction[axis]);
+        }
+    }
+
+    static glm::dvec3 get_origin(const ray_set& rays, const u32 index) { return glm::dvec3(rays.origin[0][index], rays.origin[1][index], rays.origin[2][index]); }
+    static glm::dvec3 get_direction(const ray_set& rays, const u32 index) { return glm::dvec3(rays.dir[0][index], rays.dir[1][index], rays.dir[2][index]); }
+
+    static void generate_test_data(test_data& data) {
+
+        using reference = math::simd::scalar<f64>;
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<f32> unit(-1.f, 1.f);
+        const auto random_vec3 = [&]() { return glm::vec3(unit(generator), unit(generator), unit(generator)); };
+
+        // random rays from a sphere around the unit cube, aimed at random points inside it
+        for (u32 x = 0; x < RAY_COUNT; x++) {
+            const glm::vec3 origin = glm::normalize(random_vec3()) * 4.f;
+            push_ray(data.rays, origin, glm::normalize(random_vec3() - origin));
+        }
+        for (u32 x = 0; x < TRIANGLE_COUNT; x++) {
+            const glm::vec3 center = random_vec3();
+            for (u32 y = 0; y < 3; y++)
+                data.triangles.push_back(center + random_vec3() * .5f);
+        }
+
+        data.reference_hit.resize(static_cast<u64>(RAY_COUNT) * TRIANGLE_COUNT);
+        data.reference_t.resize(data.reference_hit.size());
+        for (u32 ray_index = 0; ray_index < RAY_COUNT; ray_index++) {
+
+            geometry::intersection::ray_block<reference> block{};
+            const glm::dvec3 origin = get_origin(data.rays, ray_index);
+            const glm::dvec3 direction = get_direction(data.rays, ray_index);
+            for (u32 axis = 0; axis < 3; axis++) {
+                block.origin[axis] = origin[axis];
+                block.dir[axis] = direction[axis];
+            }
+            block.t_min = 0.0;
+            block.t_max = 1e30;
+            geometry::intersection::finalize(block);
+            const auto prepared = geometry::intersection::watertight<reference>::prepare(block);
+            for (u32 x = 0; x < TRIANGLE_COUNT; x++) {
+
+                f64 t, u, v;
+                const u64 index = static_cast<u64>(ray_index) * TRIANGLE_COUNT + x;
+                data.reference_hit[index] = geometry::intersection::watertight<reference>::intersect(prepared, block, data.triangles[x * 3], data.triangles[x * 3 + 1], data.triangles[x * 3 + 2], t, u, v);
+                data.reference_t[index] = t;
+            }
+        }
+
+        // bumpy height field, every interior edge is shared by two triangles
+        std::vector<glm::vec3> grid{};
+        for (u32 z = 0; z <= EDGE_GRID_SIZE; z++)
+            for (u32 x = 0; x <= EDGE_GRID_SIZE; x++)
+                grid.emplace_back(static_cast<f32>(x) / EDGE_GRID_SIZE * 2.f - 1.f, unit(generator) * .1f, static_cast<f32>(z) / EDGE_GRID_SIZE * 2.f - 1.f);
+
+        const auto grid_index = [](const u32 x, const u32 z) { return z * (EDGE_GRID_SIZE + 1) + x; };
+        for (u32 z = 0; z < EDGE_GRID_SIZE; z++) {
+            for (u32 x = 0; x < EDGE_GRID_SIZE; x++) {
+
+                const glm::vec3& p00 = grid[grid_index(x, z)];
+                const glm::vec3& p10 = grid[grid_index(x + 1, z)];
+                const glm::vec3& p01 = grid[grid_index(x, z + 1)];
+                const glm::vec3& p11 = grid[grid_index(x + 1, z + 1)];
+                data.edge_mesh.insert(data.edge_mesh.end(), { p00, p01, p10, p10, p01, p11 });
+            }
+        }
+
+        // rays from random points above the field through interior vertices and points on the diagonal edges
+        std::uniform_real_distribution<f32> fraction(0.f, 1.f);
+        while (data.edge_rays.size() < RAY_COUNT) {
+
+            const u32 x = 1 + generator() % (EDGE_GRID_SIZE - 1);
+            const u32 z = 1 + generator() % (EDGE_GRID_SIZE - 1);
+            const glm::vec3 target = (data.edge_rays.size() % 4 == 0) ? grid[grid_index(x, z)] : glm::mix(grid[grid_index(x + 1, z)], grid[grid_index(x, z + 1)], fraction(generator));
+            const glm::vec3 origin = glm::vec3(unit(generator), 2.f + unit(generator), unit(generator)) * 3.f;
+            push_ray(data.edge_rays, origin, target - origin);
+        }
+
+        // random boxes, every 8th ray is parallel to an axis to catch NaN/infinity handling
+        for (u32 x = 0; x < BOX_COUNT; x++) {
+            const glm::vec3 center = random_vec3();
+            const glm::vec3 extent = glm::abs(random_vec3()) * .3f + .01f;
+            data.boxes.push_back(center - extent);
+            data.boxes.push_back(center + extent);
+        }
+        for (u32 x = 0; x < RAY_COUNT; x++) {
+
+            const glm::vec3 origin = glm::normalize(random_vec3()) * 4.f;
+            glm::vec3 direction = glm::normalize(random_vec3() - origin);
+            if (x % 8 == 0)
+                direction[(x / 8) % 3] = 0.f;
+            push_ray(data.box_rays, origin, direction);
+        }
+
+        data.reference_box_hit.resize(static_cast<u64>(RAY_COUNT) * BOX_COUNT);
+        for (u32 ray_index = 0; ray_index < RAY_COUNT; ray_index++) {
+
+            const glm::dvec3 origin = get_origin(data.box_rays, ray_index);
+            const glm::dvec3 direction = get_direction(data.box_rays, ray_index);
+            for (u32 x = 0; x < BOX_COUNT; x++) {
+
+                // exact interval test, axis parallel rays are inside the slab or not at all
+                f64 t_near = 0.0, t_far = 1e30;
+                for (u32 axis = 0; axis < 3; axis++) {
+
+                    const f64 low = data.boxes[x * 2][axis], high = data.boxes[x * 2 + 1][axis];
+                    if (direction[axis] == 0.0) {
+                        if (origin[axis] < low || origin[axis] > high)
+                            t_far = -1.0;
+                        continue;
+                    }
+                    const f64 t0 = (low - origin[axis]) / direction[axis];
+                    const f64 t1 = (high - origin[axis]) / direction[axis];
+                    t_near = math::max(t_near, math::min(t0, t1));
+                    t_far = math::min(t_far, math::max(t0, t1));
+                }
+                data.reference_box_hit[static_cast<u64>(ray_index) * BOX_COUNT + x] = t_near <= t_far;
+            }
+        }
+    }
+
+    static void report(const std::vector<result>& results, const bool triangle_kernels) {
+
+        const result* fastest = nullptr;
+        for (const result& entry : results) {
+
+            if (entry.is_triangle_kernel != triangle_kernels)
+                continue;
+
+            std::ostringstream accuracy{};
+            accuracy << "false hits [" << entry.false_hits << "] false misses [" << entry.false_misses << "]";
+            if (triangle_kernels)
+                accuracy << " max rel. t error [" << std::scientific << std::setprecision(2) << entry.max_relative_t_error << "] leaks [" << entry.leaks << "]";
+
+            LOG(Info, std::left << std::setw(16) << entry.name << std::setw(8) << entry.instruction_set << std::right << std::fixed << std::setprecision(1) << std::setw(10) << entry.million_tests_per_second << " Mtests/s  " << accuracy.str());
+
+            // only kernels that never lose a ray compete, slab tests also have to match the reference exactly
+            const bool exact = triangle_kernels ? entry.leaks == 0 : (entry.false_hits + entry.false_misses) == 0;
+            if (exact && (!fastest || entry.million_tests_per_second > fastest->million_tests_per_second))
+                fastest = &entry;
+        }
+
+        if (fastest)
+            LOG(Info, "fastest exact " << (triangle_kernels ? "triangle" : "slab") << " kernel: [" << fastest->name << "] with [" << fastest->instruction_set << "]")
+        else
+            LOG(Warn, "no " << (triangle_kernels ? "triangle" : "slab") << " kernel passed the exactness checks")
+    }
+
+    bool intersection_kernels(const settings& settings) {
+
+        test_data data{};
+        generate_test_data(data);
+        LOG(Info, "rays [" << RAY_COUNT << "] triangles [" << TRIANGLE_COUNT << "] boxes [" << BOX_COUNT << "] edge rays [" << data.edge_rays.size() << "] reference [double precision watertight]");
+
+        std::vector<result> results{};
+        measure_all<math::simd::scalar<f32>>("scalar", data, settings.iterations, results);
+        measure_all<math::simd::SSE>("SSE4.1", data, settings.iterations, results);
+        if (math::simd::cpu_supports_AVX2())
+            measure_all_AVX2(data, settings.iterations, results);
+        else
+            LOG(Info, "CPU does not support AVX2/FMA, skipping")
+
+        report(results, true);
+        report(results, false);
+        return true;
+    }
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "benchmark.h"
+
+
+// Types shared by [intersection_kernels.cpp] (scalar, SSE4.1) and [intersection_kernels_AVX2.cpp], the measurements are in [intersection_kernels_measure.h].
+// Kept free of the kernels so the AVX2 file can include it (and the std/glm code it uses) before switching the instruction set.
+namespace GLT::benchmark::kernels {
+
+    // rays in SoA layout so every instruction set can load [S::width] lanes directly
+    struct ray_set {
+        std::vector<f32>                    origin[3];
+        std::vector<f32>                    dir[3];
+
+        u32 size() const { return static_cast<u32>(origin[0].size()); }
+    };
+
+    struct test_data {
+        ray_set                             rays{};
+        std::vector<glm::vec3>              triangles{};                // 3 vertices per triangle
+        std::vector<u8>                     reference_hit{};            // double precision watertight result, [ray * triangle_count + triangle]
+        std::vector<f64>                    reference_t{};
+
+        ray_set                             edge_rays{};                // aimed exactly at shared edges/vertices of [edge_mesh]
+        std::vector<glm::vec3>              edge_mesh{};
+
+        ray_set                             box_rays{};                 // includes axis parallel rays
+        std::vector<glm::vec3>              boxes{};                    // min, max per box
+        std::vector<u8>                     reference_box_hit{};        // double precision slab test, [ray * box_count + box]
+    };
+
+    struct result {
+        std::string                         name{};
+        std::string                         instruction_set{};
+        bool                                is_triangle_kernel = true;
+        f64                                 million_tests_per_second = 0.0;
+        u64                                 false_hits = 0;             // compared to the double precision reference
+        u64                                 false_misses = 0;
+        f64                                 max_relative_t_error = 0.0;
+        u64                                 leaks = 0;                  // edge rays that hit no triangle at all
+    };
+
+    // @brief Defined in [intersection_kernels_AVX2.cpp], only call if math::simd::cpu_supports_AVX2()
+    void measure_all_AVX2(const test_data& data, const u32 iterations, std::vector<result>& results);
+
+}
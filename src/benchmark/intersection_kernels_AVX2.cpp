@@ -0,0 +1,20 @@
+
+#include "util/pch.h"
+
+#include "intersection_kernels.h"
+
+// AVX2/FMA is enabled from here on only (instead of -mavx2 for the whole file), so everything included above, std, glm and the shared types,
+// keeps the default instruction set and no AVX2 encoded inline copy of it can end up in the rest of the application
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+#include "intersection_kernels_measure.h"
+
+
+namespace GLT::benchmark::kernels {
+
+    void measure_all_AVX2(const test_data& data, const u32 iterations, std::vector<result>& results) { measure_all<math::simd::AVX2>("AVX2", data, iterations, results); }
+
+}
+
+#pragma GCC pop_options
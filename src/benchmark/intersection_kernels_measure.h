@@ -0,0 +1,148 @@
+#pragma once
+
+#include "geometry/intersection.h"
+
+#include "intersection_kernels.h"
+
+
+// Measurements of [geometry/intersection.h] per instruction set, instantiated by [intersection_kernels.cpp] (scalar, SSE4.1) and [intersection_kernels_AVX2.cpp].
+// The AVX2 file includes this header with AVX2 enabled per function (#pragma GCC target) and must only instantiate it with [math::simd::AVX2],
+// otherwise the linker may pick an AVX2 encoded copy for the other instruction sets.
+namespace GLT::benchmark::kernels {
+
+    template<typename S>
+    FORCEINLINE geometry::intersection::ray_block<S> load_block(const ray_set& rays, const u32 first) {
+
+        geometry::intersection::ray_block<S> block{};
+        for (u32 axis = 0; axis < 3; axis++) {
+            block.origin[axis] = S::load(&rays.origin[axis][first]);
+            block.dir[axis] = S::load(&rays.dir[axis][first]);
+        }
+        block.t_min = S::set1(0);
+        block.t_max = S::set1(static_cast<typename S::scalar_type>(1e30));
+        geometry::intersection::finalize(block);
+        return block;
+    }
+
+    template<typename S, template<typename> class kernel>
+    result measure_triangle_kernel(const char* name, const char* instruction_set, const test_data& data, const u32 iterations) {
+
+        using type = typename S::type;
+        const u32 triangle_count = static_cast<u32>(data.triangles.size() / 3);
+        result loc_result{ name, instruction_set };
+
+        // throughput, every ray block against every triangle
+        u64 hit_count = 0;
+        const timing loc_timing = measure(iterations, [&] {
+
+            hit_count = 0;
+            for (u32 first = 0; first < data.rays.size(); first += S::width) {
+
+                const geometry::intersection::ray_block<S> block = load_block<S>(data.rays, first);
+                const typename kernel<S>::prepared prepared = kernel<S>::prepare(block);
+                for (u32 x = 0; x < triangle_count; x++) {
+                    type t, u, v;
+                    hit_count += std::popcount(static_cast<u32>(S::movemask(kernel<S>::intersect(prepared, block, data.triangles[x * 3], data.triangles[x * 3 + 1], data.triangles[x * 3 + 2], t, u, v))));
+                }
+            }
+        });
+        loc_result.million_tests_per_second = (static_cast<f64>(data.rays.size()) * triangle_count) / (loc_timing.min_ms * 1000.0);
+
+        // accuracy against the double precision reference
+        for (u32 first = 0; first < data.rays.size(); first += S::width) {
+
+            const geometry::intersection::ray_block<S> block = load_block<S>(data.rays, first);
+            const typename kernel<S>::prepared prepared = kernel<S>::prepare(block);
+            for (u32 x = 0; x < triangle_count; x++) {
+
+                type t, u, v;
+                const int mask = S::movemask(kernel<S>::intersect(prepared, block, data.triangles[x * 3], data.triangles[x * 3 + 1], data.triangles[x * 3 + 2], t, u, v));
+                typename S::scalar_type t_lanes[S::width];
+                S::store(t_lanes, t);
+                for (u32 lane = 0; lane < S::width; lane++) {
+
+                    const u64 index = static_cast<u64>(first + lane) * triangle_count + x;
+                    const bool hit = (mask >> lane) & 1;
+                    const bool reference = data.reference_hit[index];
+                    loc_result.false_hits += hit && !reference;
+                    loc_result.false_misses += !hit && reference;
+                    if (hit && reference)
+                        loc_result.max_relative_t_error = math::max(loc_result.max_relative_t_error, std::abs(t_lanes[lane] - data.reference_t[index]) / data.reference_t[index]);
+                }
+            }
+        }
+
+        // watertightness, a ray through a shared edge has to hit at least one of the two triangles
+        const u32 edge_triangle_count = static_cast<u32>(data.edge_mesh.size() / 3);
+        for (u32 first = 0; first < data.edge_rays.size(); first += S::width) {
+
+            const geometry::intersection::ray_block<S> block = load_block<S>(data.edge_rays, first);
+            const typename kernel<S>::prepared prepared = kernel<S>::prepare(block);
+            int hit_lanes = 0;
+            for (u32 x = 0; x < edge_triangle_count; x++) {
+                type t, u, v;
+                hit_lanes |= S::movemask(kernel<S>::intersect(prepared, block, data.edge_mesh[x * 3], data.edge_mesh[x * 3 + 1], data.edge_mesh[x * 3 + 2], t, u, v));
+            }
+            loc_result.leaks += S::width - std::popcount(static_cast<u32>(hit_lanes));
+        }
+
+        LOG(Trace, name << " " << instruction_set << " hits [" << hit_count << "]");
+        return loc_result;
+    }
+
+    template<typename S, typename S::mask (*slab)(const geometry::intersection::ray_block<S>&, const geometry::intersection::vec3<S>&, const geometry::intersection::vec3<S>&, typename S::type&)>
+    result measure_slab_kernel(const char* name, const char* instruction_set, const test_data& data, const u32 iterations) {
+
+        const u32 box_count = static_cast<u32>(data.boxes.size() / 2);
+        result loc_result{ name, instruction_set, false };
+
+        u64 hit_count = 0;
+        const timing loc_timing = measure(iterations, [&] {
+
+            hit_count = 0;
+            for (u32 first = 0; first < data.box_rays.size(); first += S::width) {
+
+                const geometry::intersection::ray_block<S> block = load_block<S>(data.box_rays, first);
+                for (u32 x = 0; x < box_count; x++) {
+                    typename S::type entry;
+                    hit_count += std::popcount(static_cast<u32>(S::movemask(slab(block, data.boxes[x * 2], data.boxes[x * 2 + 1], entry))));
+                }
+            }
+        });
+        loc_result.million_tests_per_second = (static_cast<f64>(data.box_rays.size()) * box_count) / (loc_timing.min_ms * 1000.0);
+
+        for (u32 first = 0; first < data.box_rays.size(); first += S::width) {
+
+            const geometry::intersection::ray_block<S> block = load_block<S>(data.box_rays, first);
+            for (u32 x = 0; x < box_count; x++) {
+
+                typename S::type entry;
+                const int mask = S::movemask(slab(block, data.boxes[x * 2], data.boxes[x * 2 + 1], entry));
+                for (u32 lane = 0; lane < S::width; lane++) {
+
+                    const bool hit = (mask >> lane) & 1;
+                    const bool reference = data.reference_box_hit[static_cast<u64>(first + lane) * box_count + x];
+                    loc_result.false_hits += hit && !reference;
+                    loc_result.false_misses += !hit && reference;
+                }
+            }
+        }
+
+        LOG(Trace, name << " " << instruction_set << " hits [" << hit_count << "]");
+        return loc_result;
+    }
+
+    // @brief Runs every triangle and slab kernel with the instruction set [S]
+    template<typename S>
+    void measure_all(const char* instruction_set, const test_data& data, const u32 iterations, std::vector<result>& results) {
+
+        using namespace geometry::intersection;
+        results.push_back(measure_triangle_kernel<S, moller_trumbore>("moller_trumbore", instruction_set, data, iterations));
+        results.push_back(measure_triangle_kernel<S, plucker>("plucker", instruction_set, data, iterations));
+        results.push_back(measure_triangle_kernel<S, watertight>("watertight", instruction_set, data, iterations));
+        results.push_back(measure_slab_kernel<S, slab_divide<S>>("slab_divide", instruction_set, data, iterations));
+        results.push_back(measure_slab_kernel<S, slab_min_max<S>>("slab_min_max", instruction_set, data, iterations));
+        results.push_back(measure_slab_kernel<S, slab_sign<S>>("slab_sign", instruction_set, data, iterations));
+    }
+
+}
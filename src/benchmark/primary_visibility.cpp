@@ -0,0 +1,119 @@
+
+#include "util/pch.h"
+
+#include "geometry/static_mesh.h"
+#include "game_object/camera.h"
+#include "engine/render/CPU/CPU_ray_tracer.h"
+#include "engine/render/CPU/tile_rasterizer.h"
+
+#include "benchmark.h"
+
+
+namespace GLT::benchmark {
+
+    static bool measure_mesh(const settings& settings) {
+
+        ref<geometry::static_mesh> mesh{};
+        if (!load_mesh(settings, mesh))
+            return false;
+
+        // same camera as generate_camera_rays(), rays are stored bottom-up like the visibility buffer
+        std::vector<geometry::ray> rays{};
+        glm::vec3 camera_position{};
+        generate_camera_rays(*mesh, settings.width, settings.height, rays, camera_position);
+        camera loc_camera{};
+        loc_camera.set_view_XYZ(camera_position, glm::vec3(0.f));
+        const glm::mat4 inv_proj = loc_camera.get_inverse_projection(static_cast<f32>(settings.width) / static_cast<f32>(settings.height));
+        const glm::mat4 inv_view = loc_camera.get_inverse_view();
+
+        std::vector<geometry::ray_hit> traced(rays.size()), resolved(rays.size());
+        render::CPU::tile_rasterizer rasterizer{};
+        render::CPU::visibility_buffer visibility{};
+        visibility.resize(settings.width, settings.height);
+
+        const timing ray_cast_timing = measure(settings.iterations, [&] { geometry::intersect(*mesh, rays, traced); });
+        const timing raster_timing = measure(settings.iterations, [&] { rasterizer.render(*mesh, inv_proj, inv_view, visibility); });
+        const timing resolve_timing = measure(settings.iterations, [&] {
+            for (u64 x = 0; x < rays.size(); x++)
+                resolved[x] = render::CPU::tile_rasterizer::resolve_hit(*mesh, rays[x], visibility.triangle_id[x]);
+        });
+
+        // pixels where both disagree are expected only along silhouettes and shared edges (rounding of the pixel center test)
+        u64 covered = 0, id_mismatches = 0, coverage_mismatches = 0;
+        f64 max_depth_error = 0.0;
+        for (u64 x = 0; x < rays.size(); x++) {
+
+            covered += traced[x].is_hit();
+            if (traced[x].is_hit() != resolved[x].is_hit()) {
+                coverage_mismatches++;
+                continue;
+            }
+            if (!traced[x].is_hit() || traced[x].triangle_id == resolved[x].triangle_id)
+                continue;
+
+            id_mismatches++;
+            max_depth_error = math::max(max_depth_error, static_cast<f64>(std::abs(traced[x].t - resolved[x].t) / traced[x].t));
+        }
+
+        // full CPU frames, shading and shadow rays are identical in both modes
+        render::CPU::CPU_ray_tracer tracer{};
+        render::CPU::frame_data frame{};
+        frame.inv_proj = inv_proj;
+        frame.inv_view = inv_view;
+        frame.cam_pos = camera_position;
+        io::image ray_cast_image{}, rasterized_image{};
+        ray_cast_image.resize(settings.width, settings.height);
+        rasterized_image.resize(settings.width, settings.height);
+        const timing ray_cast_frame = measure(settings.iterations, [&] { tracer.render(*mesh, frame, ray_cast_image); });
+        frame.visibility = render::CPU::primary_visibility::rasterized;
+        const timing rasterized_frame = measure(settings.iterations, [&] { tracer.render(*mesh, frame, rasterized_image); });
+
+        u64 differing_pixels = 0;
+        for (u64 x = 0; x < rays.size(); x++)
+            for (u32 channel = 0; channel < 3; channel++)
+                if (std::abs(ray_cast_image.pixels[x * 3 + channel] - rasterized_image.pixels[x * 3 + channel]) > 2) {
+                    differing_pixels++;
+                    break;
+                }
+
+        const f64 pixel_count = static_cast<f64>(rays.size());
+        LOG(Info, "pixels [" << rays.size() << "] covered [" << covered << "] coverage mismatches [" << coverage_mismatches << "] triangle id mismatches [" << id_mismatches
+            << "] (" << std::fixed << std::setprecision(4) << 100.0 * (coverage_mismatches + id_mismatches) / pixel_count << "%) max relative depth error of mismatches [" << max_depth_error << "]");
+        const auto report = [&](const char* name, const timing& result, const timing& baseline) {
+            LOG(Info, std::left << std::setw(24) << name << " min [" << std::fixed << std::setprecision(3) << result.min_ms << " ms] avg [" << result.average_ms << " ms] "
+                << (pixel_count / (result.min_ms * 1000.0)) << " MPixels/s  speedup [" << (baseline.min_ms / result.min_ms) << "x]");
+        };
+        const timing raster_total{ raster_timing.min_ms + resolve_timing.min_ms, raster_timing.average_ms + resolve_timing.average_ms };
+        report("ray cast", ray_cast_timing, ray_cast_timing);
+        report("rasterize", raster_timing, ray_cast_timing);
+        report("rasterize + resolve", raster_total, ray_cast_timing);
+        report("frame ray cast", ray_cast_frame, ray_cast_frame);
+        report("frame rasterized", rasterized_frame, ray_cast_frame);
+        LOG(Info, "frame pixels differing by more than 2/255 [" << differing_pixels << "] (" << std::setprecision(4) << 100.0 * differing_pixels / pixel_count << "%)");
+        return true;
+    }
+
+    bool primary_visibility(const settings& settings) {
+
+        if (!std::filesystem::is_directory(settings.mesh))
+            return measure_mesh(settings);
+
+        // every mesh of a directory, e.g. [--mesh assets/meshes]
+        std::vector<std::filesystem::path> meshes{};
+        for (const auto& entry : std::filesystem::directory_iterator(settings.mesh))
+            if (entry.is_regular_file())
+                meshes.push_back(entry.path());
+        std::sort(meshes.begin(), meshes.end());
+
+        bool result = true;
+        for (const std::filesystem::path& mesh : meshes) {
+
+            LOG(Info, "---------------- [" << mesh.filename().generic_string() << "] ----------------");
+            benchmark::settings mesh_settings = settings;
+            mesh_settings.mesh = mesh;
+            result &= measure_mesh(mesh_settings);
+        }
+        return result;
+    }
+
+}
@@ -0,0 +1,235 @@
+
+#include "util/pch.h"
+
+#include "util/math/sampling.h"
+#include "geometry/static_mesh.h"
+#include "game_object/camera.h"
+#include "engine/render/CPU/CPU_ray_tracer.h"
+
+#include "benchmark.h"
+
+
+namespace GLT::benchmark {
+
+    using namespace math::sampling;
+
+    constexpr u32 GRID_SIZE = BLUE_NOISE_TILE_SIZE;         // one integral per pixel, the grid covers the blue noise tile once
+    constexpr u32 MAX_SAMPLES = 256;
+    constexpr f32 GAUSSIAN_SIGMA = .15f;
+    constexpr f32 RENDER_LIGHT_ANGLE = 8.f;
+    constexpr u32 RENDER_REFERENCE_SAMPLES = 512;
+
+    enum class generator : u8 { random, sobol_owen, blue_noise, count };
+    static const char* const s_generator_names[] = { "random", "sobol_owen", "blue_noise" };
+
+    // per pixel integrand over the unit square with a known solution
+    struct integrand {
+
+        const char*                         name;
+        std::function<f64(u32 pixel, glm::vec2 sample)> evaluate;
+        std::vector<f64>                    reference;
+    };
+
+    struct error {
+        f64                                 rmse = 0.0;
+        f64                                 low_pass_rmse = 0.0;    // after a 3x3 box filter, what the eye sees from a distance
+    };
+
+    static error measure_error(const std::vector<f64>& estimate, const std::vector<f64>& reference, const u32 width, const u32 height) {
+
+        error result{};
+        std::vector<f64> difference(estimate.size());
+        for (u64 x = 0; x < estimate.size(); x++) {
+            difference[x] = estimate[x] - reference[x];
+            result.rmse += difference[x] * difference[x];
+        }
+
+        for (u32 y = 0; y < height; y++) {
+            for (u32 x = 0; x < width; x++) {
+
+                f64 sum = 0.0;
+                for (u32 dy = 0; dy < 3; dy++)
+                    for (u32 dx = 0; dx < 3; dx++)
+                        sum += difference[((y + height + dy - 1) % height) * width + (x + width + dx - 1) % width];
+                result.low_pass_rmse += (sum / 9.0) * (sum / 9.0);
+            }
+        }
+        result.rmse = std::sqrt(result.rmse / estimate.size());
+        result.low_pass_rmse = std::sqrt(result.low_pass_rmse / estimate.size());
+        return result;
+    }
+
+    static glm::vec2 get_sample(const generator generator, std::mt19937& random, const u32 x, const u32 y, const u32 index) {
+
+        switch (generator) {
+            case generator::sobol_owen:     return sample_2D(pattern::sobol_owen, x, y, index);
+            case generator::blue_noise:     return sample_2D(pattern::blue_noise, x, y, index);
+            default: {
+                std::uniform_real_distribution<f32> unit(0.f, 1.f);
+                return glm::vec2(unit(random), unit(random));
+            }
+        }
+    }
+
+    static std::vector<integrand> create_integrands() {
+
+        // parameters change smoothly over the grid like they do between neighbouring pixels of a render,
+        // this is where the spatial distribution of the error (blue noise) matters
+        std::vector<glm::vec3> edges(GRID_SIZE * GRID_SIZE), centers(GRID_SIZE * GRID_SIZE);
+        for (u32 y = 0; y < GRID_SIZE; y++) {
+            for (u32 x = 0; x < GRID_SIZE; x++) {
+
+                const glm::vec2 position = (glm::vec2(x, y) + .5f) / static_cast<f32>(GRID_SIZE);
+                const f32 angle = position.y * glm::pi<f32>();
+                edges[y * GRID_SIZE + x] = glm::vec3(std::cos(angle), std::sin(angle), position.x * 1.6f - .8f);
+                centers[y * GRID_SIZE + x] = glm::vec3(.2f + position * .6f, 0.f);
+            }
+        }
+
+        std::vector<integrand> integrands{};
+
+        // disk light partially covered by a straight occluder edge, the typical soft shadow penumbra
+        integrand& penumbra = integrands.emplace_back();
+        penumbra.name = "penumbra";
+        penumbra.evaluate = [edges](const u32 pixel, const glm::vec2 sample) {
+            const glm::vec2 disk = concentric_disk(sample);
+            return (disk.x * edges[pixel].x + disk.y * edges[pixel].y < edges[pixel].z) ? 1.0 : 0.0;
+        };
+        for (const glm::vec3& edge : edges) {
+            const f64 offset = edge.z;
+            penumbra.reference.push_back(1.0 - (std::acos(offset) - offset * std::sqrt(1.0 - offset * offset)) / glm::pi<f64>());
+        }
+
+        // smooth gaussian lobe, separable so the reference is a product of erf()
+        integrand& gaussian = integrands.emplace_back();
+        gaussian.name = "gaussian";
+        gaussian.evaluate = [centers](const u32 pixel, const glm::vec2 sample) {
+            const glm::vec2 offset = sample - glm::vec2(centers[pixel]);
+            return std::exp(-static_cast<f64>(glm::dot(offset, offset)) / (2.0 * GAUSSIAN_SIGMA * GAUSSIAN_SIGMA));
+        };
+        const auto integral_1D = [](const f64 center) {
+            const f64 scale = GAUSSIAN_SIGMA * std::sqrt(2.0);
+            return GAUSSIAN_SIGMA * std::sqrt(glm::pi<f64>() / 2.0) * (std::erf((1.0 - center) / scale) + std::erf(center / scale));
+        };
+        for (const glm::vec3& center : centers)
+            gaussian.reference.push_back(integral_1D(center.x) * integral_1D(center.y));
+
+        return integrands;
+    }
+
+    static void measure_integrand(const integrand& integrand) {
+
+        LOG(Info, "integrand [" << integrand.name << "] pixels [" << GRID_SIZE << "x" << GRID_SIZE << "]   RMSE / low-pass RMSE");
+        constexpr u32 GENERATOR_COUNT = static_cast<u32>(generator::count);
+        std::vector<f64> sums[GENERATOR_COUNT];
+        std::vector<std::mt19937> random(GRID_SIZE * GRID_SIZE);
+        for (u32 x = 0; x < GRID_SIZE * GRID_SIZE; x++)
+            random[x].seed(pixel_seed(x % GRID_SIZE, x / GRID_SIZE));
+
+        f64 random_rmse_at_max = 0.0;
+        u32 matching_samples[GENERATOR_COUNT] = {};
+        std::vector<std::pair<u32, error>> results[GENERATOR_COUNT];
+        for (auto& sum : sums)
+            sum.assign(GRID_SIZE * GRID_SIZE, 0.0);
+
+        for (u32 sample = 0, report_at = 1; sample < MAX_SAMPLES; sample++) {
+
+            for (u32 g = 0; g < GENERATOR_COUNT; g++)
+                for (u32 pixel = 0; pixel < GRID_SIZE * GRID_SIZE; pixel++)
+                    sums[g][pixel] += integrand.evaluate(pixel, get_sample(static_cast<generator>(g), random[pixel], pixel % GRID_SIZE, pixel / GRID_SIZE, sample));
+
+            if (sample + 1 != report_at)
+                continue;
+
+            std::ostringstream line{};
+            line << std::setw(5) << report_at << " spp";
+            for (u32 g = 0; g < GENERATOR_COUNT; g++) {
+
+                std::vector<f64> estimate(sums[g].size());
+                for (u64 x = 0; x < estimate.size(); x++)
+                    estimate[x] = sums[g][x] / report_at;
+                const error loc_error = measure_error(estimate, integrand.reference, GRID_SIZE, GRID_SIZE);
+                results[g].emplace_back(report_at, loc_error);
+                line << "  " << std::setw(10) << s_generator_names[g] << " " << std::scientific << std::setprecision(2) << loc_error.rmse << " / " << loc_error.low_pass_rmse << std::fixed;
+            }
+            LOG(Info, line.str());
+            report_at *= 2;
+        }
+
+        // convergence order from the first to the last measurement and the sample count reaching random's final error
+        random_rmse_at_max = results[0].back().second.rmse;
+        for (u32 g = 0; g < GENERATOR_COUNT; g++) {
+
+            for (const auto& [samples, loc_error] : results[g]) {
+                if (loc_error.rmse <= random_rmse_at_max) {
+                    matching_samples[g] = samples;
+                    break;
+                }
+            }
+            const f64 order = std::log(results[g].front().second.rmse / results[g].back().second.rmse) / std::log(static_cast<f64>(results[g].back().first));
+            LOG(Info, std::setw(12) << s_generator_names[g] << ": error ~ N^-" << std::setprecision(2) << order << ", reaches the error of random at " << MAX_SAMPLES << " spp with [" << matching_samples[g] << "] spp");
+        }
+    }
+
+    // soft shadows of the mesh traced by the CPU ray tracer, compared against a high sample count reference
+    static void measure_render(const settings& settings) {
+
+        ref<geometry::static_mesh> mesh{};
+        if (!load_mesh(settings, mesh))
+            return;
+
+        const u32 width = math::max(settings.width / 4, 16u);
+        const u32 height = math::max(settings.height / 4, 16u);
+        std::vector<geometry::ray> rays{};
+        glm::vec3 camera_position{};
+        generate_camera_rays(*mesh, 1, 1, rays, camera_position);               // only for the camera placement
+
+        camera loc_camera{};
+        loc_camera.set_view_XYZ(camera_position, glm::vec3(0.f));
+        render::CPU::frame_data frame{};
+        frame.inv_proj = loc_camera.get_inverse_projection(static_cast<f32>(width) / static_cast<f32>(height));
+        frame.inv_view = loc_camera.get_inverse_view();
+        frame.cam_pos = camera_position;
+        frame.light_radius = glm::tan(glm::radians(RENDER_LIGHT_ANGLE));
+
+        render::CPU::CPU_ray_tracer tracer{};
+        const auto render_image = [&](const pattern sample_pattern, const u32 samples) {
+
+            io::image image{};
+            image.resize(width, height);
+            frame.sample_pattern = sample_pattern;
+            frame.shadow_samples = samples;
+            tracer.render(*mesh, frame, image);
+            std::vector<f64> luminance(static_cast<u64>(width) * height);
+            for (u64 x = 0; x < luminance.size(); x++)
+                luminance[x] = image.pixels[x * 3 + 2] / 255.0;
+            return luminance;
+        };
+
+        LOG(Info, "soft shadows of [" << settings.mesh.generic_string() << "] at [" << width << "x" << height << "] light angle [" << RENDER_LIGHT_ANGLE << "deg] against [" << RENDER_REFERENCE_SAMPLES << "] spp   RMSE / low-pass RMSE");
+        const std::vector<f64> reference = render_image(pattern::sobol_owen, RENDER_REFERENCE_SAMPLES);
+        for (u32 samples = 1; samples <= 64; samples *= 4) {
+
+            std::ostringstream line{};
+            line << std::setw(5) << samples << " spp";
+            for (const pattern sample_pattern : { pattern::sobol_owen, pattern::blue_noise }) {
+                const error loc_error = measure_error(render_image(sample_pattern, samples), reference, width, height);
+                line << "  " << std::setw(10) << s_generator_names[static_cast<u32>(sample_pattern) + 1] << " " << std::scientific << std::setprecision(2) << loc_error.rmse << " / " << loc_error.low_pass_rmse << std::fixed;
+            }
+            LOG(Info, line.str());
+        }
+    }
+
+    bool sample_convergence(const settings& settings) {
+
+        for (const integrand& integrand : create_integrands())
+            measure_integrand(integrand);
+
+        if (!settings.mesh.empty())
+            measure_render(settings);
+        else
+            LOG(Info, "no mesh given, skipping the rendered soft shadow comparison")
+        return true;
+    }
+
+}
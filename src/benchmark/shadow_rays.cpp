@@ -0,0 +1,77 @@
+
+#include "util/pch.h"
+
+#include "geometry/static_mesh.h"
+#include "geometry/ray_query.h"
+
+#include "benchmark.h"
+
+
+namespace GLT::benchmark {
+
+    bool shadow_rays(const settings& settings) {
+
+        ref<geometry::static_mesh> mesh{};
+        if (!load_mesh(settings, mesh))
+            return false;
+
+        std::vector<geometry::ray> primary_rays{};
+        glm::vec3 camera_position{};
+        generate_camera_rays(*mesh, settings.width, settings.height, primary_rays, camera_position);
+
+        std::vector<geometry::ray_hit> primary_hits(primary_rays.size());
+        geometry::intersect(*mesh, primary_rays, primary_hits);
+
+        // oblique light so a good share of the shadow rays is blocked, same bias as the ray tracers
+        const glm::vec3 light_direction = glm::normalize(glm::vec3(1.f, 1.f, .5f));
+        std::vector<geometry::ray> shadow_rays{};
+        for (u64 x = 0; x < primary_rays.size(); x++) {
+
+            const geometry::ray_hit& hit = primary_hits[x];
+            if (!hit.is_hit())
+                continue;
+
+            const glm::vec3& n0 = mesh->vertices[mesh->indices[hit.triangle_id * 3]].normal;
+            const glm::vec3& n1 = mesh->vertices[mesh->indices[hit.triangle_id * 3 + 1]].normal;
+            const glm::vec3& n2 = mesh->vertices[mesh->indices[hit.triangle_id * 3 + 2]].normal;
+            const glm::vec3 normal = glm::normalize((1.f - hit.barycentrics.x - hit.barycentrics.y) * n0 + hit.barycentrics.x * n1 + hit.barycentrics.y * n2);
+            if (glm::dot(normal, light_direction) <= 0.f)
+                continue;
+
+            geometry::ray shadow_ray{};
+            shadow_ray.origin = primary_rays[x].origin + primary_rays[x].direction * hit.t + normal * 1e-3f;
+            shadow_ray.direction = light_direction;
+            shadow_rays.push_back(shadow_ray);
+        }
+        VALIDATE(!shadow_rays.empty(), return false, "", "No lit surface visible, nothing to benchmark");
+
+        std::vector<geometry::ray_hit> closest(shadow_rays.size()), any(shadow_rays.size());
+        std::vector<u8> occluded(shadow_rays.size());
+        const timing closest_timing = measure(settings.iterations, [&] { geometry::intersect(*mesh, shadow_rays, closest, geometry::query_type::closest_hit); });
+        const timing any_timing = measure(settings.iterations, [&] { geometry::intersect(*mesh, shadow_rays, any, geometry::query_type::any_hit); });
+        const timing occluded_timing = measure(settings.iterations, [&] { geometry::occluded(*mesh, shadow_rays, occluded); });
+
+        u64 shadowed = 0, mismatches = 0;
+        for (u64 x = 0; x < shadow_rays.size(); x++) {
+            shadowed += occluded[x];
+            mismatches += (closest[x].is_hit() != (occluded[x] != 0)) || (any[x].is_hit() != (occluded[x] != 0));
+        }
+
+        const auto report = [&](const char* name, const timing& result) {
+            LOG(Info, std::left << std::setw(24) << name << " min [" << std::fixed << std::setprecision(3) << result.min_ms << " ms] avg [" << result.average_ms << " ms] "
+                << (shadow_rays.size() / (result.min_ms * 1000.0)) << " MRays/s  speedup vs closest hit [" << (closest_timing.min_ms / result.min_ms) << "x]");
+        };
+        LOG(Info, "shadow rays [" << shadow_rays.size() << "] occluded [" << shadowed << "] result mismatches [" << mismatches << "]");
+        report("closest hit", closest_timing);
+        report("any hit (intersect)", any_timing);
+        report("occluded", occluded_timing);
+
+        geometry::traversal_stats closest_stats{}, occluded_stats{};
+        geometry::intersect(*mesh, shadow_rays, closest, geometry::query_type::closest_hit, &closest_stats);
+        geometry::occluded(*mesh, shadow_rays, occluded, &occluded_stats);
+        LOG(Info, "per ray: closest hit nodes [" << static_cast<f64>(closest_stats.nodes_visited) / closest_stats.rays << "] triangles [" << static_cast<f64>(closest_stats.triangles_tested) / closest_stats.rays
+            << "]  occluded nodes [" << static_cast<f64>(occluded_stats.nodes_visited) / occluded_stats.rays << "] triangles [" << static_cast<f64>(occluded_stats.triangles_tested) / occluded_stats.rays << "]");
+        return mismatches == 0;
+    }
+
+}
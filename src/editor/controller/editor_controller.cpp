@@ -2,10 +2,14 @@
 #include "util/pch.h"
 //#include <engine/Events/Event.h>
 
+#include <imgui.h>
+
 #include "application.h"
 #include "editor_inputs.h"
 #include "layer/world_layer.h"
 #include "game_object/camera.h"
+#include "geometry/static_mesh.h"
+#include "engine/platform/window.h"
 #include "util/util.h"
 
 #include "editor_controller.h"
@@ -84,12 +88,42 @@ namespace GLT {
 		} // else
 			// application::get().release_cursor();
 
+		if (m_input_mapping->pick.data.boolean && !m_input_mapping->capture_mouse.data.boolean && !ImGui::GetIO().WantCaptureMouse)
+			pick_at_cursor();
+
 		if (m_input_mapping->toggle_fps.data.boolean)
 			application::get().limit_fps(!application::get().get_limit_fps(), application::get().get_target_fps());
 		
 		//LOG(Trace, vec_to_str(m_camera_direction, "dir") << vec_to_str(m_camera_pos, "pos") << vec_to_str(m_input_mapping->move.data._3D, "input"));
 	}
 
+	void editor_controller::pick_at_cursor() {
+
+		const ref<window> loc_window = application::get().get_window();
+		const ref<camera> loc_camera = application::get().get_world_layer()->get_editor_camera();
+		const ref<geometry::static_mesh> mesh = application::get().get_world_layer()->GET_RENDER_MESH();
+		if (!mesh || loc_window->get_width() == 0 || loc_window->get_height() == 0)
+			return;
+
+		glm::vec2 mouse_pos{};
+		loc_window->get_mouse_position(mouse_pos);
+		const glm::vec2 resolution = glm::vec2(loc_window->get_width(), loc_window->get_height());
+		const glm::vec2 uv = glm::vec2(mouse_pos.x / resolution.x, (resolution.y - mouse_pos.y) / resolution.y) * 2.f - 1.f;		// same camera ray as the fragment ray tracer
+
+		glm::vec4 ray_eye = loc_camera->get_inverse_projection(resolution.x / resolution.y) * glm::vec4(uv.x, uv.y, -1.f, 1.f);
+		ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.f, 0.f);
+
+		geometry::ray pick_ray{};
+		pick_ray.origin = loc_camera->get_position();
+		pick_ray.direction = glm::normalize(glm::vec3(loc_camera->get_inverse_view() * ray_eye));
+		m_picked_hit = geometry::intersect(*mesh, pick_ray);
+
+		if (m_picked_hit.is_hit())
+			LOG(Debug, "picked triangle [" << m_picked_hit.triangle_id << "] at distance [" << m_picked_hit.t << "] barycentrics [" << m_picked_hit.barycentrics.x << ", " << m_picked_hit.barycentrics.y << "]")
+		else
+			LOG(Debug, "picked nothing");
+	}
+
 	void editor_controller::serialize(serializer::option option) {
 
 		// serializer::yaml(config::get_filepath_from_configtype(PFF_editor::get().get_project_path(), config::file::editor), "editor_camera", option)
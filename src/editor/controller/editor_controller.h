@@ -1,6 +1,7 @@
 #pragma once
 
 #include "game_object/player_controller.h"
+#include "geometry/ray_query.h"
 
 namespace GLT {
 
@@ -19,13 +20,18 @@ namespace GLT {
 		FORCEINLINE void set_move_speed(f32 new_move_speed)						{ m_move_speed = new_move_speed; }
 		FORCEINLINE void set_editor_camera_pos(const glm::vec3 pos)				{ m_camera_pos = pos; }
 		FORCEINLINE void set_editor_camera_direction(const glm::vec3 direction) { m_camera_direction = direction; }
+		FORCEINLINE geometry::ray_hit get_picked_hit()							const { return m_picked_hit; }
 
 		void update(const f32 delta_time) override;
 		void serialize(serializer::option option);
 
 	private:
+
+		// @brief Casts a ray through the cursor position into the render mesh and stores the closest hit in [m_picked_hit]
+		void pick_at_cursor();
 		
 		ref<editor_inputs> m_input_mapping{};
+		geometry::ray_hit m_picked_hit{};
 
 		glm::vec3 m_camera_pos{0.f, 0.f, -5.f};
 		glm::vec3 m_camera_direction{};
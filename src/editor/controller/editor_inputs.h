@@ -16,6 +16,7 @@ namespace GLT {
 		input_action change_move_speed;
 		input_action look;
 		input_action toggle_fps;
+		input_action pick;
 
 		input_action transform_operation_to_translate;
 		input_action transform_operation_to_rotate;
@@ -108,6 +109,19 @@ namespace GLT {
 		register_action(&toggle_fps, true);
 
 
+		pick = input_action{};
+		pick.description = "select the triangle under the cursor";
+		pick.triger_when_paused = false;
+		pick.flags = INPUT_ACTION_MODEFIER_AUTO_RESET_ALL;
+		pick.value = input::action_type::boolean;
+		pick.duration_in_sec = 0.f;
+		pick.keys_bindings = {
+			{key_code::mouse_bu_left, INPUT_ACTION_TRIGGER_KEY_MOVE_DOWN},
+		};
+		pick.set_name("pick");
+		register_action(&pick, true);
+
+
 		transform_operation_to_translate = input_action{};
 		transform_operation_to_translate.description = "set transform operation to translate";
 		transform_operation_to_translate.triger_when_paused = false;
@@ -204,13 +204,7 @@ namespace GLT {
 		glfwPollEvents();
 	
 		// prossess constom queue
-		std::scoped_lock<std::mutex> lock(m_event_queue_mutex);
-		while (m_event_queue.size() > 0) {
-	
-			auto& func = m_event_queue.front();
-			func();
-			m_event_queue.pop();
-		}
+		m_event_queue.drain();
 	}
 	
 	void window::capture_cursor() { glfwSetInputMode(m_Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); }
@@ -8,6 +8,8 @@ struct VkSurfaceKHR_T;
 class event;
 class application;
 
+#include "util/data_structures/task_queue.h"
+
 
 
 namespace GLT {
@@ -80,16 +82,16 @@ namespace GLT {
 		void capture_cursor();
 		void release_cursor();
 	
+		// @brief Any thread: runs [func] on the main thread in the next poll_events()
 		template<typename Func>
 		void queue_event(Func&& func) {
 	
-			m_event_queue.push(func);
+			VALIDATE(m_event_queue.push(std::forward<Func>(func)), return, "", "Window event queue is full, event dropped");
 		}
 	
 	private:
 	
-		std::mutex m_event_queue_mutex;
-		std::queue<std::function<void()>> m_event_queue;
+		util::task_queue<64> m_event_queue{};
 		std::filesystem::path m_icon_path;
 	
 		void bind_event_calbacks();
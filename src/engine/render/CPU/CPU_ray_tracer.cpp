@@ -0,0 +1,196 @@
+
+#include "util/pch.h"
+
+#include "geometry/static_mesh.h"
+#include "util/jobs/job_system.h"
+
+#include "CPU_ray_tracer.h"
+
+
+namespace GLT::render::CPU {
+
+    // ================================================== tracing (same math as the fragment shader) ==================================================
+
+    static geometry::ray create_camera_ray(const frame_data& frame, const glm::vec2 pixel_coord, const glm::vec2 resolution) {
+
+        const glm::vec2 uv = (pixel_coord / resolution) * 2.f - 1.f;
+        glm::vec4 ray_eye = frame.inv_proj * glm::vec4(uv.x, uv.y, -1.f, 1.f);
+        ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.f, 0.f);                   // Forward direction
+
+        geometry::ray cam_ray{};
+        cam_ray.origin = frame.cam_pos;
+        cam_ray.direction = glm::normalize(glm::vec3(frame.inv_view * ray_eye));
+        return cam_ray;
+    }
+
+    static glm::vec3 interpolate_normal(const geometry::static_mesh& mesh, const geometry::ray_hit& hit) {
+
+        const glm::vec3& n0 = mesh.vertices[mesh.indices[hit.triangle_id * 3]].normal;
+        const glm::vec3& n1 = mesh.vertices[mesh.indices[hit.triangle_id * 3 + 1]].normal;
+        const glm::vec3& n2 = mesh.vertices[mesh.indices[hit.triangle_id * 3 + 2]].normal;
+        return glm::normalize((1.f - hit.barycentrics.x - hit.barycentrics.y) * n0 + hit.barycentrics.x * n1 + hit.barycentrics.y * n2);
+    }
+
+    constexpr f32 SHADOW_BIAS = 1e-3f;                                          // offset along the normal so shadow rays do not start inside the surface
+
+    static glm::vec3 get_light_direction(const frame_data& frame) { return glm::normalize(frame.cam_pos + glm::vec3(1.f + glm::sin(frame.time * 2.f), 1.f, -1.f)); }
+
+    // same basis and sample order as light_visibility() in the shader
+    struct light_sampler {
+
+        light_sampler(const frame_data& frame, const glm::vec3 light_direction)
+            : direction(light_direction), radius(frame.light_radius), samples(frame.light_radius > 0.f ? math::max(frame.shadow_samples, 1u) : 1u), pattern(frame.sample_pattern), frame_index(frame.frame_index) {
+
+            const glm::vec3 helper = glm::abs(direction.y) < .99f ? glm::vec3(0.f, 1.f, 0.f) : glm::vec3(1.f, 0.f, 0.f);
+            tangent = glm::normalize(glm::cross(helper, direction));
+            bitangent = glm::cross(direction, tangent);
+        }
+
+        glm::vec3 get_direction(const u32 pixel_x, const u32 pixel_y, const u32 sample) const {
+
+            if (radius <= 0.f)
+                return direction;
+
+            const glm::vec2 disk = math::sampling::concentric_disk(math::sampling::sample_2D(pattern, pixel_x, pixel_y, frame_index * samples + sample)) * radius;
+            return glm::normalize(direction + tangent * disk.x + bitangent * disk.y);
+        }
+
+        glm::vec3 direction, tangent{}, bitangent{};
+        f32 radius;
+        u32 samples;
+        math::sampling::pattern pattern;
+        u32 frame_index;
+    };
+
+    static glm::vec3 background_color(const geometry::ray& cam_ray) { return glm::mix(glm::vec3(0.2f, 0.2f, 0.3f), glm::vec3(0.1f, 0.4f, 0.9f), glm::max(0.f, cam_ray.direction.y)); }
+
+    // ================================================== CPU_ray_tracer ==================================================
+
+    CPU_ray_tracer::CPU_ray_tracer(const u32 thread_count)
+        : m_rasterizer(thread_count) {
+
+        m_thread_count = m_rasterizer.get_thread_count();
+        LOG(Trace, "init with [" << m_thread_count << "] threads");
+    }
+
+    CPU_ray_tracer::~CPU_ray_tracer() { LOG_SHUTDOWN(); }
+
+
+    void CPU_ray_tracer::render(const geometry::static_mesh& mesh, const frame_data& frame, io::image& target, geometry::traversal_stats* stats, traversal_heatmap* heatmap) {
+
+        PROFILE_FUNCTION();
+
+        VALIDATE(target.width > 0 && target.height > 0, return, "", "Render target has no size");
+        std::atomic<u32> next_row = 0;
+        if (heatmap)
+            heatmap->resize(target.width, target.height);
+
+        const visibility_buffer* primary_hits = nullptr;
+        if (frame.visibility == primary_visibility::rasterized) {
+
+            m_visibility.resize(target.width, target.height);
+            m_rasterizer.render(mesh, frame.inv_proj, frame.inv_view, m_visibility);
+            primary_hits = &m_visibility;
+        }
+
+        // one job per worker slot, every slot pulls rows until none are left (calling thread helps)
+        jobs::parallel_for(m_thread_count, 1, [&](const u64 first, const u64 end) {
+            for (u64 x = first; x < end; x++)
+                render_rows(mesh, frame, target, next_row, stats, heatmap, primary_hits);
+        });
+    }
+
+
+    void CPU_ray_tracer::render_rows(const geometry::static_mesh& mesh, const frame_data& frame, io::image& target, std::atomic<u32>& next_row, geometry::traversal_stats* stats, traversal_heatmap* heatmap, const visibility_buffer* primary_hits) {
+
+        const glm::vec2 resolution = glm::vec2(target.width, target.height);
+        const glm::vec3 light_direction = get_light_direction(frame);
+        const light_sampler light(frame, light_direction);
+        std::vector<geometry::ray> rays(target.width);
+        std::vector<geometry::ray_hit> hits(target.width);
+        std::vector<f32> brightness(target.width);
+        std::vector<f32> visibility(target.width);
+        std::vector<geometry::ray> shadow_rays{};
+        std::vector<u32> shadow_pixels{};
+        std::vector<u8> shadowed{};
+        shadow_rays.reserve(target.width);
+        shadow_pixels.reserve(target.width);
+
+        // every worker counts into its own stats, merged once when all rows are done
+        geometry::traversal_stats local_stats{};
+        geometry::traversal_stats* row_stats = stats ? &local_stats : nullptr;
+        std::vector<u32> shadow_cost{};
+        for (u32 y = next_row.fetch_add(1); y < target.height; y = next_row.fetch_add(1)) {
+
+            const u32 pixel_y = target.height - 1 - y;                                  // images are stored top-down, gl_FragCoord is bottom-up
+            const f32 frag_y = static_cast<f32>(pixel_y) + 0.5f;
+            for (u32 x = 0; x < target.width; x++)
+                rays[x] = create_camera_ray(frame, glm::vec2(x + 0.5f, frag_y), resolution);
+
+            u32* row_cost = heatmap ? heatmap->cost.data() + static_cast<size_t>(y) * target.width : nullptr;
+            if (primary_hits) {
+
+                const u32* triangle_ids = primary_hits->triangle_id.data() + static_cast<size_t>(pixel_y) * target.width;
+                for (u32 x = 0; x < target.width; x++)
+                    hits[x] = tile_rasterizer::resolve_hit(mesh, rays[x], triangle_ids[x]);     // no BVH work, the heatmap only shows shadow rays
+            } else {
+
+                local_stats.ray_cost = heatmap ? std::span<u32>(row_cost, target.width) : std::span<u32>{};
+                geometry::intersect(mesh, rays, hits, geometry::query_type::closest_hit, row_stats);     // one row is a coherent batch, traced as SSE packets
+            }
+
+            // only lit surfaces need shadow rays, they are traced as one occlusion batch
+            shadow_rays.clear();
+            shadow_pixels.clear();
+            for (u32 x = 0; x < target.width; x++) {
+
+                brightness[x] = 0.f;
+                visibility[x] = 1.f;
+                if (!hits[x].is_hit())
+                    continue;
+
+                const glm::vec3 normal = interpolate_normal(mesh, hits[x]);
+                brightness[x] = glm::max(glm::dot(light_direction, normal), 0.f);
+                if (brightness[x] <= 0.f)
+                    continue;
+
+                geometry::ray shadow_ray{};
+                shadow_ray.origin = rays[x].origin + rays[x].direction * hits[x].t + normal * SHADOW_BIAS;
+                for (u32 sample = 0; sample < light.samples; sample++) {
+
+                    shadow_ray.direction = light.get_direction(x, pixel_y, sample);
+                    shadow_rays.push_back(shadow_ray);
+                    shadow_pixels.push_back(x);
+                }
+            }
+            shadowed.resize(shadow_rays.size());
+            shadow_cost.assign(heatmap ? shadow_rays.size() : 0, 0);
+            local_stats.ray_cost = shadow_cost;
+            geometry::occluded(mesh, shadow_rays, shadowed, row_stats);
+            for (u64 x = 0; x < shadow_cost.size(); x++)
+                row_cost[shadow_pixels[x]] += shadow_cost[x];
+
+            const f32 sample_weight = 1.f / light.samples;
+            for (u64 x = 0; x < shadow_pixels.size(); x++)
+                if (shadowed[x])
+                    visibility[shadow_pixels[x]] -= sample_weight;
+
+            u8* row = target.pixels.data() + static_cast<size_t>(y) * target.width * 3;
+            for (u32 x = 0; x < target.width; x++) {
+
+                const glm::vec3 color = glm::clamp(hits[x].is_hit() ? glm::vec3(0.5f, 0.5f, 0.8f) * (brightness[x] * math::max(visibility[x], 0.f)) : background_color(rays[x]), 0.f, 1.f);
+                row[x * 3 + 0] = static_cast<u8>(color.r * 255.f + 0.5f);
+                row[x * 3 + 1] = static_cast<u8>(color.g * 255.f + 0.5f);
+                row[x * 3 + 2] = static_cast<u8>(color.b * 255.f + 0.5f);
+            }
+        }
+
+        if (stats) {
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            stats->rays += local_stats.rays;
+            stats->nodes_visited += local_stats.nodes_visited;
+            stats->triangles_tested += local_stats.triangles_tested;
+        }
+    }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "util/io/image_writer.h"
+#include "util/math/sampling.h"
+#include "geometry/ray_query.h"
+#include "engine/render/traversal_heatmap.h"
+#include "tile_rasterizer.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::render::CPU {
+
+    // @brief How the closest surface of every pixel is found
+    enum class primary_visibility : u8 {
+        ray_cast = 0,                                                           // one BVH traversal per pixel
+        rasterized,                                                             // tile_rasterizer writes a visibility buffer, hits are reconstructed from it
+    };
+
+    // @brief Camera and frame data needed to trace one image, mirrors the uniforms of the fragment ray tracer
+    struct frame_data {
+
+        glm::mat4                           inv_proj{1.f};
+        glm::mat4                           inv_view{1.f};
+        glm::vec3                           cam_pos{0.f};
+        f32                                 time = 0.f;
+
+        // soft shadows, see [shaders/include/ray_tracer.glsl] light_visibility()
+        f32                                 light_radius = 0.f;                 // tangent of the angular radius of the light, 0 => hard shadows
+        u32                                 shadow_samples = 1;                 // shadow rays per lit pixel
+        math::sampling::pattern             sample_pattern = math::sampling::pattern::sobol_owen;
+        u32                                 frame_index = 0;                    // selects the samples, a progressive render counts this up
+
+        primary_visibility                  visibility = primary_visibility::ray_cast;     // shadow rays are always traced
+    };
+
+    // @brief CPU implementation of [shaders/ray_tracer_intor.frag], needs no window or GPU context.
+    //        Rows are distributed dynamically over [thread_count] jobs (default: threads of the job system).
+    class CPU_ray_tracer {
+    public:
+
+        CPU_ray_tracer(const u32 thread_count = 0);
+        ~CPU_ray_tracer();
+
+        DELETE_COPY_CONSTRUCTOR(CPU_ray_tracer);
+        DEFAULT_GETTER_C(u32,                                   thread_count)
+
+        // @brief Finds the closest surface of every pixel of [target] (size must already be set), ray cast or rasterized depending on [frame.visibility],
+        //        shades it and lit hits get [frame.shadow_samples] shadow rays
+        // @param [mesh] Mesh with an already built BVH
+        // @param [frame] Camera matrices and time used for the light animation
+        // @param [target] Image that receives the result
+        // @param [stats] Optional, receives the BVH work of all rays summed over the worker threads
+        // @param [heatmap] Optional, resized to [target] and filled with the work of every pixel (only with [stats])
+        void render(const geometry::static_mesh& mesh, const frame_data& frame, io::image& target, geometry::traversal_stats* stats = nullptr, traversal_heatmap* heatmap = nullptr);
+
+    private:
+
+        void render_rows(const geometry::static_mesh& mesh, const frame_data& frame, io::image& target, std::atomic<u32>& next_row, geometry::traversal_stats* stats, traversal_heatmap* heatmap, const visibility_buffer* primary_hits);
+
+        u32                                 m_thread_count = 1;
+        tile_rasterizer                     m_rasterizer;
+        visibility_buffer                   m_visibility{};
+        std::mutex                          m_stats_mutex{};
+    };
+
+}
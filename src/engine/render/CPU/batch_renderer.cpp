@@ -0,0 +1,206 @@
+
+#include "util/pch.h"
+
+#include "util/util.h"
+#include "util/io/serializer_yaml.h"
+#include "util/timing/stopwatch.h"
+#include "game_object/camera.h"
+#include "geometry/static_mesh.h"
+#include "factories/mesh/asset_importer.h"
+
+#include "batch_renderer.h"
+
+
+namespace GLT::render::CPU {
+
+    batch_renderer::batch_renderer(const std::filesystem::path& config_file)
+        : m_config_file(config_file) { LOG_INIT(); }
+
+    batch_renderer::~batch_renderer() {
+
+        stop_encoder();
+        LOG_SHUTDOWN();
+    }
+
+
+    bool batch_renderer::run() {
+
+        VALIDATE(load_config(), return false, "", "Failed to load batch config [" << m_config_file.generic_string() << "]");
+
+        ref<geometry::static_mesh> mesh = create_ref<geometry::static_mesh>();
+        VALIDATE(factory::geometry::load_static_mesh(m_mesh_path, mesh), return false, "", "Failed to import mesh [" << m_mesh_path.generic_string() << "]");
+        mesh->build_BVH(16);
+        LOG(Info, "Loaded mesh [" << m_mesh_path.generic_string() << "] vertices [" << mesh->vertices.size() << "] BVH nodes [" << mesh->BVH_nodes.size() << "]");
+
+        VALIDATE(io::create_directory(m_output_directory), return false, "", "Could not create output directory [" << m_output_directory.generic_string() << "]");
+
+        CPU_ray_tracer tracer(m_thread_count);
+        camera loc_camera{};
+        const f32 aspect_ratio = static_cast<f32>(m_width) / static_cast<f32>(m_height);
+
+        start_encoder();
+        for (u64 x = 0; x < m_poses.size(); x++) {
+
+            const camera_pose& pose = m_poses[x];
+            loc_camera.set_view_XYZ(pose.position, pose.direction);
+            loc_camera.get_perspective_fov_y_ref() = pose.perspective_fov_y;
+
+            frame_data frame{};
+            frame.inv_proj = loc_camera.get_inverse_projection(aspect_ratio);
+            frame.inv_view = loc_camera.get_inverse_view();
+            frame.cam_pos = pose.position;
+            frame.time = m_time;
+            frame.light_radius = glm::tan(glm::radians(m_light_angle));
+            frame.shadow_samples = m_shadow_samples;
+            frame.sample_pattern = m_sample_pattern;
+            frame.visibility = m_primary_visibility;
+
+            encode_job job{};
+            job.image.resize(m_width, m_height);
+            std::ostringstream filename{};
+            filename << "pose_" << std::setw(4) << std::setfill('0') << x << io::image_format_extension(m_image_format);
+            job.path = m_output_directory / filename.str();
+
+            f32 trace_time = 0.f;
+            geometry::traversal_stats stats{};
+            traversal_heatmap heatmap{};
+            {
+                util::stopwatch trace_stopwatch(&trace_time);
+                tracer.render(*mesh, frame, job.image, m_traversal_heatmap ? &stats : nullptr, m_traversal_heatmap ? &heatmap : nullptr);
+            }
+            LOG(Info, "Traced pose [" << x + 1 << "/" << m_poses.size() << "] in [" << trace_time << " ms] => " << job.path.generic_string());
+            submit(std::move(job));
+
+            if (m_traversal_heatmap) {
+
+                LOG(Info, "  rays [" << stats.rays << "] nodes visited [" << stats.nodes_visited << "] triangles tested [" << stats.triangles_tested << "] max pixel cost [" << heatmap.get_max_cost() << "]");
+                encode_job heatmap_job{};
+                heatmap_job.image = heatmap.to_image(m_heatmap_max);
+                filename.str("");
+                filename << "pose_" << std::setw(4) << std::setfill('0') << x << "_heatmap" << io::image_format_extension(m_image_format);
+                heatmap_job.path = m_output_directory / filename.str();
+                submit(std::move(heatmap_job));
+            }
+        }
+        stop_encoder();
+
+        VALIDATE(m_failed_writes == 0, return false, "", "Failed to write [" << m_failed_writes << "] images");
+        return true;
+    }
+
+    // ==================================================================== PRIVATE ====================================================================
+
+    bool batch_renderer::load_config() {
+
+        VALIDATE(std::filesystem::is_regular_file(m_config_file), return false, "", "Batch config does not exist [" << m_config_file.generic_string() << "]");
+
+        std::filesystem::path mesh{};
+        std::filesystem::path output_directory = "renders";
+        std::string image_format = "png";
+        u32 width = m_width;
+        u32 height = m_height;
+        u32 thread_count = m_thread_count;
+        f32 time = m_time;
+        f32 light_angle = m_light_angle;
+        u32 shadow_samples = m_shadow_samples;
+        std::string sample_pattern = "sobol";
+        std::string visibility = (m_primary_visibility == primary_visibility::rasterized) ? "rasterized" : "ray_cast";
+        bool traversal_heatmap = m_traversal_heatmap;
+        u32 heatmap_max = m_heatmap_max;
+
+        serializer::yaml(m_config_file, "batch render", serializer::option::load_from_file)
+            .entry(KEY_VALUE(mesh))
+            .entry(KEY_VALUE(output_directory))
+            .entry(KEY_VALUE(image_format))
+            .entry(KEY_VALUE(width))
+            .entry(KEY_VALUE(height))
+            .entry(KEY_VALUE(thread_count))
+            .entry(KEY_VALUE(time))
+            .entry(KEY_VALUE(light_angle))
+            .entry(KEY_VALUE(shadow_samples))
+            .entry(KEY_VALUE(sample_pattern))
+            .entry("primary_visibility", visibility)
+            .entry(KEY_VALUE(traversal_heatmap))
+            .entry(KEY_VALUE(heatmap_max))
+            .vector("poses", m_poses, [&](serializer::yaml& yaml, const u64 x) {
+
+                yaml.entry("position", m_poses[x].position)
+                    .entry("direction", m_poses[x].direction)
+                    .entry("perspective_fov_y", m_poses[x].perspective_fov_y);
+            });
+
+        const std::filesystem::path base_dir = m_config_file.parent_path();
+        m_mesh_path = mesh.is_relative() ? base_dir / mesh : mesh;
+        m_output_directory = output_directory.is_relative() ? base_dir / output_directory : output_directory;
+        m_image_format = io::image_format_from_string(image_format);
+        m_width = width;
+        m_height = height;
+        m_thread_count = thread_count;
+        m_time = time;
+        m_light_angle = math::clamp(light_angle, 0.f, 45.f);
+        m_shadow_samples = math::max(shadow_samples, 1u);
+        m_sample_pattern = (sample_pattern == "blue_noise") ? math::sampling::pattern::blue_noise : math::sampling::pattern::sobol_owen;
+        m_primary_visibility = (visibility == "rasterized") ? primary_visibility::rasterized : primary_visibility::ray_cast;
+        m_traversal_heatmap = traversal_heatmap;
+        m_heatmap_max = heatmap_max;
+
+        VALIDATE(!mesh.empty(), return false, "", "Batch config has no [mesh] entry");
+        VALIDATE(m_width > 0 && m_height > 0, return false, "", "Invalid resolution [" << m_width << "x" << m_height << "]");
+        VALIDATE(!m_poses.empty(), return false, "", "Batch config has no [poses]");
+
+        LOG(Trace, "batch config: mesh [" << m_mesh_path.generic_string() << "] output [" << m_output_directory.generic_string() << "] resolution [" << m_width << "x" << m_height << "] poses [" << m_poses.size() << "]");
+        return true;
+    }
+
+
+    void batch_renderer::start_encoder() {
+
+        m_stop_encoder = false;
+        m_encoder_thread = std::thread(&batch_renderer::encoder_loop, this);
+    }
+
+
+    void batch_renderer::stop_encoder() {
+
+        if (!m_encoder_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_stop_encoder = true;
+        }
+        m_queue_cv.notify_all();
+        m_encoder_thread.join();
+    }
+
+
+    void batch_renderer::submit(encode_job&& job) {
+
+        std::unique_lock<std::mutex> lock(m_queue_mutex);
+        m_queue_cv.wait(lock, [this] { return m_encode_queue.size() < MAX_QUEUED_IMAGES; });        // bound memory if encoding is slower than tracing
+        m_encode_queue.push(std::move(job));
+        lock.unlock();
+        m_queue_cv.notify_all();
+    }
+
+
+    void batch_renderer::encoder_loop() {
+
+        while (true) {
+
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_cv.wait(lock, [this] { return m_stop_encoder || !m_encode_queue.empty(); });
+            if (m_encode_queue.empty())             // stop requested and nothing left to write
+                return;
+
+            encode_job job = std::move(m_encode_queue.front());
+            m_encode_queue.pop();
+            lock.unlock();
+            m_queue_cv.notify_all();
+
+            if (!io::write_image(job.path, job.image, m_image_format))
+                m_failed_writes++;
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "util/io/image_writer.h"
+#include "CPU_ray_tracer.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::render::CPU {
+
+    struct camera_pose {
+
+        glm::vec3                           position{0.f, 0.f, -5.f};
+        glm::vec3                           direction{0.f};         // same rotation convention as [camera::set_view_XYZ]
+        f32                                 perspective_fov_y = 45.f;
+    };
+
+    // @brief Renders a list of camera poses into image files without creating a window or GPU context.
+    //        The configuration is a YAML file (see serializer::yaml) with a [batch render] section:
+    //
+    //          batch render:
+    //            mesh: assets/meshes/Barrel.glb
+    //            output_directory: renders
+    //            image_format: png
+    //            width: 1280
+    //            height: 720
+    //            time: 0
+    //            light_angle: 0            # angular radius of the light in degrees, > 0 gives soft shadows
+    //            shadow_samples: 16
+    //            sample_pattern: sobol     # sobol or blue_noise
+    //            primary_visibility: ray_cast  # ray_cast or rasterized
+    //            traversal_heatmap: false  # also write [pose_N_heatmap] with the BVH work per pixel
+    //            heatmap_max: 0            # cost shown as the hottest color, 0 => largest cost of each image
+    //            poses:
+    //            - position: 0 0 5
+    //              direction: 0 0 0
+    //              perspective_fov_y: 45
+    //
+    //        Relative paths are resolved against the directory of the config file.
+    //        Encoding and writing of image N runs on a separate thread while image N+1 is traced.
+    class batch_renderer {
+    public:
+
+        batch_renderer(const std::filesystem::path& config_file);
+        ~batch_renderer();
+
+        DELETE_COPY_CONSTRUCTOR(batch_renderer);
+
+        // @brief Loads the mesh and renders every pose
+        // @return [bool] true if every image was rendered and written successfully
+        bool run();
+
+    private:
+
+        struct encode_job {
+            io::image                       image;
+            std::filesystem::path           path;
+        };
+
+        bool load_config();
+        void start_encoder();
+        void stop_encoder();
+        void encoder_loop();
+        void submit(encode_job&& job);
+
+        std::filesystem::path               m_config_file{};
+        std::filesystem::path               m_mesh_path{};
+        std::filesystem::path               m_output_directory{};
+        io::image_format                    m_image_format = io::image_format::PNG;
+        u32                                 m_width = 1280;
+        u32                                 m_height = 720;
+        u32                                 m_thread_count = 0;     // 0 => use all hardware threads
+        f32                                 m_time = 0.f;
+        f32                                 m_light_angle = 0.f;
+        u32                                 m_shadow_samples = 16;
+        math::sampling::pattern             m_sample_pattern = math::sampling::pattern::sobol_owen;
+        primary_visibility                  m_primary_visibility = primary_visibility::ray_cast;
+        bool                                m_traversal_heatmap = false;
+        u32                                 m_heatmap_max = 0;
+        std::vector<camera_pose>            m_poses{};
+
+        // ---------------- encoder thread ----------------
+        static constexpr u32                MAX_QUEUED_IMAGES = 2;
+        std::thread                         m_encoder_thread{};
+        std::mutex                          m_queue_mutex{};
+        std::condition_variable             m_queue_cv{};
+        std::queue<encode_job>              m_encode_queue{};
+        bool                                m_stop_encoder = false;
+        std::atomic<u32>                    m_failed_writes = 0;
+    };
+
+}
@@ -0,0 +1,314 @@
+
+#include "util/pch.h"
+
+#include <smmintrin.h>
+
+#include "geometry/static_mesh.h"
+#include "util/jobs/job_system.h"
+
+#include "tile_rasterizer.h"
+
+
+namespace GLT::render::CPU {
+
+    constexpr u32 TRIANGLES_PER_CHUNK = 1024;
+    constexpr f32 NEAR_PLANE = 1e-4f;                       // same as the [t_min] of camera rays, nothing closer is visible to them
+    constexpr u32 LANES = 4;
+
+    // eye space vertex while clipping, [key] orders the two ends of an edge so both triangles sharing it compute the same clip point
+    struct clip_vertex {
+        glm::vec3                           position;
+        u32                                 key;
+    };
+
+    static clip_vertex clip_edge(const clip_vertex& a, const clip_vertex& b) {
+
+        const clip_vertex& first = (a.key < b.key) ? a : b;
+        const clip_vertex& second = (a.key < b.key) ? b : a;
+        const f32 t = (-NEAR_PLANE - first.position.z) / (second.position.z - first.position.z);
+        clip_vertex result{ glm::mix(first.position, second.position, t), 0 };
+        result.position.z = -NEAR_PLANE;
+        return result;
+    }
+
+    // @return number of vertices of the clipped polygon (0, 3 or 4)
+    static u32 clip_near(const clip_vertex (&input)[3], clip_vertex (&output)[4]) {
+
+        u32 count = 0;
+        for (u32 x = 0; x < 3; x++) {
+
+            const clip_vertex& current = input[x];
+            const clip_vertex& next = input[(x + 1) % 3];
+            const bool current_inside = -current.position.z >= NEAR_PLANE;
+            const bool next_inside = -next.position.z >= NEAR_PLANE;
+            if (current_inside)
+                output[count++] = current;
+            if (current_inside != next_inside)
+                output[count++] = clip_edge(current, next);
+        }
+        return count;
+    }
+
+    // (a, b, c) of the edge function, positive left of [from] -> [to]. Swapping the ends negates every coefficient exactly
+    static glm::vec3 edge_function(const glm::vec2 from, const glm::vec2 to) { return glm::vec3(from.y - to.y, to.x - from.x, from.x * to.y - from.y * to.x); }
+
+    // ================================================== tile_rasterizer ==================================================
+
+    tile_rasterizer::tile_rasterizer(const u32 thread_count) {
+
+        m_thread_count = thread_count ? thread_count : jobs::get_thread_count();
+        m_bins.resize(m_thread_count);
+    }
+
+
+    void tile_rasterizer::render(const geometry::static_mesh& mesh, const glm::mat4& inv_proj, const glm::mat4& inv_view, visibility_buffer& target) {
+
+        PROFILE_FUNCTION();
+
+        VALIDATE(target.width > 0 && target.height > 0, return, "", "Visibility buffer has no size");
+
+        // camera rays use the direction (inv_proj * (uv, -1, 1)).xy, -1 in eye space, an affine function of uv
+        const glm::mat2 eye_from_uv = glm::mat2(glm::vec2(inv_proj[0]), glm::vec2(inv_proj[1]));
+        const glm::vec2 eye_offset = glm::vec2(inv_proj[3]) - glm::vec2(inv_proj[2]);
+        const glm::vec2 half_size = glm::vec2(target.width, target.height) * .5f;
+        projection screen{};
+        screen.scale = glm::mat2(half_size.x, 0.f, 0.f, half_size.y) * glm::inverse(eye_from_uv);
+        screen.offset = half_size - screen.scale * eye_offset;
+        const glm::mat4 view = glm::inverse(inv_view);
+
+        m_tiles_x = (target.width + TILE_SIZE - 1) / TILE_SIZE;
+        m_tiles_y = (target.height + TILE_SIZE - 1) / TILE_SIZE;
+        for (worker_bins& bins : m_bins) {
+            bins.triangles.clear();
+            bins.tiles.resize(m_tiles_x * m_tiles_y);
+            for (auto& tile : bins.tiles)
+                tile.clear();
+        }
+
+        const glm::uvec2 size(target.width, target.height);
+        const auto run_parallel = [&](auto&& work) {
+
+            // one job per worker slot, the slots pull chunks/tiles dynamically
+            jobs::parallel_for(m_thread_count, 1, [&](const u64 first, const u64 end) {
+                for (u64 worker = first; worker < end; worker++)
+                    work(static_cast<u32>(worker));
+            });
+        };
+
+        std::atomic<u32> next_chunk = 0;
+        run_parallel([&](const u32 worker) { bin_triangles(mesh, view, screen, size, m_bins[worker], next_chunk); });
+
+        std::atomic<u32> next_tile = 0;
+        run_parallel([&](const u32 /*worker*/) { raster_tiles(target, next_tile); });
+    }
+
+
+    geometry::ray_hit tile_rasterizer::resolve_hit(const geometry::static_mesh& mesh, const geometry::ray& query_ray, const u32 triangle_id) {
+
+        geometry::ray_hit hit{};
+        if (triangle_id == geometry::INVALID_TRIANGLE_ID)
+            return hit;
+
+        // Möller-Trumbore without the bounds checks, coverage was already decided by the rasterizer
+        const glm::vec3& p0 = mesh.vertices[mesh.indices[triangle_id * 3]].position;
+        const glm::vec3 e1 = mesh.vertices[mesh.indices[triangle_id * 3 + 1]].position - p0;
+        const glm::vec3 e2 = mesh.vertices[mesh.indices[triangle_id * 3 + 2]].position - p0;
+        const glm::vec3 h = glm::cross(query_ray.direction, e2);
+        const f32 a = glm::dot(e1, h);
+        if (a == 0.f)
+            return hit;
+
+        const f32 f = 1.f / a;
+        const glm::vec3 s = query_ray.origin - p0;
+        const glm::vec3 q = glm::cross(s, e1);
+        const f32 t = f * glm::dot(e2, q);
+        if (!(t > 0.f))
+            return hit;
+
+        // pixel centers on a shared edge may land a rounding error outside, keep the barycentrics in the triangle
+        glm::vec2 barycentrics = glm::max(glm::vec2(f * glm::dot(s, h), f * glm::dot(query_ray.direction, q)), 0.f);
+        const f32 sum = barycentrics.x + barycentrics.y;
+        if (sum > 1.f)
+            barycentrics /= sum;
+
+        hit.t = t;
+        hit.triangle_id = triangle_id;
+        hit.barycentrics = barycentrics;
+        return hit;
+    }
+
+
+    void tile_rasterizer::bin_triangles(const geometry::static_mesh& mesh, const glm::mat4& view, const projection& screen, const glm::uvec2 size, worker_bins& bins, std::atomic<u32>& next_chunk) const {
+
+        const u32 triangle_count = static_cast<u32>(mesh.indices.size() / 3);
+        for (u32 first = next_chunk.fetch_add(TRIANGLES_PER_CHUNK); first < triangle_count; first = next_chunk.fetch_add(TRIANGLES_PER_CHUNK)) {
+
+            const u32 end = math::min(first + TRIANGLES_PER_CHUNK, triangle_count);
+            for (u32 triangle_id = first; triangle_id < end; triangle_id++) {
+
+                clip_vertex eye[3];
+                for (u32 corner = 0; corner < 3; corner++) {
+                    const u32 index = mesh.indices[triangle_id * 3 + corner];
+                    eye[corner] = { glm::vec3(view * glm::vec4(mesh.vertices[index].position, 1.f)), index };
+                }
+
+                clip_vertex polygon[4];
+                const u32 vertex_count = clip_near(eye, polygon);
+                if (vertex_count < 3)
+                    continue;
+
+                // screen position (x, y) and inverse depth (z) of the clipped polygon, drawn as a fan
+                glm::vec3 projected[4];
+                for (u32 x = 0; x < vertex_count; x++) {
+                    const f32 inverse_depth = 1.f / -polygon[x].position.z;
+                    projected[x] = glm::vec3(screen.scale * (glm::vec2(polygon[x].position) * inverse_depth) + screen.offset, inverse_depth);
+                }
+
+                for (u32 x = 2; x < vertex_count; x++) {
+                    const glm::vec3 fan[3] = { projected[0], projected[x - 1], projected[x] };
+                    setup_triangle(fan, size, triangle_id, bins);
+                }
+            }
+        }
+    }
+
+
+    void tile_rasterizer::setup_triangle(const glm::vec3 (&vertex)[3], const glm::uvec2 size, const u32 triangle_id, worker_bins& bins) const {
+
+        // both windings are visible to rays, back facing triangles are flipped to counter clockwise
+        glm::vec3 v0 = vertex[0], v1 = vertex[1], v2 = vertex[2];
+        glm::vec3 edge0 = edge_function(v1, v2);
+        const f32 area = edge0.x * v0.x + edge0.y * v0.y + edge0.z;
+        if (!(area != 0.f))                                                     // degenerate or NaN
+            return;
+
+        if (area < 0.f) {
+            std::swap(v1, v2);
+            edge0 = edge_function(v1, v2);
+        }
+
+        const glm::vec2 min_corner = glm::min(glm::min(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2));
+        const glm::vec2 max_corner = glm::max(glm::max(glm::vec2(v0), glm::vec2(v1)), glm::vec2(v2));
+        // pixel centers inside the box, rejected while still in float: far off screen vertices do not fit an int32
+        const glm::vec2 last_pixel = glm::vec2(size) - 1.f;
+        const glm::vec2 first = glm::ceil(min_corner - .5f);
+        const glm::vec2 last = glm::floor(max_corner - .5f);
+        if (!(first.x <= math::min(last.x, last_pixel.x) && first.y <= math::min(last.y, last_pixel.y) && last.x >= 0.f && last.y >= 0.f))
+            return;                                                             // empty after clamping (or NaN)
+
+        const glm::ivec4 bounds(glm::ivec2(glm::clamp(first, glm::vec2(0.f), last_pixel)), glm::ivec2(glm::clamp(last, glm::vec2(0.f), last_pixel)));
+
+        triangle_setup setup{};
+        setup.edge[0] = edge0;
+        setup.edge[1] = edge_function(v2, v0);
+        setup.edge[2] = edge_function(v0, v1);
+        setup.inverse_depth = glm::vec3(v0.z, v1.z, v2.z);
+        setup.inverse_area = 1.f / std::abs(area);
+        setup.triangle_id = triangle_id;
+        setup.bounds = bounds;
+
+        // tie rule: a pixel center exactly on an edge belongs to the triangle that sees the edge as "top-left",
+        // the neighbour sharing the edge has the negated coefficients and never gets it too
+        setup.tie_mask = 0;
+        for (u32 x = 0; x < 3; x++)
+            if (setup.edge[x].x > 0.f || (setup.edge[x].x == 0.f && setup.edge[x].y > 0.f))
+                setup.tie_mask |= 1u << x;
+
+        const u32 index = static_cast<u32>(bins.triangles.size());
+        bins.triangles.push_back(setup);
+        for (u32 tile_y = bounds.y / TILE_SIZE; tile_y <= bounds.w / TILE_SIZE; tile_y++)
+            for (u32 tile_x = bounds.x / TILE_SIZE; tile_x <= bounds.z / TILE_SIZE; tile_x++)
+                bins.tiles[tile_y * m_tiles_x + tile_x].push_back(index);
+    }
+
+
+    void tile_rasterizer::raster_tiles(visibility_buffer& target, std::atomic<u32>& next_tile) const {
+
+        const __m128 lane_offset = _mm_setr_ps(.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const u32 tile_count = m_tiles_x * m_tiles_y;
+        for (u32 tile = next_tile.fetch_add(1); tile < tile_count; tile = next_tile.fetch_add(1)) {
+
+            const u32 tile_x0 = (tile % m_tiles_x) * TILE_SIZE;
+            const u32 tile_y0 = (tile / m_tiles_x) * TILE_SIZE;
+            const u32 tile_x1 = math::min(tile_x0 + TILE_SIZE, target.width);
+            const u32 tile_y1 = math::min(tile_y0 + TILE_SIZE, target.height);
+            for (u32 y = tile_y0; y < tile_y1; y++) {
+                std::fill_n(target.triangle_id.begin() + static_cast<size_t>(y) * target.width + tile_x0, tile_x1 - tile_x0, geometry::INVALID_TRIANGLE_ID);
+                std::fill_n(target.inverse_depth.begin() + static_cast<size_t>(y) * target.width + tile_x0, tile_x1 - tile_x0, 0.f);
+            }
+
+            for (const worker_bins& bins : m_bins) {
+                for (const u32 index : bins.tiles[tile]) {
+
+                    const triangle_setup& setup = bins.triangles[index];
+                    const u32 x_begin = tile_x0 + ((math::max(static_cast<u32>(setup.bounds.x), tile_x0) - tile_x0) & ~(LANES - 1));
+                    const u32 x_end = math::min(static_cast<u32>(setup.bounds.z) + 1, tile_x1);
+                    const u32 y_begin = math::max(static_cast<u32>(setup.bounds.y), tile_y0);
+                    const u32 y_end = math::min(static_cast<u32>(setup.bounds.w) + 1, tile_y1);
+
+                    __m128 a[3], inclusive[3];
+                    for (u32 e = 0; e < 3; e++) {
+                        a[e] = _mm_set1_ps(setup.edge[e].x);
+                        inclusive[e] = _mm_castsi128_ps(_mm_set1_epi32((setup.tie_mask >> e) & 1u ? -1 : 0));
+                    }
+                    const __m128 inverse_area = _mm_set1_ps(setup.inverse_area);
+                    const __m128i triangle_id = _mm_set1_epi32(static_cast<int>(setup.triangle_id));
+
+                    for (u32 y = y_begin; y < y_end; y++) {
+
+                        const f32 pixel_y = static_cast<f32>(y) + .5f;
+                        __m128 row[3];
+                        for (u32 e = 0; e < 3; e++)
+                            row[e] = _mm_set1_ps(setup.edge[e].y * pixel_y + setup.edge[e].z);
+
+                        for (u32 x = x_begin; x < x_end; x += LANES) {
+
+                            // same expression for every triangle, so the functions of a shared edge are exact negatives
+                            const __m128 pixel_x = _mm_add_ps(_mm_set1_ps(static_cast<f32>(x)), lane_offset);
+                            __m128 covered = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                            __m128 weight[3];
+                            for (u32 e = 0; e < 3; e++) {
+                                weight[e] = _mm_add_ps(_mm_mul_ps(a[e], pixel_x), row[e]);
+                                const __m128 inside = _mm_blendv_ps(_mm_cmpgt_ps(weight[e], zero), _mm_cmpge_ps(weight[e], zero), inclusive[e]);
+                                covered = _mm_and_ps(covered, inside);
+                            }
+                            int mask = _mm_movemask_ps(covered);
+                            if (x + LANES > x_end)
+                                mask &= (1 << (x_end - x)) - 1;
+                            if (!mask)
+                                continue;
+
+                            const __m128 depth = _mm_mul_ps(_mm_add_ps(_mm_add_ps(
+                                _mm_mul_ps(weight[0], _mm_set1_ps(setup.inverse_depth.x)),
+                                _mm_mul_ps(weight[1], _mm_set1_ps(setup.inverse_depth.y))),
+                                _mm_mul_ps(weight[2], _mm_set1_ps(setup.inverse_depth.z))), inverse_area);
+
+                            // closer wins, equal depth goes to the lower triangle id so the result does not depend on the bin order
+                            const size_t offset = static_cast<size_t>(y) * target.width + x;
+                            alignas(16) f32 depth_values[LANES];
+                            alignas(16) u32 id_values[LANES];
+                            const u32 lanes = math::min(LANES, tile_x1 - x);
+                            std::memcpy(depth_values, target.inverse_depth.data() + offset, lanes * sizeof(f32));
+                            std::memcpy(id_values, target.triangle_id.data() + offset, lanes * sizeof(u32));
+                            const __m128 stored_depth = _mm_load_ps(depth_values);
+                            const __m128i stored_id = _mm_load_si128(reinterpret_cast<const __m128i*>(id_values));
+                            const __m128 closer = _mm_or_ps(_mm_cmpgt_ps(depth, stored_depth),
+                                _mm_and_ps(_mm_cmpeq_ps(depth, stored_depth), _mm_castsi128_ps(_mm_cmplt_epi32(triangle_id, stored_id))));
+                            mask &= _mm_movemask_ps(closer);
+                            if (!mask)
+                                continue;
+
+                            const __m128 write = _mm_castsi128_ps(_mm_setr_epi32(mask & 1 ? -1 : 0, mask & 2 ? -1 : 0, mask & 4 ? -1 : 0, mask & 8 ? -1 : 0));
+                            _mm_store_ps(depth_values, _mm_blendv_ps(stored_depth, depth, write));
+                            _mm_store_si128(reinterpret_cast<__m128i*>(id_values), _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(stored_id), _mm_castsi128_ps(triangle_id), write)));
+                            std::memcpy(target.inverse_depth.data() + offset, depth_values, lanes * sizeof(f32));
+                            std::memcpy(target.triangle_id.data() + offset, id_values, lanes * sizeof(u32));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+}
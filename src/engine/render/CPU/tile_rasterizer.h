@@ -0,0 +1,83 @@
+#pragma once
+
+#include "geometry/ray_query.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::render::CPU {
+
+    // @brief Closest surface of every pixel, rows are stored bottom-up like gl_FragCoord
+    struct visibility_buffer {
+
+        u32                                 width = 0;
+        u32                                 height = 0;
+        std::vector<u32>                    triangle_id{};          // index of the triangle in [static_mesh::indices] / 3, geometry::INVALID_TRIANGLE_ID if empty
+        std::vector<f32>                    inverse_depth{};        // 1 / view space depth of the surface, 0 if empty
+
+        void resize(const u32 new_width, const u32 new_height) {
+
+            width = new_width;
+            height = new_height;
+            triangle_id.resize(static_cast<size_t>(width) * height);
+            inverse_depth.resize(static_cast<size_t>(width) * height);
+        }
+    };
+
+    // @brief Binned tile rasterizer for primary visibility, an alternative to one BVH traversal per pixel.
+    //        Pass 1 transforms, near-clips and sets up all triangles in parallel chunks, every worker appends them to its own bins (one per tile).
+    //        Pass 2 hands out whole tiles to the workers, a tile tests the triangles of its bins 4 pixels at a time (SSE) with a depth test.
+    //        Pixel centers and the projection are the ones of the ray tracer's camera rays, so resolve_hit() gives the same hit a ray would.
+    //        Shared edges use a tie rule on exactly negated edge functions, no pixel is covered twice or missed between two triangles.
+    class tile_rasterizer {
+    public:
+
+        static constexpr u32                TILE_SIZE = 64;
+
+        tile_rasterizer(const u32 thread_count = 0);
+        ~tile_rasterizer() = default;
+
+        DELETE_COPY_CONSTRUCTOR(tile_rasterizer);
+        DEFAULT_GETTER_C(u32,                                   thread_count)
+
+        // @brief Rasterizes [mesh] into [target] (size must already be set)
+        // @param [inv_proj] [inv_view] Camera matrices as used for the camera rays of the ray tracer
+        void render(const geometry::static_mesh& mesh, const glm::mat4& inv_proj, const glm::mat4& inv_view, visibility_buffer& target);
+
+        // @brief Hit of [query_ray] on the plane of [triangle_id] with the same t and barycentrics as a ray query, for pixels of a [visibility_buffer]
+        static geometry::ray_hit resolve_hit(const geometry::static_mesh& mesh, const geometry::ray& query_ray, const u32 triangle_id);
+
+    private:
+
+        // screen space triangle, edge functions are [a * x + b * y + c] at pixel centers and positive inside
+        struct triangle_setup {
+            glm::vec3                       edge[3];                // (a, b, c) of the edge opposite each vertex
+            glm::vec3                       inverse_depth;          // per vertex, linear in screen space
+            f32                             inverse_area;           // normalizes the edge functions to barycentrics
+            u32                             tie_mask;               // bit i: pixels exactly on edge i belong to this triangle
+            u32                             triangle_id;
+            glm::ivec4                      bounds;                 // pixel rect (min x, min y, max x, max y), inclusive
+        };
+
+        // maps eye space points to pixel coordinates the way the camera rays of the ray tracer are generated
+        struct projection {
+            glm::mat2                       scale{1.f};
+            glm::vec2                       offset{0.f};
+        };
+
+        struct worker_bins {
+            std::vector<triangle_setup>     triangles{};
+            std::vector<std::vector<u32>>   tiles{};                // indices into [triangles] per tile
+        };
+
+        void bin_triangles(const geometry::static_mesh& mesh, const glm::mat4& view, const projection& screen, const glm::uvec2 size, worker_bins& bins, std::atomic<u32>& next_chunk) const;
+        void setup_triangle(const glm::vec3 (&vertex)[3], const glm::uvec2 size, const u32 triangle_id, worker_bins& bins) const;
+        void raster_tiles(visibility_buffer& target, std::atomic<u32>& next_tile) const;
+
+        u32                                 m_thread_count = 1;
+        u32                                 m_tiles_x = 0;
+        u32                                 m_tiles_y = 0;
+        std::vector<worker_bins>            m_bins{};
+    };
+
+}
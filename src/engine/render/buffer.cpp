@@ -3,6 +3,8 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "open_GL/state_cache.h"
+
 #include "buffer.h"
 
 namespace GLT::render {
@@ -19,43 +21,169 @@ namespace GLT::render {
     }
 
 
+    static GLenum gl_target(const buffer::type type) {
+        switch(type) {
+            case buffer::type::VERTEX: return GL_ARRAY_BUFFER;
+            case buffer::type::INDEX: return GL_ELEMENT_ARRAY_BUFFER;
+            case buffer::type::UNIFORM: return GL_UNIFORM_BUFFER;
+            default: return GL_SHADER_STORAGE_BUFFER;
+        }
+    }
+
+
+    // every copy of a ring has to start at an offset glBindBufferRange() accepts for storage and uniform bindings
+    static size_t get_ring_alignment() {
+
+        static const size_t s_alignment = [] {
+            GLint storage_alignment = 0, uniform_alignment = 0;
+            glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+            return static_cast<size_t>(math::max(math::max(storage_alignment, uniform_alignment), 16));
+        }();
+        return s_alignment;
+    }
+
+
     buffer::buffer(type type, usage usage)
         : m_type(type), m_usage(usage) {}
-    
-    buffer::~buffer() {
-        if (m_ID)
-            glDeleteBuffers(1, &m_ID);
-    }
+
+    buffer::~buffer() { destroy(); }
 
     void buffer::create(const void* data, size_t size) {
 
-        if (m_ID)
-            glDeleteBuffers(1, &m_ID);
-        
+        destroy();
         glGenBuffers(1, &m_ID);
-        bind();
+        m_size = size;
+
+        // uploaded through the copy target, binding the element buffer here would change the state of a bound VAO
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+        if (m_usage == usage::STATIC || !GLEW_ARB_buffer_storage) {
 
-        switch(m_type) {
-            case type::VERTEX:      glBufferData(GL_ARRAY_BUFFER, size, data, gl_usage(m_usage)); break;
-            case type::INDEX:       glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, gl_usage(m_usage)); break;
-            default: break;
+            glBufferData(GL_COPY_WRITE_BUFFER, size, data, gl_usage(m_usage));
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            return;
         }
-        
-        unbind();
-        m_size = size;
+
+        const size_t alignment = get_ring_alignment();
+        m_stride = (math::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, m_stride * RING_SIZE, nullptr, flags);
+        m_mapped = static_cast<u8*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_stride * RING_SIZE, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        VALIDATE(m_mapped != nullptr, destroy(); return, "", "Failed to map streaming buffer of [" << size << "] bytes");
+
+        m_ring_index = RING_SIZE - 1;                       // the first map_next() starts at copy 0
+        if (data)
+            update(data, size);
     }
 
-    void buffer::bind() const {
-        GLenum target = m_type == type::VERTEX ? GL_ARRAY_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
-        glBindBuffer(target, m_ID);
+    void buffer::destroy() {
+
+        for (void*& fence : m_fences) {
+            if (fence)
+                glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+        if (m_mapped) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            m_mapped = nullptr;
+        }
+        if (m_ID) {
+            render::open_GL::state_cache::forget_buffer(m_ID);
+            glDeleteBuffers(1, &m_ID);
+        }
+        m_ID = 0;
+        m_size = m_stride = m_offset = 0;
     }
 
-    void buffer::unbind() const {
-        GLenum target = m_type == type::VERTEX ? GL_ARRAY_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
-        glBindBuffer(target, 0);
+    void buffer::update(const void* data, size_t size) {
+
+        VALIDATE(size <= m_size, return, "", "Buffer update of [" << size << "] bytes exceeds the buffer size [" << m_size << "]");
+        if (!is_ring()) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            return;
+        }
+        std::memcpy(map_next(), data, size);
     }
+
+    void buffer::upload(const void* data, size_t offset, size_t size) {
+
+        VALIDATE(!is_ring() && offset + size <= m_size, return, "", "Buffer upload of [" << size << "] bytes at [" << offset << "] does not fit a static buffer of [" << m_size << "] bytes");
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void buffer::reallocate(size_t new_size, const std::vector<copy_region>& regions) {
+
+        VALIDATE(!is_ring(), return, "", "Only static buffers can be reallocated");
+        GLuint new_ID = 0;
+        glGenBuffers(1, &new_ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, new_ID);
+        glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, gl_usage(m_usage));
+        glBindBuffer(GL_COPY_READ_BUFFER, m_ID);
+        for (const copy_region& region : regions)
+            if (region.size > 0)
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, region.source_offset, region.offset, region.size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (m_ID) {
+            render::open_GL::state_cache::forget_buffer(m_ID);
+            glDeleteBuffers(1, &m_ID);
+        }
+        m_ID = new_ID;
+        m_size = new_size;
+    }
+
+    void* buffer::map_next() {
+
+        VALIDATE(is_ring(), return nullptr, "", "map_next() needs a DYNAMIC or STREAM buffer with persistent mapping");
+
+        // commands recorded so far read the current copy, it is free again once they are done
+        if (m_fences[m_ring_index])
+            glDeleteSync(static_cast<GLsync>(m_fences[m_ring_index]));
+        m_fences[m_ring_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_ring_index = (m_ring_index + 1) % RING_SIZE;
+        m_offset = m_ring_index * m_stride;
+        if (GLsync fence = static_cast<GLsync>(m_fences[m_ring_index])) {
+
+            GLenum result = glClientWaitSync(fence, 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED) {
+                m_stall_count++;
+                do {
+                    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);       // 1ms
+                } while (result == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fence);
+            m_fences[m_ring_index] = nullptr;
+        }
+        return m_mapped + m_offset;
+    }
+
+    void buffer::bind() const { glBindBuffer(gl_target(m_type), m_ID); }
+
+    void buffer::unbind() const { glBindBuffer(gl_target(m_type), 0); }
+
+    void buffer::bind_storage(const u32 index) const { bind_range(GL_SHADER_STORAGE_BUFFER, index); }
+
+    void buffer::bind_uniform(const u32 index) const { bind_range(GL_UNIFORM_BUFFER, index); }
+
+    void buffer::bind_range(const u32 target, const u32 index) const {
+
+        if (is_ring())
+            render::open_GL::state_cache::bind_buffer(target, index, m_ID, m_offset, m_size);
+        else
+            render::open_GL::state_cache::bind_buffer(target, index, m_ID);
+    }
+
 #else
     #error "No valid renderer configured"
 #endif
 
-}
\ No newline at end of file
+}
@@ -4,28 +4,76 @@
 namespace GLT::render {
     
     // Base buffer interface
+    // A GL buffer object is not tied to a target, the same buffer is bound as vertex/index buffer for rasterization
+    // and as shader storage buffer for the ray tracer, so every mesh array exists only once on the GPU
+    //
+    // usage::STATIC uploads once with glBufferData.
+    // usage::DYNAMIC / STREAM keep a ring of RING_SIZE copies in one immutable buffer (glBufferStorage) that stays mapped
+    // persistently and coherently. update() is a memcpy into the next copy, a fence per copy makes sure the GPU finished
+    // reading it before it is written again, nothing is reallocated and the driver never has to synchronize.
     class buffer {
     public:
     
-        enum class type { VERTEX, INDEX };
+        enum class type { VERTEX, INDEX, STORAGE, UNIFORM };
         enum class usage { STATIC, DYNAMIC, STREAM };
+
+        static constexpr u32 RING_SIZE = 3;                 // frames the CPU may write ahead of the GPU
+
+        // @brief Bytes moved from the old to the new storage by reallocate()
+        struct copy_region {
+            size_t  source_offset;
+            size_t  offset;
+            size_t  size;
+        };
     
         buffer(type type, usage usage);
         ~buffer();
         
         void bind() const;
         void unbind() const;
+        // @brief Binds the buffer (the copy of the last update() for a ring) to the indexed shader storage binding point [index]
+        void bind_storage(const u32 index) const;
+        // @brief Binds the buffer (the copy of the last update() for a ring) to the indexed uniform binding point [index]
+        void bind_uniform(const u32 index) const;
         void create(const void* data, size_t size);
+        void destroy();
+
+        // @brief Replaces the first [size] bytes (<= get_size()), for a ring the other bytes of the new copy are undefined
+        void update(const void* data, size_t size);
+
+        // @brief Writes [size] bytes at [offset] of a STATIC buffer
+        void upload(const void* data, size_t offset, size_t size);
+
+        // @brief Replaces the storage of a STATIC buffer by [new_size] bytes and copies [regions] over on the GPU, the ID changes
+        void reallocate(size_t new_size, const std::vector<copy_region>& regions);
+
+        // @brief Next copy of a ring for writing [get_size()] bytes, waits only if the GPU still reads it. Call once per new content
+        void* map_next();
     
         DEFAULT_GETTER_SETTER(u32,  ID)
         DEFAULT_GETTER(type,        type)
-        DEFAULT_GETTER(size_t,      size)
+        DEFAULT_GETTER_C(size_t,    size)
+        // @brief Byte offset of the current copy, 0 for STATIC buffers (needed for vertex attribute offsets of a ring)
+        DEFAULT_GETTER_C(size_t,    offset)
+        // @brief Number of times map_next() had to wait for the GPU
+        DEFAULT_GETTER_C(u64,       stall_count)
 
     protected:
         type        m_type;
         usage       m_usage;
         u32         m_ID = 0;
         size_t      m_size = 0;
+
+        // ring of DYNAMIC / STREAM buffers
+        u8*         m_mapped = nullptr;
+        size_t      m_stride = 0;                           // [m_size] aligned to the binding offset alignment
+        size_t      m_offset = 0;
+        u32         m_ring_index = 0;
+        void*       m_fences[RING_SIZE] = {};               // GLsync, signaled when the GPU finished the commands that read the copy
+        u64         m_stall_count = 0;
+
+        FORCEINLINE bool is_ring() const { return m_mapped != nullptr; }
+        void bind_range(const u32 target, const u32 index) const;
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,70 @@
+#include "util/pch.h"
+
+#include "dynamic_resolution.h"
+
+
+namespace GLT::render {
+
+    constexpr f32 LOAD_UPPER = .95f;                // above this share of the budget the scale goes down
+    constexpr f32 LOAD_LOWER = .70f;                // below this share of the budget the scale goes up
+    constexpr f32 LOAD_GOAL = .82f;                 // a correction aims for the middle of the band
+    constexpr f32 SMOOTHING = .1f;                  // weight of the newest frame in the running average
+    constexpr f32 MAX_STEP = 1.25f;                 // largest relative change of the scale per correction
+    constexpr f32 SCALE_QUANTUM = 1.f / 64.f;       // avoids retargeting for changes nobody can see
+    constexpr u32 COOLDOWN_FRAMES = 12;
+
+
+    bool dynamic_resolution::update(const f32 work_time, const f32 target_frame_time) {
+
+        m_settings.min_scale = math::clamp(m_settings.min_scale, LOWEST_SCALE, HIGHEST_SCALE);
+        m_settings.max_scale = math::clamp(m_settings.max_scale, m_settings.min_scale, HIGHEST_SCALE);
+
+        const f32 old_scale = m_scale;
+        if (!m_settings.enabled || target_frame_time <= 0.f) {
+
+            m_settings.scale = math::clamp(m_settings.scale, LOWEST_SCALE, HIGHEST_SCALE);
+            m_scale = m_settings.enabled ? m_settings.max_scale : m_settings.scale;
+            m_smoothed_frame_time = 0.f;
+            m_cooldown = 0;
+            return m_scale != old_scale;
+        }
+
+        if (work_time <= 0.f)                                   // GPU times arrive a few frames late
+            return false;
+
+        m_smoothed_frame_time = (m_smoothed_frame_time == 0.f) ? work_time : math::lerp(m_smoothed_frame_time, work_time, SMOOTHING);
+        m_scale = math::clamp(m_scale, m_settings.min_scale, m_settings.max_scale);         // range may have been changed in the UI
+        if (m_cooldown > 0) {
+            m_cooldown--;
+            return m_scale != old_scale;
+        }
+
+        const f32 load = m_smoothed_frame_time / target_frame_time;
+        if (load > LOAD_UPPER || load < LOAD_LOWER) {
+
+            // tracing cost grows with the pixel count, which is the square of the scale
+            f32 new_scale = m_scale * std::sqrt(LOAD_GOAL / math::max(load, 1e-3f));
+            new_scale = math::clamp(new_scale, m_scale / MAX_STEP, m_scale * MAX_STEP);
+            new_scale = std::round(new_scale / SCALE_QUANTUM) * SCALE_QUANTUM;
+            new_scale = math::clamp(new_scale, m_settings.min_scale, m_settings.max_scale);
+            if (new_scale != m_scale) {
+
+                const f32 ratio = new_scale / m_scale;
+                m_smoothed_frame_time *= ratio * ratio;             // expected cost, corrected by the next measurements
+                m_scale = new_scale;
+                m_cooldown = COOLDOWN_FRAMES;
+            }
+        }
+
+        return m_scale != old_scale;
+    }
+
+
+    glm::uvec2 dynamic_resolution::get_render_extent(const u32 width, const u32 height) const {
+
+        return glm::uvec2(
+            math::max(static_cast<u32>(width * m_scale + .5f), 1u),
+            math::max(static_cast<u32>(height * m_scale + .5f), 1u));
+    }
+
+}
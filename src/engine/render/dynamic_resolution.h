@@ -0,0 +1,45 @@
+#pragma once
+
+
+namespace GLT::render {
+
+    // @brief Internal ray tracing resolution as a factor of the window size, fixed or moving in a range
+    struct dynamic_resolution_settings {
+        bool enabled = false;
+        f32 scale = 1.f;                                            // used while [enabled] is off, below 1 for a fast preview, above 1 supersamples
+        f32 min_scale = .5f;
+        f32 max_scale = 1.f;
+    };
+
+    // @brief Picks the internal ray tracing resolution from the measured frame time so heavy meshes stay at the target FPS.
+    //        The renderer traces into a scaled target and scales it to the window (see [upscale_settings]), the UI stays at window resolution.
+    //        Render side frame times are smoothed and the scale only moves when they leave a band around the budget (hysteresis),
+    //        after a change it waits a few frames so the new resolution shows up in the measurement before correcting again.
+    class dynamic_resolution {
+    public:
+
+        static constexpr f32                LOWEST_SCALE = .25f;
+        static constexpr f32                HIGHEST_SCALE = 2.f;                    // 4 samples per window pixel
+
+        // @brief Feed the render side cost of the last measured frame, the GPU time of the frame packet metrics, not the main thread frame
+        // @param work_time GPU time of the last measured frame in seconds, 0 (no measurement yet) keeps the scale
+        // @param target_frame_time frame budget in seconds (1 / target FPS)
+        // @return true if the scale changed
+        bool update(const f32 work_time, const f32 target_frame_time);
+
+        // @brief Size the ray tracer should render at for a window of [width] x [height]
+        glm::uvec2 get_render_extent(const u32 width, const u32 height) const;
+
+        DEFAULT_GETTER_C(f32,                               scale)
+        DEFAULT_GETTER_C(dynamic_resolution_settings,       settings)
+        DEFAULT_GETTER_REF(dynamic_resolution_settings,     settings)
+
+    private:
+
+        dynamic_resolution_settings         m_settings{};
+        f32                                 m_scale = 1.f;
+        f32                                 m_smoothed_frame_time = 0.f;
+        u32                                 m_cooldown = 0;
+    };
+
+}
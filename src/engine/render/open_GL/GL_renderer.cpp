@@ -17,6 +17,7 @@
 #include "game_object/camera.h"
 #include "project/file_watcher_system.h"
 
+#include "state_cache.h"
 #include "GL_renderer.h"
 
 
@@ -30,7 +31,18 @@ namespace GLT::render::open_GL {
 
         LOG(Trace, "File changed [" << file.generic_string() << "]");
         std::string output{};
-        reload_fragment_shader(file, output);
+
+        // an edited include rebuilds the shader using it, any other fragment shader becomes the displayed one
+        const std::filesystem::path changed = std::filesystem::weakly_canonical(file);
+        const auto uses_file = [&changed](const tracer_permutation& permutation) { return std::find(permutation.files.begin(), permutation.files.end(), changed) != permutation.files.end(); };
+        const bool is_dependency = std::any_of(m_permutations.begin(), m_permutations.end(), [&uses_file](const auto& permutation) { return uses_file(permutation.second); });
+
+        if (m_pending_reload.job != 0 && uses_file(m_pending_reload))
+            reload_fragment_shader(m_render_shader_reload.file, output);
+        else if (is_dependency)
+            reload_fragment_shader(m_fragment_file, output);
+        else if (changed.extension() == ".frag")
+            reload_fragment_shader(changed, output);
 	}
     
     GL_renderer::GL_renderer(ref<window> window, ref<layer_stack> layer_stack)
@@ -51,6 +63,15 @@ namespace GLT::render::open_GL {
     
         create_shader_program();
         create_fullscreen_quad();
+        m_pass_program_cache.create(util::get_executable_path().parent_path() / "shader_cache" / "passes");
+        m_reprojection_cache.create(m_window->get_width(), m_window->get_height(), m_pass_program_cache);
+        m_traversal_statistics.create(m_window->get_width(), m_window->get_height());
+        m_g_buffer.create(m_window->get_width(), m_window->get_height(), m_pass_program_cache);
+        m_upscaler.create(m_pass_program_cache);
+        m_window_extent = m_target_extent = m_reprojection_cache.get_target_size();
+        m_mesh_pool.create();
+        m_frame_uniforms.create(nullptr, sizeof(frame_uniforms));
+        create_blue_noise_texture();
         
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -64,289 +85,300 @@ namespace GLT::render::open_GL {
 		m_file_watcher.p_notify_filters = notify_filters::last_access | notify_filters::last_write | notify_filters::file_name | notify_filters::directory_name;
 		m_file_watcher.filter = "*.frag";
 		m_file_watcher.include_sub_directories = true;
-        m_file_watcher.on_changed = [this](const std::filesystem::path& file) { this->auto_reload_file(file); };
-        m_file_watcher.on_created = [this](const std::filesystem::path& file) { this->auto_reload_file(file); };
-        m_file_watcher.on_renamed = [this](const std::filesystem::path& file) { this->auto_reload_file(file); };
+        // the watcher thread has no context, the reload runs on the render thread
+        m_file_watcher.on_changed = [this](const std::filesystem::path& file) { enqueue([this, file] { auto_reload_file(file); }); };
+        m_file_watcher.on_created = [this](const std::filesystem::path& file) { enqueue([this, file] { auto_reload_file(file); }); };
+        m_file_watcher.on_renamed = [this](const std::filesystem::path& file) { enqueue([this, file] { auto_reload_file(file); }); };
 		m_file_watcher.compile = nullptr;
 		m_file_watcher.start();
 
         m_active_camera = application::get().get_world_layer()->get_editor_camera();        // Force get editor camera for now
-
-#ifdef DEBUG
-        glGenQueries(1, &m_total_render_time);
-#endif
+        m_GPU_timer.create();
     }
     
     GL_renderer::~GL_renderer() {
         
-		m_file_watcher.stop();
+		m_file_watcher.stop();                              // nothing can enqueue a reload anymore
+        stop_render_thread();                               // draws the last frames, the context is current here again
+        clear_permutations();
+        m_shader_compiler.destroy();
     }
     
 
 
 
-    void GL_renderer::draw_frame(float delta_time) {
-    
-#ifdef DEBUG
-		m_general_performance_metrik.next_iteration();
-        glBeginQuery(GL_TIME_ELAPSED, m_total_render_time);
-#endif
+    void GL_renderer::build_frame(frame_packet& packet) {
+
+        // ------ UI, ImGui keeps its draw lists for the next frame so the render thread draws a copy ------
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        for (layer* layer : *renderer::m_layer_stack) 
+            layer->on_imgui_render();
+
+        ImGui::Render();
+        packet.UI.capture(ImGui::GetDrawData());
+
+        // ------ camera and window ------
+        const u32 width = m_window->get_width();
+        const u32 height = m_window->get_height();
+        packet.inv_proj = m_active_camera->get_inverse_projection((f32)width / (f32)height);
+        packet.inv_view = m_active_camera->get_inverse_view();
+        packet.camera_position = m_active_camera->get_position();
+        packet.window_extent = glm::uvec2(width, height);
+        packet.render_extent = m_dynamic_resolution.get_render_extent(width, height);
+        packet.render_scale = m_dynamic_resolution.get_scale();
+        m_window->get_mouse_position(packet.mouse);
+
+        // ------ mesh, the BVH debug values are changed by the UI ------
+        packet.mesh = application::get().get_world_layer()->GET_RENDER_MESH();
+        packet.bvh_viz_max_depth = packet.mesh->bvh_viz_max_depth;
+        packet.bvh_show_leaves = packet.mesh->bvh_show_leaves;
+        packet.bvh_viz_color = packet.mesh->bvh_viz_color;
+    }
+
+
+    void GL_renderer::render_frame(frame_packet& packet) {
+
+        const auto render_start = std::chrono::steady_clock::now();
+        m_settings = packet.settings;
+
+		m_render_metrik.next_iteration();
+        poll_shader_compiler();
+        m_GPU_timer.begin_frame();
+        const GPU_timer::frame_times& GPU_times = m_GPU_timer.get_latest();
+        m_render_metrik.renderer_draw_time[m_render_metrik.current_index] = GPU_times.zone[static_cast<u32>(GPU_zone::trace)];
+        m_render_metrik.GPU_trace_time = GPU_times.zone[static_cast<u32>(GPU_zone::trace)];
+        m_render_metrik.GPU_upscale_time = GPU_times.zone[static_cast<u32>(GPU_zone::upscale)];
+        m_render_metrik.GPU_UI_time = GPU_times.zone[static_cast<u32>(GPU_zone::UI)];
+        m_render_metrik.GPU_present_time = GPU_times.zone[static_cast<u32>(GPU_zone::present)];
+        m_GPU_timer.begin_zone(GPU_zone::trace);
 
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    	
-        // view = m_active_camera->get_view();
-		// proj = glm::perspective(glm::radians(m_active_camera->get_perspective_fov_y()), (float)m_draw_extent.width / (float)m_draw_extent.height, m_active_camera->get_clipping_far(), m_active_camera->get_clipping_near());
 
-        glUseProgram(m_shader_program);
+        // ------ reproject last frame's hits, tracing goes into the offscreen target ------
+        const frame_camera camera{ packet.inv_proj, packet.inv_view, packet.camera_position };
+        const glm::uvec2 render_extent = packet.render_extent;
+        resize_targets(render_extent);
+
+        // ------ time slicing: trace every [slice_count]th scanline, the rest of the image stays from earlier frames ------
+        u32 slice_count = 1;
+        if (m_settings.time_slicing.enabled) {
+
+            const u32 rows_per_frame = math::max(m_settings.time_slicing.ray_budget / render_extent.x, 1u);
+            slice_count = math::min((render_extent.y + rows_per_frame - 1) / rows_per_frame, render_extent.y);
+            m_reprojection_cache.invalidate();              // history of the untouched scanlines is from older cameras
+        }
+        const u32 slice_index = static_cast<u32>(m_reprojection_cache.get_frame_index() % slice_count);
+
+        // ------ hybrid: rasterize primary visibility, every pixel starts at its G-buffer surface so there is nothing to reuse ------
+        const GLT::geometry::static_mesh& mesh = *packet.mesh;
+        const bool rasterized_primary = m_settings.hybrid_rendering.enabled && m_g_buffer.render(m_mesh_pool, mesh, camera, render_extent);
+        const bool reuse_hits = m_reprojection_cache.begin_frame(camera, render_extent, m_settings.temporal_reuse.enabled && !rasterized_primary);
+
+        // ------ camera and frame data, one uniform block written once per frame ------
+        const glm::uvec2 traced_extent = m_reprojection_cache.get_render_extent();
+        const f32 scale = packet.render_scale;
+        static float totalTime = 0.0f;
+        totalTime += packet.delta_time;
+
+        frame_uniforms frame{};
+        frame.inv_proj = camera.inv_proj;
+        frame.inv_view = camera.inv_view;
+        frame.cam_pos = camera.position;
+        frame.time = totalTime;
+        frame.resolution = glm::vec2(traced_extent);
+        frame.mouse = glm::vec2(packet.mouse.x * scale, (packet.window_extent.y - packet.mouse.y) * scale);         // Flip Y
+        frame.reuse_enabled = reuse_hits;
+        frame.refresh_period = math::max(m_settings.temporal_reuse.refresh_period, 1u);
+        frame.frame_index = static_cast<int32>(m_reprojection_cache.get_frame_index() % std::numeric_limits<int32>::max());
+        frame.slice_count = slice_count;
+        frame.slice_index = slice_index;
+        frame.light_radius = glm::tan(glm::radians(math::clamp(m_settings.soft_shadows.light_angle, 0.f, 45.f)));
+        frame.shadow_samples = math::max(m_settings.soft_shadows.samples, 1u);
+        frame.sample_pattern = static_cast<int32>(m_settings.soft_shadows.pattern);
+        frame.rasterized_primary = rasterized_primary;
+        m_frame_uniforms.update(&frame, sizeof(frame));
+        m_frame_uniforms.bind_uniform(FRAME_UNIFORM_BINDING);
+
+        const tracer_program& program = get_active_program();
+        state_cache::use_program(program.ID);
+        if (program.time != -1) {
+            glUniform1f(program.time, frame.time);
+            glUniform2fv(program.resolution, 1, glm::value_ptr(frame.resolution));
+            glUniform2fv(program.mouse, 1, glm::value_ptr(frame.mouse));
+        }
+
+        // ------ soft shadows ------
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, m_blue_noise_texture);
+        glActiveTexture(GL_TEXTURE0);
+
+        // ------ traversal statistics (instrumented permutation only) ------
+        const bool collect_stats = (program.features & TRACER_TRAVERSAL_STATS);
+        if (collect_stats) {
+            m_traversal_statistics.begin_frame(m_reprojection_cache.get_render_extent());
+            glUniform1i(program.show_heatmap, m_settings.traversal_stats.show_heatmap);
+            glUniform1ui(program.heatmap_max, math::max(m_settings.traversal_stats.heatmap_max, 1u));
+        }
     
         // ------ bind mesh ------
-        ref<GLT::geometry::static_mesh> mesh = application::get().get_world_layer()->GET_RENDER_MESH();
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mesh->vertex_ssbo);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mesh->index_ssbo);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mesh->bvh_ssbo);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mesh->triidx_ssbo);
-        
-        // Add BVH-related uniforms
-        GLint loc_bvh_root = glGetUniformLocation(m_shader_program, "u_bvh_root");
-        GLint loc_bvh_nodes = glGetUniformLocation(m_shader_program, "u_bvh_nodes");
-        glUniform1i(loc_bvh_root, 0);  // Root node index
-        glUniform1i(loc_bvh_nodes, 2); // SSBO binding point
-        mesh->vertex_buffer.bind();
-        mesh->index_buffer.bind();
+        m_mesh_pool.bind_storage();
+        const geometry::GPU_mesh_range& range = mesh.GPU_range;
+        glUniform4ui(program.mesh_offsets, range.first_vertex, range.first_index, range.first_node, range.first_tri);
 
         // ------ BVH debug uniforms ------
-        glUniform1i(glGetUniformLocation(m_shader_program, "u_bvh_viz_bounds_depth"), mesh->bvh_viz_max_depth);
-        glUniform1i(glGetUniformLocation(m_shader_program, "u_bvh_viz_triangle_depth"), mesh->bvh_show_leaves);
-        glUniform4fv(glGetUniformLocation(m_shader_program, "u_bvh_viz_color"), 1, glm::value_ptr(mesh->bvh_viz_color));
-
-        // ------ Camera uniforms ------
-        const glm::mat4 inv_proj = m_active_camera->get_inverse_projection((f32)m_window->get_width() / (f32)m_window->get_height());
-        const glm::mat4 inv_view = m_active_camera->get_inverse_view();
-        const glm::vec3 cam_pos = m_active_camera->get_position();
-
-        glUniformMatrix4fv(glGetUniformLocation(m_shader_program, "u_inv_proj"), 1, GL_FALSE, glm::value_ptr(inv_proj));
-        glUniformMatrix4fv(glGetUniformLocation(m_shader_program, "u_inv_view"), 1, GL_FALSE, glm::value_ptr(inv_view));
-        glUniform3f(glGetUniformLocation(m_shader_program, "u_cam_pos"), cam_pos.x, cam_pos.y, cam_pos.z);
-
-        // ------ Set general uniforms ------
-        const int height = m_window->get_height();
-        glUniform2f(glGetUniformLocation(m_shader_program, "u_resolution"), (float)m_window->get_width(), (float)height);
-    
-        m_window->get_mouse_position(mouse_pos);
-        glUniform2f(glGetUniformLocation(m_shader_program, "u_mouse"), mouse_pos.x, (height - mouse_pos.y)); // Flip Y
-    
-        static float totalTime = 0.0f;
-        totalTime += delta_time;
-        glUniform1f(glGetUniformLocation(m_shader_program, "u_time"), totalTime);
+        glUniform1i(program.bvh_viz_bounds_depth, packet.bvh_viz_max_depth);
+        glUniform1i(program.bvh_viz_triangle_depth, packet.bvh_show_leaves);
+        glUniform4fv(program.bvh_viz_color, 1, glm::value_ptr(packet.bvh_viz_color));
 
         // ------ Draw fullscreen quad ------
         glBindVertexArray(m_vao);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
         glBindVertexArray(0);
-    
-#ifdef DEBUG        // set performance stuff
-        glEndQuery(GL_TIME_ELAPSED);
-        GLint available = 0;
-        while (!available)
-            glGetQueryObjectiv(m_total_render_time, GL_QUERY_RESULT_AVAILABLE, &available);
-
-        GLuint64 elapsed_time;
-        glGetQueryObjectui64v(m_total_render_time, GL_QUERY_RESULT, &elapsed_time);
-        m_general_performance_metrik.renderer_draw_time[m_general_performance_metrik.current_index] = elapsed_time / 1e6f;
-        m_general_performance_metrik.meshes = 1;
-        m_general_performance_metrik.vertices = mesh->vertices.size();
-#endif
-
-        // ------ start new ImGui frame ------
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        for (layer* layer : *renderer::m_layer_stack) 
-            layer->on_imgui_render();
-
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        m_reprojection_cache.end_frame();
+        if (collect_stats)
+            m_traversal_statistics.end_frame();
+        else
+            m_traversal_statistics.skip_frame();
+
+        m_GPU_timer.end_zone(GPU_zone::trace);
+
+        // ------ scale the traced image to the window, measured apart from the trace ------
+        m_GPU_timer.begin_zone(GPU_zone::upscale);
+        m_upscaler.draw(m_reprojection_cache.get_color(), m_target_extent, traced_extent, m_window_extent, m_settings.upscale);
+        m_GPU_timer.end_zone(GPU_zone::upscale);
+
+        // ------ performance stuff, the GPU counters come from a frame a few frames back and never stall ------
+        m_render_metrik.meshes = 1;
+        m_render_metrik.vertices = mesh.vertices.size();
+        m_render_metrik.mesh_GPU_memory = mesh.get_GPU_memory_size();
+        m_render_metrik.traced_pixels = m_reprojection_cache.get_traced_pixel_count();
+        m_render_metrik.slice_index = slice_index;
+        m_render_metrik.slice_count = slice_count;
+        const u32 pixel_count = traced_extent.x * ((traced_extent.y - slice_index + slice_count - 1) / slice_count);      // scanlines of this slice
+        m_render_metrik.reused_pixels = rasterized_primary ? 0 : pixel_count - math::min(m_render_metrik.traced_pixels, pixel_count);
+        m_render_metrik.set_traversal_stats(collect_stats ? m_traversal_statistics.get_stats() : geometry::traversal_stats{});
+
+        // ------ UI built by the main thread ------
+        m_GPU_timer.begin_zone(GPU_zone::UI);
+        if (ImDrawData* draw_data = packet.UI.get_draw_data())
+            ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+        m_GPU_timer.end_zone(GPU_zone::UI);
+        m_render_metrik.CPU_render_time = std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - render_start).count();
 
         // Swap buffers
+        const auto present_start = std::chrono::steady_clock::now();
+        m_GPU_timer.begin_zone(GPU_zone::present);
         glfwSwapBuffers(m_window->get_window());
+        m_GPU_timer.end_zone(GPU_zone::present);
+        m_GPU_timer.end_frame();
+        m_render_metrik.CPU_present_time = std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - present_start).count();
+
+        // ------ results for the main thread ------
+        packet.metrik = m_render_metrik;
+        packet.shader_reload = m_render_shader_reload;
+        packet.traversal_stats_failed = m_traversal_stats_failed;
     }
+
+
+    void GL_renderer::set_context_current(const bool current) { glfwMakeContextCurrent(current ? m_window->get_window() : nullptr); }
     
 
-    bool GL_renderer::compile_shader(GLuint& shader_handle, GLenum type, const char* source, std::string& output) {
+    void GL_renderer::set_size(const u32 width, const u32 height) { enqueue([this, width, height] { resize(width, height); }); }
 
-        shader_handle = glCreateShader(type);
-        glShaderSource(shader_handle, 1, &source, nullptr);
-        glCompileShader(shader_handle);
-        
-        GLint success;
-        glGetShaderiv(shader_handle, GL_COMPILE_STATUS, &success);
-        if(!success) {
-            char compiler_log[1024];
-            glGetShaderInfoLog(shader_handle, 1024, nullptr, compiler_log);
-            LOG(Error, "Shader compilation failed: " << compiler_log);
-            output = compiler_log;
-            return false;
-        }
-        return true;
+
+    void GL_renderer::resize(const u32 width, const u32 height) {
+
+        // the targets follow in the next render_frame(), sized for the render extent of that frame
+        m_window_extent = glm::uvec2(math::max(width, 1u), math::max(height, 1u));
+        m_target_extent = glm::uvec2(0);
+        glViewport(0, 0, m_window_extent.x, m_window_extent.y);
     }
-        
 
-    void GL_renderer::set_size(const u32 width, const u32 height) { glViewport(0, 0, width, height); }
+
+    void GL_renderer::resize_targets(const glm::uvec2 render_extent) {
+
+        // targets only grow until the next window resize, dynamic resolution moving the render extent below them never reallocates
+        const glm::uvec2 extent = glm::max(m_target_extent, glm::max(m_window_extent, render_extent));
+        if (extent == m_target_extent)
+            return;
+
+        m_target_extent = extent;
+        m_reprojection_cache.resize(extent.x, extent.y);
+        m_traversal_statistics.resize(extent.x, extent.y);
+        m_g_buffer.resize(extent.x, extent.y);
+    }
     
 
     bool GL_renderer::reload_fragment_shader(const std::filesystem::path& frag_file, std::string& output) {
 
-        // Read new fragment shader source
-        std::string frag_src = io::read_file(frag_file.string());
-        VALIDATE(!frag_src.empty(), output = "Could not find the file [" + frag_file.generic_string() + "]"; return false, "", "Failed to read frag shader: " << frag_file.generic_string() );
-
-        // Read vertex shader again (to use same entry point)
-        std::string vert_src = io::read_file("shaders/fullscreen_quad.vert");
-        VALIDATE(!vert_src.empty(), output = "Could not read the file [" + frag_file.generic_string() + "]"; return false, "", "Failed to re-read vert shader");
-
-        GLuint vertShader{}, fragShader{};
-        VALIDATE(compile_shader(vertShader, GL_VERTEX_SHADER, vert_src.c_str(), output), return false, "", "Failed to compile vertex shader: " << output);
-        VALIDATE(compile_shader(fragShader, GL_FRAGMENT_SHADER, frag_src.c_str(), output), return false, "", "Failed to compile fragment shader: " << output);
-
-        GLuint newProgram = glCreateProgram();
-        glAttachShader(newProgram, vertShader);
-        glAttachShader(newProgram, fragShader);
-        glLinkProgram(newProgram);
-
-        // Check link status
-        GLint success;
-        glGetProgramiv(newProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            char compiler_log[1024];
-            glGetProgramInfoLog(newProgram, 1024, nullptr, compiler_log);
-            LOG(Error, "Shader relink failed: " << compiler_log);
-            // Cleanup
-            glDeleteShader(vertShader);
-            glDeleteShader(fragShader);
-            glDeleteProgram(newProgram);
-            output = compiler_log;
+        // always built from the files on disk, switching back to a shader used before is fast because of the program cache.
+        // A reload that is still compiling is replaced, its program is deleted when it arrives
+        const std::filesystem::path file = std::filesystem::weakly_canonical(frag_file);
+        tracer_permutation permutation = build_permutation(file, get_tracer_features(), output);
+        m_render_shader_reload.file = file;
+        m_render_shader_reload.pending = (permutation.job != 0);
+        m_render_shader_reload.succeeded = m_render_shader_reload.pending;
+        m_render_shader_reload.output = output;
+        if (!m_render_shader_reload.pending)
             return false;
-        }
 
-        // If successful, swap programs
-        glDeleteProgram(m_shader_program);
-        m_shader_program = newProgram;
-
-        // Cleanup shaders (they can be deleted after linking)
-        glDeleteShader(vertShader);
-        glDeleteShader(fragShader);
-
-        LOG(Info, "Shader program reloaded from " << frag_file);
+        // the current program keeps rendering until this one has linked (see poll_shader_compiler())
+        m_pending_reload = std::move(permutation);
         return true;
     }
 
 
-    void GL_renderer::upload_static_mesh(ref<GLT::geometry::static_mesh> mesh) {
+    bool GL_renderer::export_traversal_heatmap(const std::filesystem::path& file) {
 
-        f32 VBH_generation_time = 0.f;
-        util::stopwatch VBH_generation_time_stopwatch = util::stopwatch(&VBH_generation_time, duration_precision::microseconds);
-        mesh->build_BVH(16);
-        VBH_generation_time_stopwatch.stop();
-        LOG(Debug, "BVH_generation_time [" << VBH_generation_time << "]")
-        
-        mesh->vertex_buffer.create(mesh->vertices.data(), mesh->vertices.size() * sizeof(GLT::geometry::vertex));
-        mesh->index_buffer.create(mesh->indices.data(), mesh->indices.size() * sizeof(u32));
+        VALIDATE((m_active_features & TRACER_TRAVERSAL_STATS), return false, "", "Traversal statistics are not enabled, no heatmap to export");
 
-        // Create buffers if they don't exist
-        if(mesh->vertex_buffer.get_ID() == 0)
-            mesh->vertex_buffer.create(mesh->vertices.data(), mesh->vertices.size() * sizeof(GLT::geometry::vertex));
-        
-        if(mesh->index_buffer.get_ID() == 0)
-            mesh->index_buffer.create(mesh->indices.data(), mesh->indices.size() * sizeof(u32));
+        traversal_heatmap heatmap{};
+        m_traversal_statistics.read_heatmap(heatmap);
+        VALIDATE(io::create_directory(file.parent_path()), return false, "", "Could not create directory [" << file.parent_path().generic_string() << "]");
+        VALIDATE(io::write_image(file, heatmap.to_image(m_settings.traversal_stats.heatmap_max), io::image_format_from_string(file.extension().string().substr(1))), return false, "", "Failed to write heatmap [" << file.generic_string() << "]");
 
-        // Create VAO
-        if(mesh->vao == 0)
-            glGenVertexArrays(1, &mesh->vao);
-        
-        glBindVertexArray(mesh->vao);
-        
-        // Bind buffers
-        mesh->vertex_buffer.bind();
-        mesh->index_buffer.bind();
+        LOG(Info, "Traversal heatmap [" << heatmap.width << "x" << heatmap.height << "] max pixel cost [" << heatmap.get_max_cost() << "] written to [" << file.generic_string() << "]");
+        return true;
+    }
 
-        // Vertex attributes
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLT::geometry::vertex), (void*)offsetof(GLT::geometry::vertex, position));
-        
-        // Normal attribute - now at offset 16 (position(12) + uv_x(4))
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GLT::geometry::vertex), (void*)offsetof(GLT::geometry::vertex, normal));
-        
-        // UV attributes - split into two separate floats
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(GLT::geometry::vertex), (void*)offsetof(GLT::geometry::vertex, uv_x));
-        
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(GLT::geometry::vertex), (void*)offsetof(GLT::geometry::vertex, uv_y));
-
-        // Create SSBOs for ray tracing
-        if (mesh->vertex_ssbo == 0) {
-            glGenBuffers(1, &mesh->vertex_ssbo);
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh->vertex_ssbo);
-            glBufferData(GL_SHADER_STORAGE_BUFFER, mesh->vertices.size() * sizeof(GLT::geometry::vertex), mesh->vertices.data(), GL_STATIC_DRAW);
-        }
 
-        if (mesh->index_ssbo == 0) {
-            glGenBuffers(1, &mesh->index_ssbo);
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh->index_ssbo);
-            glBufferData(GL_SHADER_STORAGE_BUFFER, mesh->indices.size() * sizeof(u32), mesh->indices.data(), GL_STATIC_DRAW);
-        }
+    void GL_renderer::upload_static_mesh(ref<GLT::geometry::static_mesh> mesh) {
 
-        // Add BVH buffers
-        if (mesh->bvh_ssbo == 0) {
-            glGenBuffers(1, &mesh->bvh_ssbo);
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh->bvh_ssbo);
-            glBufferData(GL_SHADER_STORAGE_BUFFER, mesh->BVH_nodes.size() * sizeof(GLT::geometry::BVH_node), mesh->BVH_nodes.data(), GL_STATIC_DRAW);
-        }
+        wait_idle();                                        // an upload of the last contents may still read the mesh
+        if (mesh->BVH_nodes.empty()) {                      // meshes from factory::geometry::load_mesh() come with their BVH
 
-        if (mesh->triidx_ssbo == 0) {
-            glGenBuffers(1, &mesh->triidx_ssbo);
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh->triidx_ssbo);
-            glBufferData(GL_SHADER_STORAGE_BUFFER, mesh->triIdx.size() * sizeof(u32), mesh->triIdx.data(), GL_STATIC_DRAW);
+            f32 VBH_generation_time = 0.f;
+            util::stopwatch VBH_generation_time_stopwatch = util::stopwatch(&VBH_generation_time, duration_precision::microseconds);
+            mesh->build_BVH(16);
+            VBH_generation_time_stopwatch.stop();
+            LOG(Debug, "BVH_generation_time [" << VBH_generation_time << "]")
         }
 
-        glBindVertexArray(0);
+        enqueue([this, mesh] {
+
+            m_reprojection_cache.invalidate();
+
+            // ranges of the shared buffers of the mesh pool, the vertex and index buffer are bound as SSBOs for the ray tracer as well
+            f32 upload_time = 0.f;
+            util::stopwatch upload_stopwatch = util::stopwatch(&upload_time, duration_precision::microseconds);
+            m_mesh_pool.add(*mesh);
+            upload_stopwatch.stop();
+            LOG(Debug, "Uploaded mesh GPU memory [" << mesh->get_GPU_memory_size() / 1024 << " KiB] in [" << upload_time / 1000.f << " ms], mesh pool [" << m_mesh_pool.get_mesh_count() << " meshes, " << m_mesh_pool.get_GPU_memory_size() / 1024 << " KiB]")
+        });
     }
 
 
     void GL_renderer::remove_static_mesh(ref<GLT::geometry::static_mesh> mesh) {
         
-        // Delete Vertex Array Object
-        if (mesh->vao != 0) {
-            glDeleteVertexArrays(1, &mesh->vao);
-            mesh->vao = 0;
-        }
-
-        // Delete Vertex Buffer
-        if (mesh->vertex_buffer.get_ID() != 0) {
-            GLuint vertex_id = mesh->vertex_buffer.get_ID();
-            glDeleteBuffers(1, &vertex_id);
-            mesh->vertex_buffer.set_ID(0);
-        }
-
-        // Delete Index Buffer
-        if (mesh->index_buffer.get_ID() != 0) {
-            GLuint index_id = mesh->index_buffer.get_ID();
-            glDeleteBuffers(1, &index_id);
-            mesh->index_buffer.set_ID(0);
-        }
-
-#define DELETE_SSBO(var)        if (var != 0) { glDeleteBuffers(1, &var); var = 0; }
-
-        DELETE_SSBO(mesh->vertex_ssbo)
-        DELETE_SSBO(mesh->index_ssbo)
-        DELETE_SSBO(mesh->bvh_ssbo)
-        DELETE_SSBO(mesh->triidx_ssbo)
-
-#undef DELETE_SSBO
+        wait_idle();
+        enqueue([this, mesh] {
 
+            m_reprojection_cache.invalidate();
+            m_mesh_pool.remove(*mesh);
+        });
     }
 
 
@@ -370,41 +402,200 @@ namespace GLT::render::open_GL {
 
     void GL_renderer::imgui_create_fonts() {
         
-        ImGui_ImplOpenGL3_CreateFontsTexture();
+        // font texture and the other objects of the backend, ImGui_ImplOpenGL3_NewFrame() is never called (it would create them on first use)
+        ImGui_ImplOpenGL3_CreateDeviceObjects();
     }
 
 
     void GL_renderer::create_shader_program() {
     
-        std::string vert_content = io::read_file("shaders/fullscreen_quad.vert");
-        ASSERT(!vert_content.empty(), "", "Failed to read vert shader");
-    
-        std::string frag_content = io::read_file("shaders/ray_tracer_intor.frag");
-        ASSERT(!frag_content.empty(), "", "Failed to read frag shader");
-    
-        std::string shader_comp_output{};
-        GLuint vertexShader{}, fragmentShader{};
-        VALIDATE(compile_shader(vertexShader, GL_VERTEX_SHADER, vert_content.data(), shader_comp_output), return, "", "Failed to compile shader: " << shader_comp_output);
-        VALIDATE(compile_shader(fragmentShader, GL_FRAGMENT_SHADER, frag_content.data(), shader_comp_output), return, "", "Failed to compile shader: " << shader_comp_output);
-    
-        m_shader_program = glCreateProgram();
-        glAttachShader(m_shader_program, vertexShader);
-        glAttachShader(m_shader_program, fragmentShader);
-        glLinkProgram(m_shader_program);
-    
-        GLint success;
-        glGetProgramiv(m_shader_program, GL_LINK_STATUS, &success);
-        if(!success) {
-            char compiler_log[1024];
-            glGetProgramInfoLog(m_shader_program, 1024, nullptr, compiler_log);
-            LOG(Error, "Shader program linking failed: " << compiler_log);
+        // the vertex stage is the same for every tracer program, the compiler keeps it compiled
+        std::string vertex_source = io::read_file("shaders/fullscreen_quad.vert");
+        ASSERT(!vertex_source.empty(), "", "Failed to read vert shader");
+        m_shader_compiler.create(m_window->get_window(), util::get_executable_path().parent_path() / "shader_cache", std::move(vertex_source));
+
+        // the first frame already needs a program, only this one is waited for
+        m_fragment_file = std::filesystem::weakly_canonical("shaders/ray_tracer_intor.frag");
+        get_permutation(get_tracer_features());
+        m_shader_compiler.finish();
+        poll_shader_compiler();
+        VALIDATE(get_permutation(get_tracer_features()).program.ID != 0, return, "", "Failed to build the ray tracer program from [" << m_fragment_file.generic_string() << "]");
+    }
+
+
+    void GL_renderer::poll_shader_compiler() {
+
+        std::vector<shader_compiler::result> finished{};
+        m_shader_compiler.poll(finished);
+        for (shader_compiler::result& result : finished) {
+
+            if (result.job == m_pending_reload.job) {
+                finish_reload(result);
+                continue;
+            }
+
+            const auto permutation = std::find_if(m_permutations.begin(), m_permutations.end(), [&result](const auto& permutation) { return permutation.second.job == result.job; });
+            if (permutation != m_permutations.end())
+                apply_compile_result(permutation->second, result);
+            else if (result.program != 0)
+                glDeleteProgram(result.program);            // replaced while it was compiling
         }
-    
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+    }
+
+
+    bool GL_renderer::apply_compile_result(tracer_permutation& permutation, const shader_compiler::result& result) {
+
+        permutation.job = 0;
+        permutation.program.ID = result.program;
+        if (result.program == 0) {
+            LOG(Error, "Failed to build permutation [" << permutation.program.features << "] of [" << permutation.files.front().generic_string() << "]: " << result.output << "\nsource strings:\n" << permutation.file_legend)
+            return false;
+        }
+
+        get_uniform_locations(permutation.program);
+        LOG(Debug, "Tracer program " << (result.from_cache ? "loaded from the program cache" : "compiled") << " in [" << result.time << " ms]")
+        return true;
+    }
+
+
+    void GL_renderer::finish_reload(const shader_compiler::result& result) {
+
+        tracer_permutation permutation = std::move(m_pending_reload);
+        m_pending_reload = {};
+        m_render_shader_reload.pending = false;
+        m_render_shader_reload.succeeded = apply_compile_result(permutation, result);
+        if (!m_render_shader_reload.succeeded) {
+            m_render_shader_reload.output = result.output + "\nsource strings:\n" + permutation.file_legend;
+            return;
+        }
+
+        // swap programs, the other permutations are rebuilt from the new sources when they are needed again
+        clear_permutations();
+        m_traversal_stats_failed = false;
+        m_active_features = permutation.program.features;
+        m_permutations[m_active_features] = std::move(permutation);
+        m_fragment_file = m_render_shader_reload.file;
+        m_reprojection_cache.invalidate();                  // new shader may shade or write hits differently
+        LOG(Info, "Shader program reloaded from " << m_fragment_file << " in [" << result.time << " ms]");
+    }
+
+
+    void GL_renderer::get_uniform_locations(tracer_program& program) {
+
+        // per draw uniforms, everything else is in the frame uniform block
+        program.mesh_offsets = glGetUniformLocation(program.ID, "u_mesh_offsets");
+        program.bvh_viz_bounds_depth = glGetUniformLocation(program.ID, "u_bvh_viz_bounds_depth");
+        program.bvh_viz_triangle_depth = glGetUniformLocation(program.ID, "u_bvh_viz_triangle_depth");
+        program.bvh_viz_color = glGetUniformLocation(program.ID, "u_bvh_viz_color");
+        program.show_heatmap = glGetUniformLocation(program.ID, "u_show_heatmap");
+        program.heatmap_max = glGetUniformLocation(program.ID, "u_heatmap_max");
+        program.time = glGetUniformLocation(program.ID, "u_time");
+        program.resolution = glGetUniformLocation(program.ID, "u_resolution");
+        program.mouse = glGetUniformLocation(program.ID, "u_mouse");
+    }
+
+
+    void GL_renderer::delete_tracer_program(tracer_program& program) {
+
+        if (program.ID != 0) {
+            state_cache::forget_program(program.ID);
+            glDeleteProgram(program.ID);
+        }
+        program = {};
+    }
+
+
+    GL_renderer::tracer_permutation GL_renderer::build_permutation(const std::filesystem::path& frag_file, const u32 features, std::string& output) {
+
+        shader_defines defines{};
+        defines["COLLECT_TRAVERSAL_STATS"] = (features & TRACER_TRAVERSAL_STATS) ? "1" : "0";
+        defines["ANY_HIT_SHADOWS"] = (features & TRACER_ANY_HIT_SHADOWS) ? "1" : "0";
+
+        tracer_permutation permutation{};
+        preprocessed_shader shader{};
+        const bool preprocessed = preprocess_shader(frag_file, defines, shader, output);
+        permutation.files = std::move(shader.files);            // also on failure, fixing a broken include rebuilds the shader
+        if (!preprocessed)
+            return permutation;
+
+        permutation.program.features = features;
+        permutation.file_legend = shader.get_file_legend();
+        permutation.job = m_shader_compiler.submit(std::move(shader.source));
+        return permutation;
+    }
+
+
+    const GL_renderer::tracer_permutation& GL_renderer::get_permutation(const u32 features) {
+
+        auto permutation = m_permutations.find(features);
+        if (permutation == m_permutations.end()) {
+
+            std::string output{};
+            permutation = m_permutations.emplace(features, build_permutation(m_fragment_file, features, output)).first;
+            if (permutation->second.job == 0)
+                LOG(Error, "Failed to build permutation [" << features << "] of [" << m_fragment_file.generic_string() << "]: " << output)
+        }
+        return permutation->second;
+    }
+
+
+    void GL_renderer::clear_permutations() {
+
+        for (auto& [features, permutation] : m_permutations)
+            delete_tracer_program(permutation.program);         // jobs still compiling are deleted when they arrive
+        m_permutations.clear();
+    }
+
+
+    u32 GL_renderer::get_tracer_features() const {
+
+        u32 features = 0;
+        if (m_settings.traversal_stats.enabled && !m_traversal_stats_failed)
+            features |= TRACER_TRAVERSAL_STATS;
+        if (m_settings.soft_shadows.any_hit)
+            features |= TRACER_ANY_HIT_SHADOWS;
+        return features;
+    }
+
+
+    const GL_renderer::tracer_program& GL_renderer::get_active_program() {
+
+        const u32 features = get_tracer_features();
+        const tracer_permutation* wanted = &get_permutation(features);
+        if (wanted->job == 0 && wanted->program.ID == 0 && (features & TRACER_TRAVERSAL_STATS)) {
+
+            LOG(Warn, "Failed to build the traversal statistics permutation, statistics disabled")
+            m_traversal_stats_failed = true;
+            wanted = &get_permutation(get_tracer_features());
+        }
+
+        if (wanted->program.ID != 0) {
+            if (wanted->program.features != m_active_features)
+                m_reprojection_cache.invalidate();          // cached hits may come from a shader tracing differently
+            m_active_features = wanted->program.features;
+            return wanted->program;
+        }
+
+        // still compiling (or failed), the last program keeps rendering
+        const auto active = m_permutations.find(m_active_features);
+        return (active != m_permutations.end()) ? active->second.program : wanted->program;
     }
     
 
+    void GL_renderer::create_blue_noise_texture() {
+
+        const auto& tile = math::sampling::get_blue_noise_tile();
+        glGenTextures(1, &m_blue_noise_texture);
+        glBindTexture(GL_TEXTURE_2D, m_blue_noise_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, math::sampling::BLUE_NOISE_TILE_SIZE, math::sampling::BLUE_NOISE_TILE_SIZE, 0, GL_RED, GL_FLOAT, tile.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+
     void GL_renderer::create_fullscreen_quad() {
         
         float vertices[] = {
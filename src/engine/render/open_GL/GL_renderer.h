@@ -1,6 +1,15 @@
 #pragma once
 
 #include "engine/render/renderer.h"
+#include "reprojection_cache.h"
+#include "traversal_statistics.h"
+#include "g_buffer.h"
+#include "upscaler.h"
+#include "mesh_pool.h"
+#include "GPU_timer.h"
+#include "shader_preprocessor.h"
+#include "shader_compiler.h"
+#include "program_cache.h"
 
 namespace GLT {
 
@@ -12,34 +21,124 @@ namespace GLT::render::open_GL {
 
     typedef unsigned int	GLuint;
     typedef unsigned int    GLenum;
+    typedef int             GLint;
 
     class GL_renderer : public GLT::render::renderer{
     public:
         GL_renderer(ref<window> window, ref<layer_stack> layer_stack);
         ~GL_renderer();
     
-        void draw_frame(float delta_time);
-        void set_size(const u32 width, const u32 height);
+        void set_size(const u32 width, const u32 height) override;
 
         void upload_static_mesh(ref<GLT::geometry::static_mesh> mesh) override;
         void remove_static_mesh(ref<GLT::geometry::static_mesh> mesh) override;
         bool reload_fragment_shader(const std::filesystem::path& frag_file, std::string& output) override;
+        bool export_traversal_heatmap(const std::filesystem::path& file) override;
 
         // -------- ImGui --------
         void imgui_init();
         void imgui_shutdown();
         void imgui_create_fonts();
 
+    protected:
+
+        void build_frame(frame_packet& packet) override;
+        void render_frame(frame_packet& packet) override;
+        void set_context_current(const bool current) override;
+
     private:
-        GLuint                              m_shader_program;
+
+        static constexpr u32                FRAME_UNIFORM_BINDING = 0;
+
+        // std140 twin of [frame_block] in the ray tracer shader, written once per frame
+        struct frame_uniforms {
+            glm::mat4                       inv_proj;
+            glm::mat4                       inv_view;
+            glm::vec3                       cam_pos;
+            f32                             time;
+            glm::vec2                       resolution;
+            glm::vec2                       mouse;
+            int32                           reuse_enabled;
+            int32                           refresh_period;
+            int32                           frame_index;
+            int32                           slice_count;
+            int32                           slice_index;
+            f32                             light_radius;
+            int32                           shadow_samples;
+            int32                           sample_pattern;
+            int32                           rasterized_primary;
+            int32                           padding[3];
+        };
+        static_assert(sizeof(frame_uniforms) == 208 && offsetof(frame_uniforms, resolution) == 144 && offsetof(frame_uniforms, rasterized_primary) == 192, "layout differs from std140 [frame_block]");
+
+        // compile time features of the ray tracer, every combination is its own program (permutation) built on first use
+        enum tracer_feature : u32 {
+            TRACER_TRAVERSAL_STATS = BIT(0),                            // COLLECT_TRAVERSAL_STATS
+            TRACER_ANY_HIT_SHADOWS = BIT(1),                            // ANY_HIT_SHADOWS
+        };
+
+        // ray tracer program and the locations of its per draw uniforms, looked up once per link
+        struct tracer_program {
+            GLuint                          ID = 0;
+            u32                             features = 0;               // tracer_feature bits
+            GLint                           mesh_offsets = -1;
+            GLint                           bvh_viz_bounds_depth = -1;
+            GLint                           bvh_viz_triangle_depth = -1;
+            GLint                           bvh_viz_color = -1;
+            GLint                           show_heatmap = -1;
+            GLint                           heatmap_max = -1;
+            GLint                           time = -1;                  // plain uniforms of shaders without [frame_block] (shaders/external)
+            GLint                           resolution = -1;
+            GLint                           mouse = -1;
+        };
+
+        struct tracer_permutation {
+            tracer_program                  program{};                  // ID 0 while compiling or if building failed, not retried until the sources change
+            std::vector<std::filesystem::path> files{};                 // the fragment shader and its includes
+            std::string                     file_legend{};              // source string numbers of compiler messages
+            u64                             job = 0;                    // shader_compiler job while compiling
+        };
+
+        std::unordered_map<u32, tracer_permutation> m_permutations{};      // permutations of [m_fragment_file] by tracer_feature bits
+        std::filesystem::path               m_fragment_file{};
+        u32                                 m_active_features = 0;
+        render::buffer                      m_frame_uniforms{ render::buffer::type::UNIFORM, render::buffer::usage::STREAM };
+        tracer_permutation                  m_pending_reload{};             // replaces [m_permutations] once it linked, see [m_shader_reload]
+        shader_compiler                     m_shader_compiler{};
+        program_cache                       m_pass_program_cache{};         // programs of the render passes, the compiler thread uses its own cache
         GLuint                              m_vao;
         GLuint                              m_vbo;
-        glm::vec2                           mouse_pos{};
-        GLuint                              m_total_render_time{};
+        GPU_timer                           m_GPU_timer{};
+        reprojection_cache                  m_reprojection_cache{};
+        GLuint                              m_blue_noise_texture = 0;
+        traversal_statistics                m_traversal_statistics{};
+        g_buffer                            m_g_buffer{};
+        mesh_pool                           m_mesh_pool{};
+        upscaler                            m_upscaler{};
+        glm::uvec2                          m_window_extent{1};
+        glm::uvec2                          m_target_extent{0};             // of the offscreen targets, 0 => follow the next frame
+
+        // render thread copies, the main thread gets them through the frame packet
+        frame_settings                      m_settings{};                   // of the frame being drawn
+        general_performance_metrik          m_render_metrik{};
+        shader_reload_status                m_render_shader_reload{};
+        bool                                m_traversal_stats_failed = false;   // instrumented program of [m_fragment_file] could not be built
         
+        void resize(const u32 width, const u32 height);
+        void resize_targets(const glm::uvec2 render_extent);
         void create_shader_program();
+        void poll_shader_compiler();
+        bool apply_compile_result(tracer_permutation& permutation, const shader_compiler::result& result);
+        void finish_reload(const shader_compiler::result& result);
+        void get_uniform_locations(tracer_program& program);
+        void delete_tracer_program(tracer_program& program);
+        tracer_permutation build_permutation(const std::filesystem::path& frag_file, const u32 features, std::string& output);
+        const tracer_permutation& get_permutation(const u32 features);
+        void clear_permutations();
+        u32 get_tracer_features() const;
+        const tracer_program& get_active_program();
         void create_fullscreen_quad();
-        bool compile_shader(GLuint& shader_handle, GLenum type, const char* source, std::string& output);
+        void create_blue_noise_texture();
         
         void init_file_watcher();
         void auto_reload_file(const std::filesystem::path& file);
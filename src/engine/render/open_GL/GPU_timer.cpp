@@ -0,0 +1,131 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "GPU_timer.h"
+
+
+namespace GLT::render::open_GL {
+
+    GPU_timer::~GPU_timer() { destroy(); }
+
+
+    void GPU_timer::create() {
+
+        destroy();
+        for (frame_slot& slot : m_slots)
+            glGenQueries(ZONE_COUNT * 2, slot.queries);
+        m_created = true;
+    }
+
+
+    void GPU_timer::destroy() {
+
+        if (!m_created)
+            return;
+
+        for (frame_slot& slot : m_slots) {
+            glDeleteQueries(ZONE_COUNT * 2, slot.queries);
+            slot = {};
+        }
+        m_latest = {};
+        m_recording = false;
+        m_created = false;
+    }
+
+
+    void GPU_timer::begin_frame() {
+
+        if (!m_created)
+            return;
+
+        // oldest first, so [m_latest] ends up with the newest finished frame
+        for (u32 x = 1; x <= FRAMES_IN_FLIGHT; x++) {
+            frame_slot& slot = m_slots[(m_frame_count + x) % FRAMES_IN_FLIGHT];
+            if (slot.pending)
+                collect(slot);
+        }
+
+        frame_slot& slot = m_slots[m_frame_count % FRAMES_IN_FLIGHT];
+        m_recording = !slot.pending;
+        if (!m_recording) {
+            m_skipped_frames++;
+            return;
+        }
+        slot.zone_mask = 0;
+        slot.frame = m_frame_count;
+    }
+
+
+    void GPU_timer::end_frame() {
+
+        if (m_recording)
+            m_slots[m_frame_count % FRAMES_IN_FLIGHT].pending = true;
+        m_recording = false;
+        m_frame_count++;
+    }
+
+
+    void GPU_timer::begin_zone(const GPU_zone zone) {
+
+        if (m_recording)
+            glQueryCounter(m_slots[m_frame_count % FRAMES_IN_FLIGHT].queries[static_cast<u32>(zone) * 2], GL_TIMESTAMP);
+    }
+
+
+    void GPU_timer::end_zone(const GPU_zone zone) {
+
+        if (!m_recording)
+            return;
+
+        frame_slot& slot = m_slots[m_frame_count % FRAMES_IN_FLIGHT];
+        glQueryCounter(slot.queries[static_cast<u32>(zone) * 2 + 1], GL_TIMESTAMP);
+        slot.zone_mask |= 1u << static_cast<u32>(zone);
+    }
+
+
+    const char* GPU_timer::get_zone_name(const GPU_zone zone) {
+
+        switch (zone) {
+            case GPU_zone::trace:   return "trace";
+            case GPU_zone::upscale: return "upscale";
+            case GPU_zone::UI:      return "UI";
+            case GPU_zone::present: return "present";
+            default:                return "unknown";
+        }
+    }
+
+
+    bool GPU_timer::collect(frame_slot& slot) {
+
+        for (u32 zone = 0; zone < ZONE_COUNT; zone++) {
+
+            if (!(slot.zone_mask & (1u << zone)))
+                continue;
+
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[zone * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                return false;
+        }
+
+        frame_times times{};
+        times.frame = slot.frame;
+        for (u32 zone = 0; zone < ZONE_COUNT; zone++) {
+
+            if (!(slot.zone_mask & (1u << zone)))
+                continue;
+
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(slot.queries[zone * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(slot.queries[zone * 2 + 1], GL_QUERY_RESULT, &end);
+            times.zone[zone] = (end > begin) ? static_cast<f32>(end - begin) / 1e6f : 0.f;
+        }
+
+        slot.pending = false;
+        if (times.frame >= m_latest.frame)
+            m_latest = times;
+        return true;
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief Named parts of a frame measured on the GPU
+    enum class GPU_zone : u8 { trace, upscale, UI, present, count };
+
+    // @brief GPU time of frame zones without stalling the CPU. Every zone is a pair of timestamp queries, the queries of a frame go into
+    //        one of FRAMES_IN_FLIGHT slots and are only read once the GPU made them available, a few frames later.
+    //        If the slot of a new frame is still not available that frame is not measured (get_skipped_frames()) instead of waiting.
+    //        Zones may overlap and nest, a zone can be measured once per frame.
+    class GPU_timer {
+    public:
+
+        static constexpr u32 FRAMES_IN_FLIGHT = 4;
+        static constexpr u32 ZONE_COUNT = static_cast<u32>(GPU_zone::count);
+
+        struct frame_times {
+            u64                             frame = 0;                  // index of the frame the times belong to
+            f32                             zone[ZONE_COUNT] = {};      // in ms, 0 for zones not measured in that frame
+        };
+
+        GPU_timer() = default;
+        ~GPU_timer();
+
+        DELETE_COPY_CONSTRUCTOR(GPU_timer);
+
+        // @brief Requires a current GL context
+        void create();
+        void destroy();
+
+        // @brief Collects the frames the GPU finished and starts recording the next one
+        void begin_frame();
+        void end_frame();
+
+        void begin_zone(const GPU_zone zone);
+        void end_zone(const GPU_zone zone);
+
+        // @brief Times of the newest finished frame, usually FRAMES_IN_FLIGHT - 1 frames old
+        DEFAULT_GETTER_C(frame_times,                       latest)
+        DEFAULT_GETTER_C(u64,                               skipped_frames)
+
+        static const char* get_zone_name(const GPU_zone zone);
+
+    private:
+
+        struct frame_slot {
+            GLuint                          queries[ZONE_COUNT * 2] = {};   // begin and end timestamp of every zone
+            u32                             zone_mask = 0;              // zones recorded in this frame
+            u64                             frame = 0;
+            bool                            pending = false;
+        };
+
+        // @brief Reads the queries of [slot] if the GPU made all of them available
+        bool collect(frame_slot& slot);
+
+        frame_slot                          m_slots[FRAMES_IN_FLIGHT]{};
+        frame_times                         m_latest{};
+        u64                                 m_frame_count = 0;
+        u64                                 m_skipped_frames = 0;
+        bool                                m_recording = false;
+        bool                                m_created = false;
+    };
+
+}
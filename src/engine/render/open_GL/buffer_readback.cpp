@@ -0,0 +1,100 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "buffer_readback.h"
+
+
+namespace GLT::render::open_GL {
+
+    buffer_readback::~buffer_readback() { destroy(); }
+
+
+    void buffer_readback::create(const u32 size) {
+
+        destroy();
+        m_size = size;
+        m_latest.resize(size);
+        for (staging_slot& slot : m_slots) {
+
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+
+    void buffer_readback::destroy() {
+
+        clear();
+        for (staging_slot& slot : m_slots) {
+            if (slot.buffer != 0)
+                glDeleteBuffers(1, &slot.buffer);
+            slot = {};
+        }
+        m_size = 0;
+    }
+
+
+    void buffer_readback::capture(const GLuint source) {
+
+        if (m_size == 0)
+            return;
+
+        // oldest first, so [m_latest] ends up with the newest finished capture
+        for (u32 x = 1; x <= FRAMES_IN_FLIGHT; x++)
+            collect(m_slots[(m_capture_count + x) % FRAMES_IN_FLIGHT]);
+
+        staging_slot& slot = m_slots[m_capture_count % FRAMES_IN_FLIGHT];
+        if (slot.fence) {
+            m_skipped_captures++;
+            return;
+        }
+
+        glMemoryBarrier(GL_ATOMIC_COUNTER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);      // shader writes (atomic counters, SSBOs) before the copy reads them
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.capture = m_capture_count++;
+    }
+
+
+    void buffer_readback::clear() {
+
+        for (staging_slot& slot : m_slots) {
+            if (slot.fence) {
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+            }
+        }
+        m_has_latest = false;
+        m_latest_capture = 0;
+    }
+
+
+    void buffer_readback::collect(staging_slot& slot) {
+
+        if (!slot.fence)
+            return;
+
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);                 // timeout 0 only polls
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        if (m_has_latest && slot.capture < m_latest_capture)
+            return;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, slot.buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, m_size, m_latest.data());      // the copy finished, nothing to wait for
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        m_latest_capture = slot.capture;
+        m_has_latest = true;
+    }
+
+}
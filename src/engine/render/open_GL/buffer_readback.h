@@ -0,0 +1,58 @@
+#pragma once
+
+
+typedef struct __GLsync* GLsync;
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief Reads small GPU buffers (counters written by shaders) back without stalling the CPU, the buffer version of [GPU_timer].
+    //        capture() copies the source into one of FRAMES_IN_FLIGHT staging buffers and fences the copy, a staging buffer is only
+    //        read once its fence signaled, a few frames later. If the staging buffer of a new capture is still in flight that capture
+    //        is skipped (get_skipped_captures()) instead of waiting.
+    class buffer_readback {
+    public:
+
+        static constexpr u32 FRAMES_IN_FLIGHT = 4;
+
+        buffer_readback() = default;
+        ~buffer_readback();
+
+        DELETE_COPY_CONSTRUCTOR(buffer_readback);
+
+        // @brief Creates the staging buffers for [size] bytes, requires a current GL context
+        void create(const u32 size);
+        void destroy();
+
+        // @brief Reads the captures the GPU finished, then copies the first [size] bytes of [source] once the shader writes before this call are visible
+        void capture(const GLuint source);
+
+        // @brief Forgets the pending captures and the latest result, e.g. when the source stops being written
+        void clear();
+
+        // @brief Newest finished capture, usually FRAMES_IN_FLIGHT - 1 frames old, nullptr until the first one finished
+        FORCEINLINE const void* get_latest() const                              { return m_has_latest ? m_latest.data() : nullptr; }
+        DEFAULT_GETTER_C(u64,                               skipped_captures)
+
+    private:
+
+        struct staging_slot {
+            GLuint                          buffer = 0;
+            GLsync                          fence = nullptr;            // set while the copy is in flight
+            u64                             capture = 0;
+        };
+
+        // @brief Reads [slot] if its copy finished
+        void collect(staging_slot& slot);
+
+        staging_slot                        m_slots[FRAMES_IN_FLIGHT]{};
+        std::vector<std::byte>              m_latest{};
+        u64                                 m_latest_capture = 0;
+        u64                                 m_capture_count = 0;
+        u64                                 m_skipped_captures = 0;
+        u32                                 m_size = 0;
+        bool                                m_has_latest = false;
+    };
+
+}
@@ -0,0 +1,140 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "geometry/static_mesh.h"
+
+#include "mesh_pool.h"
+#include "shader_program.h"
+#include "state_cache.h"
+#include "g_buffer.h"
+
+
+namespace GLT::render::open_GL {
+
+    constexpr GLuint SURFACE_IMAGE_UNIT = 4;
+    constexpr GLuint TRIANGLE_ID_IMAGE_UNIT = 5;
+
+
+    static GLuint create_texture(const u32 width, const u32 height, const GLenum internal_format) {
+
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+
+    g_buffer::~g_buffer() { destroy(); }
+
+
+    void g_buffer::create(const u32 width, const u32 height, program_cache& cache) {
+
+        m_program = create_program("shaders/g_buffer.glsl", shader_stages::vertex_fragment, cache);
+        m_view_proj_location = glGetUniformLocation(m_program, "u_view_proj");
+        m_cam_pos_location = glGetUniformLocation(m_program, "u_cam_pos");
+        glGenFramebuffers(1, &m_framebuffer);
+        resize(width, height);
+    }
+
+
+    void g_buffer::destroy() {
+
+        destroy_targets();
+        if (m_program != 0) {
+            state_cache::forget_program(m_program);
+            glDeleteProgram(m_program);
+            m_program = 0;
+        }
+        if (m_framebuffer != 0) {
+            glDeleteFramebuffers(1, &m_framebuffer);
+            m_framebuffer = 0;
+        }
+    }
+
+
+    void g_buffer::resize(const u32 width, const u32 height) {
+
+        if (width == m_width && height == m_height && m_surface != 0)
+            return;
+
+        m_width = math::max(width, 1u);
+        m_height = math::max(height, 1u);
+        destroy_targets();
+        create_targets();
+    }
+
+
+    bool g_buffer::render(const mesh_pool& meshes, const geometry::static_mesh& mesh, const frame_camera& camera, const glm::uvec2 render_extent) {
+
+        if (m_program == 0 || !mesh.GPU_range.resident)
+            return false;
+
+        // same projection the camera rays are generated from, so fragment centers and ray directions agree
+        const glm::uvec2 extent = glm::clamp(render_extent, glm::uvec2(1), glm::uvec2(m_width, m_height));
+        const glm::mat4 view_proj = glm::inverse(camera.inv_proj) * glm::inverse(camera.inv_view);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, extent.x, extent.y);
+        const GLfloat clear_surface[] = { 0.f, 0.f, 0.f, 0.f };
+        const GLuint clear_triangle_id[] = { 0, 0, 0, 0 };
+        const GLfloat clear_depth = 1.f;
+        glClearBufferfv(GL_COLOR, 0, clear_surface);
+        glClearBufferuiv(GL_COLOR, 1, clear_triangle_id);
+        glClearBufferfv(GL_DEPTH, 0, &clear_depth);
+
+        // rays see both sides of a triangle, the surface target holds raw values
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDisable(GL_CULL_FACE);
+        glDisable(GL_BLEND);
+
+        state_cache::use_program(m_program);
+        glUniformMatrix4fv(m_view_proj_location, 1, GL_FALSE, glm::value_ptr(view_proj));
+        glUniform3fv(m_cam_pos_location, 1, glm::value_ptr(camera.position));
+        meshes.draw(mesh);
+
+        // restore the state the fullscreen tracer pass expects
+        glEnable(GL_BLEND);
+        glEnable(GL_CULL_FACE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glBindImageTexture(SURFACE_IMAGE_UNIT, m_surface, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(TRIANGLE_ID_IMAGE_UNIT, m_triangle_id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32UI);
+        return true;
+    }
+
+
+    void g_buffer::create_targets() {
+
+        m_depth = create_texture(m_width, m_height, GL_DEPTH_COMPONENT32F);
+        m_surface = create_texture(m_width, m_height, GL_RGBA32F);
+        m_triangle_id = create_texture(m_width, m_height, GL_R32UI);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_surface, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_triangle_id, 0);
+        const GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, draw_buffers);
+        VALIDATE(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, , "", "G-buffer framebuffer incomplete");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+
+    void g_buffer::destroy_targets() {
+
+        for (GLuint* texture : { &m_depth, &m_surface, &m_triangle_id }) {
+            if (*texture != 0) {
+                glDeleteTextures(1, texture);
+                *texture = 0;
+            }
+        }
+    }
+
+}
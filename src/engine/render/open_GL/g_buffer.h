@@ -0,0 +1,54 @@
+#pragma once
+
+#include "reprojection_cache.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::render::open_GL {
+
+    class mesh_pool;
+    class program_cache;
+
+    typedef unsigned int	GLuint;
+    typedef int             GLint;
+
+    // @brief Rasterized primary visibility for the hybrid mode of the fragment ray tracer (see [hybrid_rendering_settings]).
+    //        The mesh is drawn with the camera of the frame into a depth / surface / triangle id target, the tracer reads the
+    //        surface of its pixel from it and only traces the rays of secondary effects (shadows) from there.
+    //        Both stages live in [shaders/g_buffer.glsl], selected by defining VERTEX_STAGE or FRAGMENT_STAGE.
+    //        Bindings used while tracing: image unit 4 (normal.xyz, distance to the camera), image unit 5 (triangle id + 1, 0 => no surface)
+    class g_buffer {
+    public:
+
+        g_buffer() = default;
+        ~g_buffer();
+
+        // @brief Creates the raster program (through [cache]) and all targets, requires a current GL context
+        void create(const u32 width, const u32 height, program_cache& cache);
+        void destroy();
+        // @brief Size of the targets, the render extent of a frame can be anything up to it
+        void resize(const u32 width, const u32 height);
+
+        // @brief Rasterizes [mesh] (resident in [meshes]) into the targets and binds them for the ray tracer, leaves framebuffer 0 bound
+        // @param render_extent resolution the ray tracer renders at, clamped to the target size
+        // @return false if the raster program is not available, the tracer has to find its primary hits itself
+        bool render(const mesh_pool& meshes, const geometry::static_mesh& mesh, const frame_camera& camera, const glm::uvec2 render_extent);
+
+    private:
+
+        GLuint                              m_program = 0;
+        GLint                               m_view_proj_location = -1;
+        GLint                               m_cam_pos_location = -1;
+        GLuint                              m_framebuffer = 0;
+        GLuint                              m_depth = 0;
+        GLuint                              m_surface = 0;
+        GLuint                              m_triangle_id = 0;
+        u32                                 m_width = 0;
+        u32                                 m_height = 0;
+
+        void create_targets();
+        void destroy_targets();
+    };
+
+}
@@ -0,0 +1,211 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "geometry/static_mesh.h"
+
+#include "mesh_pool.h"
+
+
+namespace GLT::render::open_GL {
+
+    constexpr u64 SHRINK_DIVISOR = 4;               // compact and shrink a buffer when less than 1/4 of it is used after remove()
+
+    static u32& first_element(geometry::GPU_mesh_range& range, const u32 target) {
+
+        switch (target) {
+            case 0: return range.first_vertex;
+            case 1: return range.first_index;
+            case 2: return range.first_node;
+            default: return range.first_tri;
+        }
+    }
+
+
+    mesh_pool::~mesh_pool() {
+
+        m_meshes.clear();                               // meshes may be gone already at shutdown, only free the GL objects
+        destroy();
+    }
+
+
+    void mesh_pool::create() {
+
+        m_arrays[VERTICES].element_size = sizeof(geometry::vertex);
+        m_arrays[INDICES].element_size = sizeof(u32);
+        m_arrays[BVH_NODES].element_size = sizeof(geometry::BVH_node);
+        m_arrays[TRI_INDICES].element_size = sizeof(u32);
+        glGenVertexArrays(1, &m_vao);
+        setup_vertex_array();
+    }
+
+
+    void mesh_pool::destroy() {
+
+        for (geometry::static_mesh* mesh : m_meshes)
+            mesh->GPU_range = {};
+        m_meshes.clear();
+
+        for (shared_array& shared : m_arrays) {
+            shared.buffer.destroy();
+            shared.allocator = range_allocator{};
+        }
+        if (m_vao)
+            glDeleteVertexArrays(1, &m_vao);
+        m_vao = 0;
+    }
+
+
+    bool mesh_pool::add(geometry::static_mesh& mesh) {
+
+        VALIDATE(m_vao != 0, return false, "", "Mesh pool was not created");
+        VALIDATE(!mesh.vertices.empty() && !mesh.indices.empty() && !mesh.BVH_nodes.empty() && !mesh.triIdx.empty(), return false, "", "Mesh has no geometry or no BVH, nothing to upload");
+
+        if (mesh.GPU_range.resident)
+            remove(mesh);
+
+        const void* data[ARRAY_COUNT] = { mesh.vertices.data(), mesh.indices.data(), mesh.BVH_nodes.data(), mesh.triIdx.data() };
+        const u64 counts[ARRAY_COUNT] = { mesh.vertices.size(), mesh.indices.size(), mesh.BVH_nodes.size(), mesh.triIdx.size() };
+        geometry::GPU_mesh_range range{};
+        for (u32 x = 0; x < ARRAY_COUNT; x++) {
+
+            const u64 offset = allocate(static_cast<array>(x), counts[x]);
+            const u32 element_size = m_arrays[x].element_size;
+            m_arrays[x].buffer.upload(data[x], offset * element_size, counts[x] * element_size);
+            first_element(range, x) = static_cast<u32>(offset);
+        }
+
+        range.resident = true;
+        mesh.GPU_range = range;
+        m_meshes.push_back(&mesh);
+        return true;
+    }
+
+
+    void mesh_pool::remove(geometry::static_mesh& mesh) {
+
+        const auto entry = std::find(m_meshes.begin(), m_meshes.end(), &mesh);
+        if (entry == m_meshes.end())
+            return;
+
+        m_meshes.erase(entry);
+        for (u32 x = 0; x < ARRAY_COUNT; x++) {
+
+            shared_array& shared = m_arrays[x];
+            shared.allocator.free(first_element(mesh.GPU_range, x));
+            if (shared.allocator.get_used() * SHRINK_DIVISOR < shared.allocator.get_capacity())
+                resize(static_cast<array>(x), shared.allocator.get_used() + shared.allocator.get_used() / 2);
+        }
+        mesh.GPU_range = {};
+    }
+
+
+    void mesh_pool::defragment() {
+
+        for (u32 x = 0; x < ARRAY_COUNT; x++)
+            resize(static_cast<array>(x), m_arrays[x].allocator.get_used());
+    }
+
+
+    void mesh_pool::bind_storage() const {
+
+        for (u32 x = 0; x < ARRAY_COUNT; x++)
+            m_arrays[x].buffer.bind_storage(x);
+    }
+
+
+    void mesh_pool::draw(const geometry::static_mesh& mesh) const {
+
+        if (!mesh.GPU_range.resident)
+            return;
+
+        glBindVertexArray(m_vao);
+        const size_t index_offset = static_cast<size_t>(mesh.GPU_range.first_index) * sizeof(u32);
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, reinterpret_cast<const void*>(index_offset), static_cast<GLint>(mesh.GPU_range.first_vertex));
+        glBindVertexArray(0);
+    }
+
+
+    size_t mesh_pool::get_GPU_memory_size() const {
+
+        size_t size = 0;
+        for (const shared_array& shared : m_arrays)
+            size += shared.buffer.get_size();
+        return size;
+    }
+
+
+    f32 mesh_pool::get_fragmentation() const {
+
+        f32 fragmentation = 0.f;
+        for (const shared_array& shared : m_arrays)
+            fragmentation = math::max(fragmentation, shared.allocator.get_fragmentation());
+        return fragmentation;
+    }
+
+
+    u64 mesh_pool::allocate(const array target, const u64 count) {
+
+        range_allocator& allocator = m_arrays[target].allocator;
+        u64 offset = allocator.allocate(count);
+        if (offset != range_allocator::INVALID_OFFSET)
+            return offset;
+
+        // the buffer is copied anyway, compaction comes for free: enough free space in total only needs packing, otherwise it grows
+        const u64 capacity = allocator.get_capacity();
+        const u64 required = allocator.get_used() + count;
+        resize(target, (required <= capacity) ? capacity : math::max(required, capacity * 2));
+        return allocator.allocate(count);
+    }
+
+
+    void mesh_pool::resize(const array target, const u64 new_capacity) {
+
+        shared_array& shared = m_arrays[target];
+        if (new_capacity == shared.allocator.get_capacity() && shared.allocator.get_largest_free_block() + shared.allocator.get_used() == new_capacity)
+            return;                                             // free space is one block already, nothing to gain
+
+        const std::vector<range_allocator::move> moves = shared.allocator.compact(new_capacity);
+        std::vector<buffer::copy_region> regions{};
+        std::unordered_map<u64, u64> new_offsets{};
+        for (const range_allocator::move& move : moves) {
+            regions.push_back({ move.from * shared.element_size, move.to * shared.element_size, move.size * shared.element_size });
+            new_offsets.emplace(move.from, move.to);
+        }
+        shared.buffer.reallocate(new_capacity * shared.element_size, regions);
+
+        for (geometry::static_mesh* mesh : m_meshes) {
+            u32& first = first_element(mesh->GPU_range, target);
+            first = static_cast<u32>(new_offsets.at(first));
+        }
+
+        // the VAO references the buffer objects, which changed
+        if (target == VERTICES || target == INDICES)
+            setup_vertex_array();
+    }
+
+
+    void mesh_pool::setup_vertex_array() {
+
+        glBindVertexArray(m_vao);
+        m_arrays[VERTICES].buffer.bind();
+        m_arrays[INDICES].buffer.bind();
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(geometry::vertex), (void*)offsetof(geometry::vertex, position));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(geometry::vertex), (void*)offsetof(geometry::vertex, normal));
+
+        // UV is split into two separate floats
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(geometry::vertex), (void*)offsetof(geometry::vertex, uv_x));
+
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(geometry::vertex), (void*)offsetof(geometry::vertex, uv_y));
+
+        glBindVertexArray(0);
+        m_arrays[VERTICES].buffer.unbind();
+    }
+
+}
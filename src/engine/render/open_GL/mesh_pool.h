@@ -0,0 +1,77 @@
+#pragma once
+
+#include "engine/render/buffer.h"
+#include "engine/render/range_allocator.h"
+
+namespace GLT::geometry { struct static_mesh; }
+
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief GPU memory of all meshes: one shared buffer per array (vertices, indices, BVH nodes, triIdx), every mesh gets a range of each.
+    //        The arrays of a mesh keep their mesh relative indices, shaders add the first element of the range ([geometry::GPU_mesh_range]),
+    //        so all meshes are traced with one binding set: SSBO 0 (vertices), 1 (indices), 2 (BVH nodes), 3 (triIdx).
+    //        Rasterization uses one shared VAO with glDrawElementsBaseVertex.
+    //        A full buffer grows (GPU copy into a larger buffer), a fragmented one is compacted first and buffers mostly empty after
+    //        remove() are compacted and shrunk. Both move ranges and update the [GPU_range] of every resident mesh.
+    class mesh_pool {
+    public:
+
+        mesh_pool() = default;
+        ~mesh_pool();
+
+        DELETE_COPY_CONSTRUCTOR(mesh_pool);
+
+        // @brief Requires a current GL context
+        void create();
+        void destroy();
+
+        // @brief Uploads all arrays of [mesh] (it has to stay alive until remove()), a resident mesh is replaced
+        bool add(geometry::static_mesh& mesh);
+        void remove(geometry::static_mesh& mesh);
+
+        // @brief Packs all meshes to the front of every buffer without free space between or after them
+        void defragment();
+
+        // @brief Binds the shared buffers to the SSBO bindings 0 - 3
+        void bind_storage() const;
+
+        // @brief Draws the triangles of a resident [mesh] with the shared VAO, the shader sees mesh relative gl_PrimitiveID
+        void draw(const geometry::static_mesh& mesh) const;
+
+        // @brief Bytes of all shared buffers, including free space
+        size_t get_GPU_memory_size() const;
+        // @brief Worst fragmentation of the shared buffers (see range_allocator::get_fragmentation())
+        f32 get_fragmentation() const;
+
+        FORCEINLINE u32 get_mesh_count() const { return static_cast<u32>(m_meshes.size()); }
+
+    private:
+
+        enum array : u8 { VERTICES, INDICES, BVH_NODES, TRI_INDICES, ARRAY_COUNT };
+
+        struct shared_array {
+            render::buffer                  buffer;
+            range_allocator                 allocator{};                // in elements
+            u32                             element_size = 0;
+        };
+
+        // @brief Range of [count] elements in [target], grows or compacts the buffer if needed
+        u64 allocate(const array target, const u64 count);
+        // @brief Moves all ranges of [target] into a new buffer of [new_capacity] elements, packed to the front
+        void resize(const array target, const u64 new_capacity);
+        void setup_vertex_array();
+
+        shared_array                        m_arrays[ARRAY_COUNT] = {
+            { { render::buffer::type::VERTEX, render::buffer::usage::STATIC } },
+            { { render::buffer::type::INDEX, render::buffer::usage::STATIC } },
+            { { render::buffer::type::STORAGE, render::buffer::usage::STATIC } },
+            { { render::buffer::type::STORAGE, render::buffer::usage::STATIC } },
+        };
+        std::vector<geometry::static_mesh*> m_meshes{};
+        GLuint                              m_vao = 0;
+    };
+
+}
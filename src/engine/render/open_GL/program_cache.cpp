@@ -0,0 +1,171 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "util/io/io.h"
+
+#include "program_cache.h"
+
+
+namespace GLT::render::open_GL {
+
+    constexpr u32 ENTRY_MAGIC = 0x50544c47;                 // "GLTP"
+    constexpr u32 ENTRY_VERSION = 1;
+    constexpr u64 FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr u64 FNV_PRIME = 0x100000001b3ull;
+
+    // header of every cache file, followed by [size] bytes of program binary
+    struct entry_header {
+        u32                                 magic = ENTRY_MAGIC;
+        u32                                 version = ENTRY_VERSION;
+        u64                                 key = 0;
+        u32                                 format = 0;
+        u32                                 size = 0;
+    };
+
+    // FNV-1a, continued from [hash] so several strings can be chained
+    static u64 hash_string(const std::string_view string, u64 hash = FNV_OFFSET) {
+
+        for (const char c : string) {
+            hash ^= static_cast<u8>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    static std::string_view get_GL_string(const GLenum name) {
+
+        const GLubyte* string = glGetString(name);
+        return string ? std::string_view(reinterpret_cast<const char*>(string)) : std::string_view();
+    }
+
+
+    void program_cache::create(const std::filesystem::path& directory) {
+
+        m_enabled = false;
+        GLint format_count = 0;
+        if (GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        VALIDATE(format_count > 0, return, "", "Driver has no program binary formats, shader program cache disabled");
+        VALIDATE(io::create_directory(directory), return, "", "Could not create shader program cache directory [" << directory.generic_string() << "]");
+
+        m_directory = directory;
+        m_driver_hash = hash_string(get_GL_string(GL_VERSION), hash_string(get_GL_string(GL_RENDERER), hash_string(get_GL_string(GL_VENDOR))));
+        m_enabled = true;
+        trim();
+    }
+
+
+    u64 program_cache::get_key(const std::string& vert_source, const std::string& frag_source) const {
+
+        // separator so moving text from one source to the other changes the key
+        return hash_string(frag_source, hash_string(std::string_view("\0", 1), hash_string(vert_source, m_driver_hash)));
+    }
+
+
+    GLuint program_cache::load(const u64 key) {
+
+        if (!m_enabled)
+            return 0;
+
+        const std::filesystem::path path = get_entry_path(key);
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open()) {
+            m_misses++;
+            return 0;
+        }
+
+        entry_header header{};
+        std::vector<char> binary{};
+        if (stream.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == ENTRY_MAGIC && header.version == ENTRY_VERSION && header.key == key) {
+            binary.resize(header.size);
+            if (!stream.read(binary.data(), header.size))
+                binary.clear();
+        }
+        stream.close();
+
+        GLuint program = 0;
+        if (!binary.empty()) {
+
+            program = glCreateProgram();
+            glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+            GLint success = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (!success) {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+
+        std::error_code error{};
+        if (program == 0) {
+            LOG(Debug, "Shader program cache entry [" << path.filename().generic_string() << "] was rejected, compiling from source");
+            std::filesystem::remove(path, error);
+            m_misses++;
+            return 0;
+        }
+
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);        // recently used, kept by trim()
+        m_hits++;
+        return program;
+    }
+
+
+    void program_cache::prepare(const GLuint program) const {
+
+        if (m_enabled)
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+
+    void program_cache::store(const u64 key, const GLuint program) {
+
+        if (!m_enabled || program == 0)
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        entry_header header{};
+        header.key = key;
+        std::vector<char> content(sizeof(entry_header) + length);
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &header.format, content.data() + sizeof(entry_header));
+        if (written <= 0)
+            return;
+
+        header.size = static_cast<u32>(written);
+        content.resize(sizeof(entry_header) + written);
+        std::memcpy(content.data(), &header, sizeof(header));
+        io::write_file(get_entry_path(key), content);
+    }
+
+
+    std::filesystem::path program_cache::get_entry_path(const u64 key) const {
+
+        std::ostringstream name{};
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return m_directory / name.str();
+    }
+
+
+    void program_cache::trim() {
+
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries{};
+        std::error_code error{};
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory, error))
+            if (entry.is_regular_file(error) && entry.path().extension() == ".bin")
+                entries.emplace_back(entry.last_write_time(error), entry.path());
+
+        if (entries.size() <= MAX_ENTRIES)
+            return;
+
+        std::sort(entries.begin(), entries.end());
+        for (size_t x = 0; x < entries.size() - MAX_ENTRIES; x++)
+            std::filesystem::remove(entries[x].second, error);
+        LOG(Trace, "Removed [" << entries.size() - MAX_ENTRIES << "] old shader program cache entries");
+    }
+
+}
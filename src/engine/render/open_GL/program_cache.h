@@ -0,0 +1,53 @@
+#pragma once
+
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief On-disk cache of linked program binaries (ARB_get_program_binary), skips compiling and linking on startup and when switching back
+    //        to a shader that was used before. The key hashes all shader sources together with vendor, renderer and version of the driver,
+    //        a driver update changes every key and old binaries are simply never read again. A binary the driver rejects is deleted and the
+    //        caller compiles from source. Keeps at most MAX_ENTRIES files, the least recently used ones are removed on create().
+    class program_cache {
+    public:
+
+        static constexpr u32 MAX_ENTRIES = 64;
+
+        program_cache() = default;
+        ~program_cache() = default;
+
+        DELETE_COPY_CONSTRUCTOR(program_cache);
+
+        // @brief Requires a current GL context, disables the cache if the driver has no binary formats
+        void create(const std::filesystem::path& directory);
+
+        // @brief Key of a program made of the shader sources [vert_source] and [frag_source] on the current driver
+        u64 get_key(const std::string& vert_source, const std::string& frag_source) const;
+
+        // @brief Linked program of [key] or 0 if there is no usable binary
+        GLuint load(const u64 key);
+
+        // @brief Has to be called on a new program before linking, otherwise some drivers do not keep a binary to store
+        void prepare(const GLuint program) const;
+
+        // @brief Writes the binary of the linked [program] under [key]
+        void store(const u64 key, const GLuint program);
+
+        DEFAULT_GETTER_C(bool,                              enabled)
+        DEFAULT_GETTER_C(u64,                               hits)
+        DEFAULT_GETTER_C(u64,                               misses)
+
+    private:
+
+        std::filesystem::path get_entry_path(const u64 key) const;
+        void trim();
+
+        std::filesystem::path               m_directory{};
+        u64                                 m_driver_hash = 0;
+        u64                                 m_hits = 0;
+        u64                                 m_misses = 0;
+        bool                                m_enabled = false;
+    };
+
+}
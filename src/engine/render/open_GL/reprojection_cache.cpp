@@ -0,0 +1,194 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "shader_program.h"
+#include "state_cache.h"
+#include "reprojection_cache.h"
+
+
+namespace GLT::render::open_GL {
+
+    enum reproject_pass : int {
+        PASS_CLEAR = 0,
+        PASS_DEPTH,
+        PASS_RESOLVE,
+    };
+
+    constexpr u32 WORK_GROUP_SIZE = 8;          // local size of [reproject.comp]
+
+
+    static GLuint create_texture(const u32 width, const u32 height, const GLenum internal_format, const GLenum format, const GLenum type) {
+
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+
+    reprojection_cache::~reprojection_cache() { destroy(); }
+
+
+    void reprojection_cache::create(const u32 width, const u32 height, program_cache& cache) {
+
+        m_program = create_program("shaders/reproject.comp", shader_stages::compute, cache);
+        m_uniforms.resolution = glGetUniformLocation(m_program, "u_resolution");
+        m_uniforms.prev_resolution = glGetUniformLocation(m_program, "u_prev_resolution");
+        m_uniforms.prev_inv_proj = glGetUniformLocation(m_program, "u_prev_inv_proj");
+        m_uniforms.prev_inv_view = glGetUniformLocation(m_program, "u_prev_inv_view");
+        m_uniforms.prev_cam_pos = glGetUniformLocation(m_program, "u_prev_cam_pos");
+        m_uniforms.inv_proj = glGetUniformLocation(m_program, "u_inv_proj");
+        m_uniforms.inv_view = glGetUniformLocation(m_program, "u_inv_view");
+        m_uniforms.view_proj = glGetUniformLocation(m_program, "u_view_proj");
+        m_uniforms.cam_pos = glGetUniformLocation(m_program, "u_cam_pos");
+        m_uniforms.pass = glGetUniformLocation(m_program, "u_pass");
+        glGenFramebuffers(1, &m_framebuffer);
+        glGenBuffers(1, &m_traced_pixel_counter);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_traced_pixel_counter);
+        glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(u32), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+        m_traced_pixel_readback.create(sizeof(u32));
+        resize(width, height);
+    }
+
+
+    void reprojection_cache::destroy() {
+
+        destroy_targets();
+
+#define DELETE_GL_OBJECT(var, function)     if (var != 0) { function(1, &var); var = 0; }
+
+        if (m_program != 0) {
+            state_cache::forget_program(m_program);
+            glDeleteProgram(m_program);
+            m_program = 0;
+        }
+        DELETE_GL_OBJECT(m_framebuffer, glDeleteFramebuffers)
+        state_cache::forget_buffer(m_traced_pixel_counter);
+        DELETE_GL_OBJECT(m_traced_pixel_counter, glDeleteBuffers)
+        m_traced_pixel_readback.destroy();
+
+#undef DELETE_GL_OBJECT
+    }
+
+
+    void reprojection_cache::resize(const u32 width, const u32 height) {
+
+        if (width == m_width && height == m_height && m_color != 0)
+            return;
+
+        m_width = math::max(width, 1u);
+        m_height = math::max(height, 1u);
+        destroy_targets();
+        create_targets();
+        invalidate();
+    }
+
+
+    bool reprojection_cache::begin_frame(const frame_camera& camera, const glm::uvec2 render_extent, const bool enabled) {
+
+        m_render_extent = glm::clamp(render_extent, glm::uvec2(1), glm::uvec2(m_width, m_height));
+        const bool reuse = enabled && m_history_valid && m_program != 0;
+        if (reuse) {
+
+            const glm::mat4 view_proj = glm::inverse(camera.inv_proj) * glm::inverse(camera.inv_view);
+            state_cache::use_program(m_program);
+            glUniform2i(m_uniforms.resolution, m_render_extent.x, m_render_extent.y);
+            glUniform2i(m_uniforms.prev_resolution, m_previous_render_extent.x, m_previous_render_extent.y);
+            glUniformMatrix4fv(m_uniforms.prev_inv_proj, 1, GL_FALSE, glm::value_ptr(m_previous_camera.inv_proj));
+            glUniformMatrix4fv(m_uniforms.prev_inv_view, 1, GL_FALSE, glm::value_ptr(m_previous_camera.inv_view));
+            glUniform3fv(m_uniforms.prev_cam_pos, 1, glm::value_ptr(m_previous_camera.position));
+            glUniformMatrix4fv(m_uniforms.inv_proj, 1, GL_FALSE, glm::value_ptr(camera.inv_proj));
+            glUniformMatrix4fv(m_uniforms.inv_view, 1, GL_FALSE, glm::value_ptr(camera.inv_view));
+            glUniformMatrix4fv(m_uniforms.view_proj, 1, GL_FALSE, glm::value_ptr(view_proj));
+            glUniform3fv(m_uniforms.cam_pos, 1, glm::value_ptr(camera.position));
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, m_history[1 - m_write_index]);
+            glBindImageTexture(0, m_nearest, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+            glBindImageTexture(1, m_reprojected, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+
+            // source pixels live in the previous extent, target pixels in the current one
+            const glm::uvec2 dispatch_extent = glm::max(m_render_extent, m_previous_render_extent);
+            for (const int pass : { PASS_CLEAR, PASS_DEPTH, PASS_RESOLVE }) {
+
+                glUniform1i(m_uniforms.pass, pass);
+                glDispatchCompute((dispatch_extent.x + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, (dispatch_extent.y + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1);
+                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            }
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        // ray tracer reads the reprojected hits and counts what it has to trace itself
+        glBindImageTexture(1, m_reprojected, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        const u32 zero = 0;
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_traced_pixel_counter);
+        glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(u32), &zero);
+        state_cache::bind_buffer(GL_ATOMIC_COUNTER_BUFFER, 0, m_traced_pixel_counter);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_history[m_write_index], 0);
+        const GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, draw_buffers);
+        glDisablei(GL_BLEND, 1);                                                // history holds raw distances, never blend them
+        glViewport(0, 0, m_render_extent.x, m_render_extent.y);
+
+        m_previous_camera = camera;
+        m_previous_render_extent = m_render_extent;
+        return reuse;
+    }
+
+
+    void reprojection_cache::end_frame() {
+
+        m_traced_pixel_readback.capture(m_traced_pixel_counter);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        m_write_index = 1 - m_write_index;
+        m_history_valid = true;
+        m_frame_index++;
+    }
+
+
+    u32 reprojection_cache::get_traced_pixel_count() const {
+
+        u32 count = 0;
+        if (const void* latest = m_traced_pixel_readback.get_latest())
+            std::memcpy(&count, latest, sizeof(count));
+        return count;
+    }
+
+
+    void reprojection_cache::create_targets() {
+
+        m_color = create_texture(m_width, m_height, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        for (GLuint& history : m_history)
+            history = create_texture(m_width, m_height, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+        m_nearest = create_texture(m_width, m_height, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT);
+        m_reprojected = create_texture(m_width, m_height, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_history[m_write_index], 0);
+        VALIDATE(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, , "", "Reprojection framebuffer incomplete");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+
+    void reprojection_cache::destroy_targets() {
+
+        for (GLuint* texture : { &m_color, &m_history[0], &m_history[1], &m_nearest, &m_reprojected }) {
+            if (*texture != 0) {
+                glDeleteTextures(1, texture);
+                *texture = 0;
+            }
+        }
+    }
+
+}
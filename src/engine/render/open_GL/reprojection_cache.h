@@ -0,0 +1,96 @@
+#pragma once
+
+#include "buffer_readback.h"
+
+
+namespace GLT::render::open_GL {
+
+    class program_cache;
+
+    typedef unsigned int	GLuint;
+    typedef int             GLint;
+
+    // @brief Camera state a frame was traced with, the previous one is kept to reproject its hits
+    struct frame_camera {
+        glm::mat4                           inv_proj{1.f};
+        glm::mat4                           inv_view{1.f};
+        glm::vec3                           position{0.f};
+    };
+
+    // @brief Temporal reuse of primary hits for the fragment ray tracer.
+    //        The tracer renders into an offscreen target with a second attachment (normal.xyz, hit distance) per pixel.
+    //        Next frame [reproject.comp] moves these hits into the new camera, the tracer only traces pixels nobody landed on
+    //        (disocclusions, screen edges) and a rotating subset so stale pixels get refreshed. Shading and shadow rays run every frame.
+    //        The tracer may render at a different resolution than the window (see [dynamic_resolution]), [upscaler] scales the color target to it.
+    //        Bindings used while tracing: image unit 1 (reprojected hits), atomic counter binding 0 (traced pixel count)
+    class reprojection_cache {
+    public:
+
+        reprojection_cache() = default;
+        ~reprojection_cache();
+
+        // @brief Creates the compute program (through [cache]) and all targets, requires a current GL context
+        void create(const u32 width, const u32 height, program_cache& cache);
+        void destroy();
+        // @brief Size of the targets, the render extent of a frame can be anything up to it
+        void resize(const u32 width, const u32 height);
+
+        // @brief Forgets the history, the next frame traces every pixel (mesh change, shader reload, resize)
+        FORCEINLINE void invalidate()                                           { m_history_valid = false; }
+
+        // @brief Reprojects last frame's hits (if enabled and available) and binds the offscreen target for the ray tracer
+        // @param render_extent resolution the ray tracer renders at, clamped to the target size
+        // @return true if the ray tracer can reuse the reprojected hits this frame
+        bool begin_frame(const frame_camera& camera, const glm::uvec2 render_extent, const bool enabled);
+
+        // @brief Keeps this frame's hits for the next one, leaves the default framebuffer bound. The image stays in get_color()
+        void end_frame();
+
+        // @brief Number of pixels the ray tracer traced in a frame a few frames back (0 until known), never waits for the GPU
+        u32 get_traced_pixel_count() const;
+
+        DEFAULT_GETTER_C(u64,               frame_index)
+        DEFAULT_GETTER_C(glm::uvec2,        render_extent)
+        DEFAULT_GETTER_C(GLuint,            color)
+
+        FORCEINLINE glm::uvec2 get_target_size() const                          { return glm::uvec2(m_width, m_height); }
+
+    private:
+
+        // uniform locations of [reproject.comp], looked up once after linking
+        struct uniform_locations {
+            GLint                           resolution = -1;
+            GLint                           prev_resolution = -1;
+            GLint                           prev_inv_proj = -1;
+            GLint                           prev_inv_view = -1;
+            GLint                           prev_cam_pos = -1;
+            GLint                           inv_proj = -1;
+            GLint                           inv_view = -1;
+            GLint                           view_proj = -1;
+            GLint                           cam_pos = -1;
+            GLint                           pass = -1;
+        };
+
+        GLuint                              m_program = 0;
+        uniform_locations                   m_uniforms{};
+        GLuint                              m_framebuffer = 0;
+        GLuint                              m_color = 0;
+        GLuint                              m_history[2] = {};                  // ping-pong, written by the tracer / read by the reprojection
+        GLuint                              m_nearest = 0;
+        GLuint                              m_reprojected = 0;
+        GLuint                              m_traced_pixel_counter = 0;
+        buffer_readback                     m_traced_pixel_readback{};
+        u32                                 m_width = 0;
+        u32                                 m_height = 0;
+        glm::uvec2                          m_render_extent{};
+        glm::uvec2                          m_previous_render_extent{};
+        u32                                 m_write_index = 0;
+        u64                                 m_frame_index = 0;
+        bool                                m_history_valid = false;
+        frame_camera                        m_previous_camera{};
+
+        void create_targets();
+        void destroy_targets();
+    };
+
+}
@@ -0,0 +1,261 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "shader_compiler.h"
+
+
+namespace GLT::render::open_GL {
+
+    static std::string get_shader_log(const GLuint shader) {
+
+        char log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        return log;
+    }
+
+
+    shader_compiler::~shader_compiler() { destroy(); }
+
+
+    void shader_compiler::create(GLFWwindow* main_window, const std::filesystem::path& cache_directory, std::string vertex_source) {
+
+        destroy();
+        m_program_cache.create(cache_directory);
+        m_vertex_source = std::move(vertex_source);
+        m_stop = false;
+        m_created = true;
+
+        if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile) {
+
+            if (GLEW_KHR_parallel_shader_compile)
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);             // as many as the driver wants
+            else
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+            m_mode = mode::parallel_extension;
+            LOG(Trace, "Shaders compile on driver threads (parallel_shader_compile)")
+            return;
+        }
+
+        // hidden window only for its context, objects are shared with [main_window]. The other hints are still the ones of the main window
+        m_mode = mode::worker_thread;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_worker_window = glfwCreateWindow(1, 1, "shader compiler", nullptr, main_window);
+        VALIDATE(m_worker_window, return, "", "Could not create the context of the shader compiler thread, shaders compile when they are submitted");
+        m_worker = std::thread(&shader_compiler::worker_loop, this);
+        LOG(Trace, "Shaders compile on a worker thread with a shared context")
+    }
+
+
+    void shader_compiler::destroy() {
+
+        if (!m_created)
+            return;
+
+        if (m_worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_condition.notify_all();
+            m_worker.join();
+        }
+        if (m_worker_window) {
+            glfwDestroyWindow(m_worker_window);
+            m_worker_window = nullptr;
+        }
+
+        // programs nobody picked up anymore
+        for (job& job : m_in_flight) {
+            glDeleteShader(job.frag_shader);
+            glDeleteProgram(job.program);
+        }
+        for (const result& result : m_finished)
+            glDeleteProgram(result.program);
+        m_in_flight.clear();
+        m_requests.clear();
+        m_finished.clear();
+        m_busy = 0;
+
+        if (m_vertex_shader != 0)
+            glDeleteShader(m_vertex_shader);
+        m_vertex_shader = 0;
+        m_created = false;
+    }
+
+
+    u64 shader_compiler::submit(std::string frag_source) {
+
+        job new_job{};
+        const u64 ID = m_next_job++;
+        new_job.ID = ID;
+        new_job.frag_source = std::move(frag_source);
+        new_job.submit_time = std::chrono::steady_clock::now();
+
+        if (m_mode == mode::worker_thread && m_worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_requests.push_back(std::move(new_job));
+            }
+            m_condition.notify_all();
+            return ID;
+        }
+
+        start_job(new_job);
+        if (m_mode == mode::parallel_extension && !new_job.from_cache)
+            m_in_flight.push_back(std::move(new_job));
+        else
+            add_finished(finish_job(new_job));                  // cache hit, or no worker context to compile on
+        return ID;
+    }
+
+
+    void shader_compiler::poll(std::vector<result>& finished) {
+
+        for (size_t x = 0; x < m_in_flight.size(); ) {
+
+            GLint completed = GL_FALSE;
+            glGetProgramiv(m_in_flight[x].program, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed) {
+                x++;
+                continue;
+            }
+            add_finished(finish_job(m_in_flight[x]));
+            m_in_flight.erase(m_in_flight.begin() + x);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (result& result : m_finished)
+            finished.push_back(std::move(result));
+        m_finished.clear();
+    }
+
+
+    void shader_compiler::finish() {
+
+        for (job& job : m_in_flight)
+            add_finished(finish_job(job));                      // the link status query waits for the driver
+        m_in_flight.clear();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return (m_requests.empty() && m_busy == 0) || !m_worker.joinable(); });
+    }
+
+
+    void shader_compiler::start_job(job& job) {
+
+        job.cache_key = m_program_cache.get_key(m_vertex_source, job.frag_source);
+        job.program = m_program_cache.load(job.cache_key);
+        job.from_cache = (job.program != 0);
+        if (job.from_cache)
+            return;
+
+        if (m_vertex_shader == 0) {
+
+            const char* source = m_vertex_source.c_str();
+            m_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(m_vertex_shader, 1, &source, nullptr);
+            glCompileShader(m_vertex_shader);
+        }
+
+        const char* source = job.frag_source.c_str();
+        job.frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(job.frag_shader, 1, &source, nullptr);
+        glCompileShader(job.frag_shader);
+
+        // no status queries in between, they would wait for the compiler
+        job.program = glCreateProgram();
+        m_program_cache.prepare(job.program);
+        glAttachShader(job.program, m_vertex_shader);
+        glAttachShader(job.program, job.frag_shader);
+        glLinkProgram(job.program);
+    }
+
+
+    shader_compiler::result shader_compiler::finish_job(job& job) {
+
+        result result{};
+        result.job = job.ID;
+        result.program = job.program;
+        result.from_cache = job.from_cache;
+        if (!job.from_cache) {
+
+            GLint success = GL_FALSE;
+            glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+            if (success)
+                m_program_cache.store(job.cache_key, job.program);
+            else {
+
+                GLint compiled = GL_FALSE;
+                glGetShaderiv(m_vertex_shader, GL_COMPILE_STATUS, &compiled);
+                if (!compiled)
+                    result.output = "vertex shader: " + get_shader_log(m_vertex_shader);
+
+                glGetShaderiv(job.frag_shader, GL_COMPILE_STATUS, &compiled);
+                if (!compiled)
+                    result.output += get_shader_log(job.frag_shader);
+
+                if (result.output.empty()) {
+                    char log[1024] = {};
+                    glGetProgramInfoLog(job.program, sizeof(log), nullptr, log);
+                    result.output = log;
+                }
+                glDeleteProgram(job.program);
+                result.program = 0;
+            }
+
+            // the fragment shader is only needed for linking, the vertex shader is kept for the next program
+            if (result.program != 0)
+                glDetachShader(job.program, m_vertex_shader);
+            glDeleteShader(job.frag_shader);
+            job.frag_shader = 0;
+        }
+
+        result.time = std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - job.submit_time).count();
+        return result;
+    }
+
+
+    void shader_compiler::add_finished(result&& finished) {
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished.push_back(std::move(finished));
+        }
+        m_condition.notify_all();
+    }
+
+
+    void shader_compiler::worker_loop() {
+
+        glfwMakeContextCurrent(m_worker_window);
+        while (true) {
+
+            job current{};
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+                if (m_stop)
+                    break;
+
+                current = std::move(m_requests.front());
+                m_requests.pop_front();
+                m_busy++;
+            }
+
+            start_job(current);
+            result result = finish_job(current);
+            glFinish();                                         // the program has to be complete before the main context uses it
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished.push_back(std::move(result));
+                m_busy--;
+            }
+            m_condition.notify_all();
+        }
+        glfwMakeContextCurrent(nullptr);
+    }
+
+}
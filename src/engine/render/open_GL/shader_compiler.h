@@ -0,0 +1,91 @@
+#pragma once
+
+#include "program_cache.h"
+
+struct GLFWwindow;
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief Compiles and links programs of the fullscreen vertex shader and a fragment shader without stalling the frame.
+    //        With KHR/ARB_parallel_shader_compile the driver compiles on its own threads and poll() asks for GL_COMPLETION_STATUS,
+    //        otherwise a worker thread with a hidden context sharing the objects of the main context compiles one job after the other.
+    //        Binaries of the program cache are used by both, a cache hit finishes on the next poll(). All functions belong to the render thread.
+    class shader_compiler {
+    public:
+
+        enum class mode : u8 { parallel_extension, worker_thread };
+
+        struct result {
+            u64                             job = 0;
+            GLuint                          program = 0;                // 0 if compiling or linking failed
+            std::string                     output{};                   // compiler and linker messages
+            f32                             time = 0.f;                 // from submit() to the linked program in ms
+            bool                            from_cache = false;
+        };
+
+        shader_compiler() = default;
+        ~shader_compiler();
+
+        DELETE_COPY_CONSTRUCTOR(shader_compiler);
+
+        // @brief Requires the context of [main_window] to be current
+        void create(GLFWwindow* main_window, const std::filesystem::path& cache_directory, std::string vertex_source);
+        void destroy();
+
+        // @brief Starts building a program of [frag_source]
+        // @return Id of the job, results of poll() refer to it
+        u64 submit(std::string frag_source);
+
+        // @brief Moves the jobs that finished since the last call to [finished], once per frame
+        void poll(std::vector<result>& finished);
+
+        // @brief Blocks until every submitted job is finished, poll() returns them afterwards
+        void finish();
+
+        DEFAULT_GETTER_C(mode,                              mode)
+
+    private:
+
+        struct job {
+            u64                             ID = 0;
+            u64                             cache_key = 0;
+            std::string                     frag_source{};
+            GLuint                          program = 0;
+            GLuint                          frag_shader = 0;
+            bool                            from_cache = false;
+            std::chrono::steady_clock::time_point submit_time{};
+        };
+
+        // @brief Issues compiling and linking of [job] on the current context, a program binary from the cache replaces both
+        void start_job(job& job);
+
+        // @brief Reads the link status of [job], blocks if the driver is not done yet, and stores new binaries in the cache
+        result finish_job(job& job);
+
+        void add_finished(result&& finished);
+        void worker_loop();
+
+        mode                                m_mode = mode::worker_thread;
+        program_cache                       m_program_cache{};
+        std::string                         m_vertex_source{};
+        GLuint                              m_vertex_shader = 0;        // compiled once, attached to every program
+        u64                                 m_next_job = 1;
+        bool                                m_created = false;
+
+        // parallel_extension: jobs the driver is working on
+        std::vector<job>                    m_in_flight{};
+
+        // worker_thread: requests and results are handed over under [m_mutex]
+        GLFWwindow*                         m_worker_window = nullptr;
+        std::thread                         m_worker{};
+        std::mutex                          m_mutex{};
+        std::condition_variable             m_condition{};
+        std::deque<job>                     m_requests{};
+        std::vector<result>                 m_finished{};
+        u32                                 m_busy = 0;                 // requests taken by the worker and not finished yet
+        bool                                m_stop = false;
+    };
+
+}
@@ -0,0 +1,108 @@
+#include "util/pch.h"
+
+#include "util/io/io.h"
+
+#include "shader_preprocessor.h"
+
+
+namespace GLT::render::open_GL {
+
+    // @brief True if [line] is the directive [name], [argument] is the rest of the line
+    static bool parse_directive(const std::string_view line, const std::string_view name, std::string_view& argument) {
+
+        const size_t start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || line.substr(start, name.size()) != name)
+            return false;
+
+        argument = line.substr(start + name.size());
+        return true;
+    }
+
+
+    static std::string get_defines_block(const shader_defines& defines) {
+
+        std::string block{};
+        for (const auto& [name, value] : defines)
+            block += "#define " + name + " " + value + "\n";
+        return block;
+    }
+
+
+    static bool expand_file(const std::filesystem::path& file, const shader_defines& defines, preprocessed_shader& result, std::string& output) {
+
+        const u32 file_index = static_cast<u32>(result.files.size());
+        result.files.push_back(file);
+
+        const std::string text = io::read_file(file);
+        VALIDATE(!text.empty(), output = "Could not read the file [" + file.generic_string() + "]"; return false, "", "Failed to read shader file [" << file.generic_string() << "]");
+
+        // defines go after the #version line of the root, or before its first line if it has none
+        bool defines_inserted = (file_index != 0);
+        std::istringstream lines(text);
+        std::string line{};
+        for (u32 line_number = 1; std::getline(lines, line); line_number++) {
+
+            std::string_view argument{};
+            if (parse_directive(line, "#version", argument)) {
+
+                if (file_index == 0) {
+                    result.source += line + "\n" + get_defines_block(defines) + "#line " + std::to_string(line_number + 1) + " 0\n";
+                    defines_inserted = true;
+                } else
+                    result.source += "\n";
+                continue;
+            }
+
+            if (!defines_inserted && line.find_first_not_of(" \t\r") != std::string::npos) {
+                result.source += get_defines_block(defines) + "#line " + std::to_string(line_number) + " 0\n";
+                defines_inserted = true;
+            }
+
+            if (!parse_directive(line, "#include", argument)) {
+                result.source += line + "\n";
+                continue;
+            }
+
+            const size_t name_start = argument.find('"');
+            const size_t name_end = argument.rfind('"');
+            VALIDATE(name_start != std::string_view::npos && name_end > name_start + 1, output = file.generic_string() + "(" + std::to_string(line_number) + "): malformed #include, expected #include \"file\""; return false, "", output);
+
+            const std::filesystem::path include = std::filesystem::weakly_canonical(file.parent_path() / argument.substr(name_start + 1, name_end - name_start - 1));
+            if (result.depends_on(include)) {
+                result.source += "\n";                     // already included, keeps the line numbers
+                continue;
+            }
+
+            result.source += "#line 1 " + std::to_string(result.files.size()) + "\n";
+            if (!expand_file(include, defines, result, output)) {
+                output = file.generic_string() + "(" + std::to_string(line_number) + "): " + output;
+                return false;
+            }
+            result.source += "#line " + std::to_string(line_number + 1) + " " + std::to_string(file_index) + "\n";
+        }
+        return true;
+    }
+
+
+    bool preprocessed_shader::depends_on(const std::filesystem::path& file) const {
+
+        return std::find(files.begin(), files.end(), file) != files.end();
+    }
+
+
+    std::string preprocessed_shader::get_file_legend() const {
+
+        std::string legend{};
+        for (size_t x = 0; x < files.size(); x++)
+            legend += std::to_string(x) + ": " + files[x].lexically_relative(files[0].parent_path()).generic_string() + "\n";
+        return legend;
+    }
+
+
+    bool preprocess_shader(const std::filesystem::path& file, const shader_defines& defines, preprocessed_shader& result, std::string& output) {
+
+        result = {};
+        return expand_file(std::filesystem::weakly_canonical(file), defines, result, output);
+    }
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+
+namespace GLT::render::open_GL {
+
+    // @brief Defines of a shader permutation as name -> value, ordered so the same set always gives the same source
+    using shader_defines = std::map<std::string, std::string>;
+
+    struct preprocessed_shader {
+
+        std::string                         source{};
+        std::vector<std::filesystem::path>  files{};                // every file read, [0] is the root. The index is the source string number of the #line directives
+
+        // @brief True if [file] (canonical, see std::filesystem::weakly_canonical()) was read to build this shader
+        bool depends_on(const std::filesystem::path& file) const;
+
+        // @brief Names the source string numbers compiler messages refer to, e.g. "1: include/ray_tracer.glsl"
+        std::string get_file_legend() const;
+    };
+
+    // @brief Reads [file] and resolves its #include "name" lines, names are relative to the including file. Every file is included once,
+    //        like with #pragma once, which also ends include cycles. #include is resolved regardless of #if blocks, #version lines of included files are dropped.
+    //        [defines] are inserted after the #version line of [file], #line directives keep the line numbers of compiler messages.
+    // @return False if a file could not be read, [output] describes the error
+    bool preprocess_shader(const std::filesystem::path& file, const shader_defines& defines, preprocessed_shader& result, std::string& output);
+
+}
@@ -0,0 +1,93 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "program_cache.h"
+#include "shader_program.h"
+
+
+namespace GLT::render::open_GL {
+
+    static bool preprocess_stage(const std::filesystem::path& file, shader_defines defines, const char* stage, preprocessed_shader& result) {
+
+        if (stage)
+            defines[stage] = "1";
+
+        std::string output{};
+        VALIDATE(preprocess_shader(file, defines, result, output), return false, "", "Failed to preprocess shader [" << file.generic_string() << "]: " << output);
+        return true;
+    }
+
+    static GLuint compile_stage(const GLenum type, const preprocessed_shader& shader, const std::filesystem::path& file) {
+
+        const char* source = shader.source.c_str();
+        GLuint stage_shader = glCreateShader(type);
+        glShaderSource(stage_shader, 1, &source, nullptr);
+        glCompileShader(stage_shader);
+
+        GLint success = GL_FALSE;
+        glGetShaderiv(stage_shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char compiler_log[1024] = {};
+            glGetShaderInfoLog(stage_shader, sizeof(compiler_log), nullptr, compiler_log);
+            LOG(Error, "Shader compilation failed [" << file.generic_string() << "]: " << compiler_log << "\nsource strings:\n" << shader.get_file_legend());
+            glDeleteShader(stage_shader);
+            return 0;
+        }
+        return stage_shader;
+    }
+
+
+    GLuint create_program(const std::filesystem::path& file, const shader_stages stages, program_cache& cache, const shader_defines& defines) {
+
+        // a compute program is keyed like a program without fragment stage
+        preprocessed_shader first{};
+        preprocessed_shader fragment{};
+        if (stages == shader_stages::compute) {
+            if (!preprocess_stage(file, defines, nullptr, first))
+                return 0;
+        } else if (!preprocess_stage(file, defines, "VERTEX_STAGE", first) || !preprocess_stage(file, defines, "FRAGMENT_STAGE", fragment))
+            return 0;
+
+        const u64 key = cache.get_key(first.source, fragment.source);
+        GLuint program = cache.load(key);
+        if (program != 0)
+            return program;
+
+        GLuint shaders[2] = {};
+        if (stages == shader_stages::compute)
+            shaders[0] = compile_stage(GL_COMPUTE_SHADER, first, file);
+        else {
+            shaders[0] = compile_stage(GL_VERTEX_SHADER, first, file);
+            shaders[1] = compile_stage(GL_FRAGMENT_SHADER, fragment, file);
+        }
+        const bool compiled = (shaders[0] != 0) && (stages == shader_stages::compute || shaders[1] != 0);
+
+        program = compiled ? glCreateProgram() : 0;
+        if (program != 0) {
+
+            cache.prepare(program);
+            for (const GLuint shader : shaders)
+                if (shader != 0)
+                    glAttachShader(program, shader);
+            glLinkProgram(program);
+        }
+        for (const GLuint shader : shaders)
+            glDeleteShader(shader);                                 // 0 is ignored, attached shaders are deleted with the program
+        if (program == 0)
+            return 0;
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char compiler_log[1024] = {};
+            glGetProgramInfoLog(program, sizeof(compiler_log), nullptr, compiler_log);
+            LOG(Error, "Program linking failed [" << file.generic_string() << "]: " << compiler_log);
+            glDeleteProgram(program);
+            return 0;
+        }
+        cache.store(key, program);
+        return program;
+    }
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "shader_preprocessor.h"
+
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    class program_cache;
+
+    // @brief Stages built from one shader file
+    enum class shader_stages : u8 {
+        vertex_fragment,                    // compiled twice, with VERTEX_STAGE or FRAGMENT_STAGE defined
+        compute,
+    };
+
+    // @brief Builds the program of the render passes (G-buffer, reprojection, upscaling) from [file] with [defines], requires a current GL context.
+    //        Goes through preprocess_shader() and loads the linked binary from [cache] if it has one, otherwise compiles, links and stores it
+    // @return The linked program or 0 if reading, compiling or linking failed, the error is logged
+    GLuint create_program(const std::filesystem::path& file, const shader_stages stages, program_cache& cache, const shader_defines& defines = {});
+
+}
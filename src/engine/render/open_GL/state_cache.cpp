@@ -0,0 +1,97 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "state_cache.h"
+
+
+namespace GLT::render::open_GL::state_cache {
+
+    constexpr u32 MAX_CACHED_BINDINGS = 8;
+    constexpr GLuint UNKNOWN = std::numeric_limits<GLuint>::max();
+
+    struct buffer_binding {
+        GLuint      buffer = UNKNOWN;
+        size_t      offset = 0;
+        size_t      size = 0;
+    };
+
+    enum binding_target : u32 { STORAGE, UNIFORM, ATOMIC_COUNTER, TARGET_COUNT };
+
+    // the renderer uses one GL context on one thread
+    static GLuint s_program = UNKNOWN;
+    static buffer_binding s_bindings[TARGET_COUNT][MAX_CACHED_BINDINGS]{};
+    static u64 s_skipped_calls = 0;
+
+
+    static buffer_binding* find_binding(const GLenum target, const u32 index) {
+
+        if (index >= MAX_CACHED_BINDINGS)
+            return nullptr;
+
+        switch (target) {
+            case GL_SHADER_STORAGE_BUFFER:  return &s_bindings[STORAGE][index];
+            case GL_UNIFORM_BUFFER:         return &s_bindings[UNIFORM][index];
+            case GL_ATOMIC_COUNTER_BUFFER:  return &s_bindings[ATOMIC_COUNTER][index];
+            default:                        return nullptr;
+        }
+    }
+
+
+    void use_program(const GLuint program) {
+
+        if (program == s_program) {
+            s_skipped_calls++;
+            return;
+        }
+        glUseProgram(program);
+        s_program = program;
+    }
+
+
+    void bind_buffer(const GLenum target, const u32 index, const GLuint buffer, const size_t offset, const size_t size) {
+
+        buffer_binding* binding = find_binding(target, index);
+        if (binding && binding->buffer == buffer && binding->offset == offset && binding->size == size) {
+            s_skipped_calls++;
+            return;
+        }
+
+        if (size == 0)
+            glBindBufferBase(target, index, buffer);
+        else
+            glBindBufferRange(target, index, buffer, offset, size);
+
+        if (binding)
+            *binding = { buffer, offset, size };
+    }
+
+
+    void forget_program(const GLuint program) {
+
+        if (program == s_program)
+            s_program = UNKNOWN;
+    }
+
+
+    void forget_buffer(const GLuint buffer) {
+
+        for (auto& target : s_bindings)
+            for (buffer_binding& binding : target)
+                if (binding.buffer == buffer)
+                    binding = {};
+    }
+
+
+    void invalidate() {
+
+        s_program = UNKNOWN;
+        for (auto& target : s_bindings)
+            for (buffer_binding& binding : target)
+                binding = {};
+    }
+
+
+    u64 get_skipped_calls() { return s_skipped_calls; }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+
+// Last program and indexed buffer bindings set through these functions, calls that would not change anything are skipped.
+// Only sees state changed through it: code deleting programs or buffers has to forget them (GL reuses IDs) and
+// code binding indexed buffers or programs directly has to call invalidate() afterwards.
+// ImGui's backend restores the program it found, so it does not disturb the cache.
+namespace GLT::render::open_GL::state_cache {
+
+    typedef unsigned int	GLuint;
+    typedef unsigned int    GLenum;
+
+    // @brief glUseProgram() unless [program] is current already
+    void use_program(const GLuint program);
+
+    // @brief glBindBufferRange(), or glBindBufferBase() for [size] 0, unless the binding is the same already.
+    //        Caches GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER and GL_ATOMIC_COUNTER_BUFFER bindings up to MAX_CACHED_BINDINGS
+    void bind_buffer(const GLenum target, const u32 index, const GLuint buffer, const size_t offset = 0, const size_t size = 0);
+
+    // @brief Call before deleting [program]
+    void forget_program(const GLuint program);
+    // @brief Call before deleting [buffer]
+    void forget_buffer(const GLuint buffer);
+
+    void invalidate();
+
+    // @brief Calls skipped since the start, to see that the cache is worth it
+    u64 get_skipped_calls();
+
+}
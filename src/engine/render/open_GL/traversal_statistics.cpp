@@ -0,0 +1,120 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "state_cache.h"
+#include "traversal_statistics.h"
+
+
+namespace GLT::render::open_GL {
+
+    enum stats_counter : u32 {
+        COUNTER_RAYS = 0,
+        COUNTER_NODES_VISITED,
+        COUNTER_TRIANGLES_TESTED,
+        COUNTER_COUNT,
+    };
+
+    constexpr GLuint COUNTER_BINDING = 4;
+    constexpr GLuint COST_IMAGE_UNIT = 3;
+
+
+    traversal_statistics::~traversal_statistics() { destroy(); }
+
+
+    void traversal_statistics::create(const u32 width, const u32 height) {
+
+        glGenBuffers(1, &m_counter_buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counter_buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, COUNTER_COUNT * 2 * sizeof(u32), nullptr, GL_DYNAMIC_READ);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_readback.create(COUNTER_COUNT * 2 * sizeof(u32));
+        resize(width, height);
+    }
+
+
+    void traversal_statistics::destroy() {
+
+        if (m_counter_buffer != 0) {
+            state_cache::forget_buffer(m_counter_buffer);
+            glDeleteBuffers(1, &m_counter_buffer);
+            m_counter_buffer = 0;
+        }
+        m_readback.destroy();
+        if (m_cost_image != 0) {
+            glDeleteTextures(1, &m_cost_image);
+            m_cost_image = 0;
+        }
+    }
+
+
+    void traversal_statistics::resize(const u32 width, const u32 height) {
+
+        if (width == m_width && height == m_height && m_cost_image != 0)
+            return;
+
+        m_width = math::max(width, 1u);
+        m_height = math::max(height, 1u);
+        if (m_cost_image != 0)
+            glDeleteTextures(1, &m_cost_image);
+
+        glGenTextures(1, &m_cost_image);
+        glBindTexture(GL_TEXTURE_2D, m_cost_image);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, m_width, m_height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+
+    void traversal_statistics::begin_frame(const glm::uvec2 render_extent) {
+
+        m_render_extent = glm::clamp(render_extent, glm::uvec2(1), glm::uvec2(m_width, m_height));
+
+        const u32 zero[COUNTER_COUNT * 2] = {};
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_counter_buffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        state_cache::bind_buffer(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, m_counter_buffer);
+
+        const u32 no_cost = 0;
+        glClearTexImage(m_cost_image, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &no_cost);     // pixels of other time slices show as cold
+        glBindImageTexture(COST_IMAGE_UNIT, m_cost_image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+    }
+
+
+    void traversal_statistics::end_frame() { m_readback.capture(m_counter_buffer); }
+
+
+    void traversal_statistics::skip_frame() { m_readback.clear(); }
+
+
+    geometry::traversal_stats traversal_statistics::get_stats() const {
+
+        u32 words[COUNTER_COUNT * 2] = {};
+        if (const void* latest = m_readback.get_latest())
+            std::memcpy(words, latest, sizeof(words));
+
+        const auto counter = [&](const stats_counter index) { return (static_cast<u64>(words[index * 2 + 1]) << 32) | words[index * 2]; };
+        geometry::traversal_stats stats{};
+        stats.rays = counter(COUNTER_RAYS);
+        stats.nodes_visited = counter(COUNTER_NODES_VISITED);
+        stats.triangles_tested = counter(COUNTER_TRIANGLES_TESTED);
+        return stats;
+    }
+
+
+    void traversal_statistics::read_heatmap(traversal_heatmap& heatmap) const {
+
+        std::vector<u32> pixels(static_cast<size_t>(m_width) * m_height);
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glBindTexture(GL_TEXTURE_2D, m_cost_image);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // texture rows are bottom-up, the heatmap is stored top-down
+        heatmap.resize(m_render_extent.x, m_render_extent.y);
+        for (u32 y = 0; y < m_render_extent.y; y++)
+            std::memcpy(heatmap.cost.data() + static_cast<size_t>(m_render_extent.y - 1 - y) * m_render_extent.x, pixels.data() + static_cast<size_t>(y) * m_width, m_render_extent.x * sizeof(u32));
+    }
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "geometry/ray_query.h"
+#include "engine/render/traversal_heatmap.h"
+
+#include "buffer_readback.h"
+
+
+namespace GLT::render::open_GL {
+
+    typedef unsigned int	GLuint;
+
+    // @brief GPU side of [traversal_stats_settings] for the fragment ray tracer (permutation with COLLECT_TRAVERSAL_STATS 1).
+    //        Every invocation counts its work in registers and adds it once to 64 bit counters (two words with carry),
+    //        the per pixel cost goes into an R32UI image that can be read back as a [traversal_heatmap].
+    //        The counters come back through a [buffer_readback] a few frames late, only the heatmap export waits for the GPU.
+    //        Bindings used while tracing: SSBO 4 (counters), image unit 3 (cost per pixel)
+    class traversal_statistics {
+    public:
+
+        traversal_statistics() = default;
+        ~traversal_statistics();
+
+        // @brief Creates the counter buffer and the cost image, requires a current GL context
+        void create(const u32 width, const u32 height);
+        void destroy();
+        void resize(const u32 width, const u32 height);
+
+        // @brief Clears counters and costs and binds them for the ray tracer
+        // @param render_extent part of the cost image the frame traces, see read_heatmap()
+        void begin_frame(const glm::uvec2 render_extent);
+
+        // @brief Copies the counters of this frame for a later get_stats(), call after the instrumented draw
+        void end_frame();
+        // @brief Frames traced without the instrumented permutation, drops the pending counters so old values never show up later
+        void skip_frame();
+
+        // @brief Counters of a frame a few frames back (zero until known), never waits for the GPU
+        geometry::traversal_stats get_stats() const;
+
+        // @brief Cost of every pixel of the last frame's render extent, waits for the GPU
+        void read_heatmap(traversal_heatmap& heatmap) const;
+
+    private:
+
+        GLuint                              m_counter_buffer = 0;
+        buffer_readback                     m_readback{};
+        GLuint                              m_cost_image = 0;
+        u32                                 m_width = 0;
+        u32                                 m_height = 0;
+        glm::uvec2                          m_render_extent{};
+    };
+
+}
@@ -0,0 +1,86 @@
+#include "util/pch.h"
+
+#include <GL/glew.h>
+
+#include "shader_program.h"
+#include "state_cache.h"
+#include "upscaler.h"
+
+
+namespace GLT::render::open_GL {
+
+    upscaler::~upscaler() { destroy(); }
+
+
+    void upscaler::create(program_cache& cache) {
+
+        m_program = create_program("shaders/upscale.glsl", shader_stages::vertex_fragment, cache);
+        m_source_scale_location = glGetUniformLocation(m_program, "u_source_scale");
+        m_sharpness_location = glGetUniformLocation(m_program, "u_sharpness");
+        glGenVertexArrays(1, &m_vao);
+        glGenFramebuffers(1, &m_read_framebuffer);
+
+        glGenSamplers(1, &m_sampler);
+        glSamplerParameteri(m_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSamplerParameteri(m_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+
+    void upscaler::destroy() {
+
+#define DELETE_GL_OBJECT(var, function)     if (var != 0) { function(1, &var); var = 0; }
+
+        if (m_program != 0) {
+            state_cache::forget_program(m_program);
+            glDeleteProgram(m_program);
+            m_program = 0;
+        }
+        DELETE_GL_OBJECT(m_vao, glDeleteVertexArrays)
+        DELETE_GL_OBJECT(m_sampler, glDeleteSamplers)
+        DELETE_GL_OBJECT(m_read_framebuffer, glDeleteFramebuffers)
+
+#undef DELETE_GL_OBJECT
+    }
+
+
+    void upscaler::draw(const GLuint source, const glm::uvec2 source_size, const glm::uvec2 render_extent, const glm::uvec2 window_extent, const upscale_settings& settings) {
+
+        if (m_program == 0) {
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_read_framebuffer);
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source, 0);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            const bool scaled = render_extent != window_extent;
+            glBlitFramebuffer(0, 0, render_extent.x, render_extent.y, 0, 0, window_extent.x, window_extent.y, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, window_extent.x, window_extent.y);
+            return;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, window_extent.x, window_extent.y);
+        glDisable(GL_DEPTH_TEST);                                               // covers the whole window, nothing to test against
+
+        const bool sharpen = (settings.mode == upscale_settings::filter::sharpen);
+        state_cache::use_program(m_program);
+        const glm::vec2 source_scale = glm::vec2(render_extent) / glm::vec2(glm::max(source_size, glm::uvec2(1)));
+        glUniform2fv(m_source_scale_location, 1, glm::value_ptr(source_scale));
+        glUniform1f(m_sharpness_location, sharpen ? math::clamp(settings.sharpness, 0.f, 1.f) : 0.f);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindSampler(0, m_sampler);
+
+        glBindVertexArray(m_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        // restore the state the tracer pass and the UI expect
+        glBindSampler(0, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "engine/render/renderer.h"
+
+
+namespace GLT::render::open_GL {
+
+    class program_cache;
+
+    typedef unsigned int	GLuint;
+    typedef int             GLint;
+
+    // @brief Scales the traced image from its offscreen target to the window, see [upscale_settings].
+    //        One fullscreen triangle with [shaders/upscale.glsl], sampling the lower left render extent of the target bilinearly.
+    //        Render scales above 1 go through the same pass, at 2x every window pixel averages 4 traced pixels.
+    //        Falls back to a linear blit if the program could not be built
+    class upscaler {
+    public:
+
+        upscaler() = default;
+        ~upscaler();
+
+        DELETE_COPY_CONSTRUCTOR(upscaler);
+
+        // @brief Creates the program through [cache], requires a current GL context
+        void create(program_cache& cache);
+        void destroy();
+
+        // @brief Draws the [render_extent] part of [source] over the whole default framebuffer and leaves it bound with a window sized viewport
+        // @param source_size size of the [source] texture, the frame uses its lower left [render_extent]
+        void draw(const GLuint source, const glm::uvec2 source_size, const glm::uvec2 render_extent, const glm::uvec2 window_extent, const upscale_settings& settings);
+
+    private:
+
+        GLuint                              m_program = 0;
+        GLint                               m_source_scale_location = -1;
+        GLint                               m_sharpness_location = -1;
+        GLuint                              m_vao = 0;                          // empty, the vertex stage builds the triangle from gl_VertexID
+        GLuint                              m_sampler = 0;                      // linear, the target textures themselves are nearest
+        GLuint                              m_read_framebuffer = 0;             // only for the fallback blit
+    };
+
+}
@@ -0,0 +1,120 @@
+#include "util/pch.h"
+
+#include "range_allocator.h"
+
+
+namespace GLT::render {
+
+    range_allocator::range_allocator(const u64 capacity) { grow(capacity); }
+
+
+    u64 range_allocator::allocate(const u64 size) {
+
+        if (size == 0)
+            return INVALID_OFFSET;
+
+        auto best = m_free_blocks.end();
+        for (auto block = m_free_blocks.begin(); block != m_free_blocks.end(); block++)
+            if (block->second >= size && (best == m_free_blocks.end() || block->second < best->second))
+                best = block;
+
+        if (best == m_free_blocks.end())
+            return INVALID_OFFSET;
+
+        const u64 offset = best->first;
+        const u64 remaining = best->second - size;
+        m_free_blocks.erase(best);
+        if (remaining > 0)
+            m_free_blocks.emplace(offset + size, remaining);
+
+        m_allocations.emplace(offset, size);
+        m_used += size;
+        return offset;
+    }
+
+
+    void range_allocator::free(const u64 offset) {
+
+        const auto allocation = m_allocations.find(offset);
+        VALIDATE(allocation != m_allocations.end(), return, "", "Range at [" << offset << "] was not allocated");
+
+        u64 block_offset = offset;
+        u64 block_size = allocation->second;
+        m_used -= allocation->second;
+        m_allocations.erase(allocation);
+
+        // merge with the free neighbours
+        auto next = m_free_blocks.lower_bound(block_offset);
+        if (next != m_free_blocks.end() && next->first == block_offset + block_size) {
+            block_size += next->second;
+            next = m_free_blocks.erase(next);
+        }
+        if (next != m_free_blocks.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == block_offset) {
+                block_offset = previous->first;
+                block_size += previous->second;
+                m_free_blocks.erase(previous);
+            }
+        }
+        m_free_blocks.emplace(block_offset, block_size);
+    }
+
+
+    void range_allocator::grow(const u64 new_capacity) {
+
+        if (new_capacity <= m_capacity)
+            return;
+
+        // extend a free block touching the old end, or add a new one
+        u64 block_offset = m_capacity;
+        if (!m_free_blocks.empty()) {
+            auto last = std::prev(m_free_blocks.end());
+            if (last->first + last->second == m_capacity) {
+                block_offset = last->first;
+                m_free_blocks.erase(last);
+            }
+        }
+        m_free_blocks.emplace(block_offset, new_capacity - block_offset);
+        m_capacity = new_capacity;
+    }
+
+
+    std::vector<range_allocator::move> range_allocator::compact(const u64 new_capacity) {
+
+        VALIDATE(new_capacity >= m_used, return {}, "", "Can not compact [" << m_used << "] used units into a capacity of [" << new_capacity << "]");
+
+        std::vector<move> moves{};
+        std::map<u64, u64> packed{};
+        u64 offset = 0;
+        for (const auto& [from, size] : m_allocations) {
+            moves.push_back({ from, offset, size });
+            packed.emplace(offset, size);
+            offset += size;
+        }
+
+        m_allocations = std::move(packed);
+        m_free_blocks.clear();
+        if (new_capacity > offset)
+            m_free_blocks.emplace(offset, new_capacity - offset);
+        m_capacity = new_capacity;
+        return moves;
+    }
+
+
+    u64 range_allocator::get_largest_free_block() const {
+
+        u64 largest = 0;
+        for (const auto& [offset, size] : m_free_blocks)
+            largest = math::max(largest, size);
+        return largest;
+    }
+
+
+    f32 range_allocator::get_fragmentation() const {
+
+        const u64 free_space = m_capacity - m_used;
+        return (free_space == 0) ? 0.f : 1.f - static_cast<f32>(get_largest_free_block()) / static_cast<f32>(free_space);
+    }
+
+}
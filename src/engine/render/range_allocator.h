@@ -0,0 +1,48 @@
+#pragma once
+
+
+namespace GLT::render {
+
+    // @brief Free list sub-allocator for ranges of a shared GPU buffer, only does the bookkeeping, units are up to the caller (bytes, elements).
+    //        Best fit over the free blocks, neighbouring free blocks are merged on free(). compact() packs all allocations to the front
+    //        keeping their order and returns where everything moved so the owner can copy the data on the GPU.
+    class range_allocator {
+    public:
+
+        static constexpr u64 INVALID_OFFSET = std::numeric_limits<u64>::max();
+
+        struct move {
+            u64     from;
+            u64     to;
+            u64     size;
+        };
+
+        range_allocator(const u64 capacity = 0);
+
+        // @brief Offset of a free range of [size] units, INVALID_OFFSET if no free block is large enough
+        u64 allocate(const u64 size);
+        void free(const u64 offset);
+
+        // @brief Adds free space at the end
+        void grow(const u64 new_capacity);
+
+        // @brief Packs all allocations to the front and sets the capacity to [new_capacity] (>= get_used())
+        // @return one entry per allocation, the owner has to move its data and update the offsets it handed out
+        std::vector<move> compact(const u64 new_capacity);
+
+        u64 get_largest_free_block() const;
+        // @brief 0 if all free space is one block, close to 1 if it is spread over many small blocks
+        f32 get_fragmentation() const;
+
+        DEFAULT_GETTER_C(u64,                               capacity)
+        DEFAULT_GETTER_C(u64,                               used)
+
+    private:
+
+        u64                                 m_capacity = 0;
+        u64                                 m_used = 0;
+        std::map<u64, u64>                  m_free_blocks{};        // offset => size
+        std::map<u64, u64>                  m_allocations{};        // offset => size
+    };
+
+}
@@ -0,0 +1,144 @@
+#include "util/pch.h"
+
+#include "render_thread.h"
+
+
+namespace GLT::render {
+
+    render_thread::~render_thread() { stop(); }
+
+
+    void render_thread::start(command on_start, render_function render, command on_stop) {
+
+        VALIDATE(!m_running, return, "", "Render thread is already running");
+
+        m_render = std::move(render);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = false;
+            m_running = true;
+        }
+        m_thread = std::thread(&render_thread::thread_loop, this, std::move(on_start), std::move(on_stop));
+        m_consumer.store(m_thread.get_id(), std::memory_order_release);        // it only drains after the next submit() of this thread
+        LOG(Trace, "Render thread started")
+    }
+
+
+    void render_thread::stop() {
+
+        if (!m_running)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_packet_submitted.notify_one();
+        m_thread.join();
+        m_consumer.store(std::this_thread::get_id(), std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+        m_packet_completed.notify_all();                    // producers waiting in flush_tasks()
+        LOG(Trace, "Render thread stopped after [" << m_completed << "] frames")
+    }
+
+
+    u32 render_thread::begin_frame() {
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_packet_completed.wait(lock, [this] { return m_submitted - m_completed < PACKET_COUNT; });
+        return static_cast<u32>(m_submitted % PACKET_COUNT);
+    }
+
+
+    void render_thread::submit() {
+
+        const u32 slot = static_cast<u32>(m_submitted % PACKET_COUNT);
+        if (!m_running) {
+
+            m_task_marks[slot] = m_tasks.get_push_position();
+            m_submitted++;
+            execute(slot);
+            m_completed++;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task_marks[slot] = m_tasks.get_push_position();
+            m_submitted++;
+        }
+        m_packet_submitted.notify_one();
+    }
+
+
+    void render_thread::wait_idle() {
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_packet_completed.wait(lock, [this] { return m_completed == m_submitted; });
+    }
+
+
+    void render_thread::thread_loop(command on_start, command on_stop) {
+
+        on_start();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+
+            m_packet_submitted.wait(lock, [this] { return m_completed < m_submitted || m_flush_requested || m_stop; });
+            if (m_completed == m_submitted) {
+
+                if (!m_flush_requested)
+                    break;                                  // stop requested and every packet is drawn
+
+                // queue is full and every packet is drawn, the tasks meant for the next packet run now to make room
+                lock.unlock();
+                m_tasks.drain();
+                lock.lock();
+                m_flush_requested = false;
+                m_packet_completed.notify_all();
+                continue;
+            }
+
+            const u32 slot = static_cast<u32>(m_completed % PACKET_COUNT);
+            lock.unlock();
+            execute(slot);
+            lock.lock();
+
+            m_completed++;
+            m_packet_completed.notify_all();
+        }
+        lock.unlock();
+
+        on_stop();
+    }
+
+
+    void render_thread::flush_tasks() {
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_running) {                                   // the caller of submit() runs the tasks
+
+            lock.unlock();
+            std::this_thread::yield();
+            return;
+        }
+
+        m_flush_requested = true;
+        m_packet_submitted.notify_one();
+        m_packet_completed.wait(lock, [this] { return !m_flush_requested || !m_running; });
+    }
+
+
+    void render_thread::execute(const u32 slot) {
+
+        m_tasks.drain(m_task_marks[slot]);                  // the only consumer: this thread while running, the caller of submit() otherwise
+
+        if (m_render)
+            m_render(slot);
+    }
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "util/data_structures/task_queue.h"
+
+namespace GLT::render {
+
+    // @brief Double buffered hand-off of frame packets from the main thread to a render thread.
+    //        The main thread fills packet N+1 while the render thread draws packet N. begin_frame() blocks until packet N-1 is drawn,
+    //        so input and simulation are never more than one frame ahead of the image. The packets themselves belong to the owner,
+    //        this class only decides which slot each side may use.
+    //        Tasks of enqueue() run on the render thread right before the first packet submitted after them.
+    //        Until start() and after stop() everything runs on the calling thread, submit() draws the packet immediately.
+    class render_thread {
+    public:
+
+        static constexpr u32                PACKET_COUNT = 2;
+        static constexpr u32                TASK_CAPACITY = 256;
+
+        using command = std::function<void()>;
+        using render_function = std::function<void(const u32 slot)>;
+
+        render_thread() = default;
+        ~render_thread();
+
+        DELETE_COPY_CONSTRUCTOR(render_thread);
+        DEFAULT_GETTER_C(bool,                              running)
+
+        // @brief [on_start] and [on_stop] run on the new thread (acquire and release the graphics context), [render] draws the packet of [slot]
+        void start(command on_start, render_function render, command on_stop);
+
+        // @brief Draws the submitted packets and joins the thread, tasks enqueued after that run with the next submit()
+        void stop();
+
+        // @brief Main thread: waits until the render thread started the last submitted packet
+        // @return Slot of the packet the main thread may fill now
+        u32 begin_frame();
+
+        // @brief Main thread: hands the packet of begin_frame() to the render thread
+        void submit();
+
+        // @brief Main thread: waits until every submitted packet is drawn
+        void wait_idle();
+
+        // @brief Any thread: runs [task] on the render thread before it draws the next submitted packet, without allocating (see util::task_queue).
+        //        Never drops [task]: while the queue is full the render thread runs the queued tasks early, once the packets submitted before them are drawn.
+        //        On the thread consuming the queue the queued tasks (and [task] if there is still no room) run right away
+        template<typename task_type>
+        void enqueue(task_type&& task) {
+
+            while (!m_tasks.push(std::forward<task_type>(task))) {             // a failed push leaves [task] untouched
+                if (m_consumer.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+
+                    m_tasks.drain();
+                    if (!m_tasks.push(std::forward<task_type>(task)))           // only when called by a queued task, its own cell is still taken
+                        task();
+                    return;
+                }
+                flush_tasks();
+            }
+        }
+
+    private:
+
+        void thread_loop(command on_start, command on_stop);
+        void execute(const u32 slot);
+
+        // @brief Producer side of a full queue: asks the render thread to run the queued tasks and waits for it, yields while it is not running
+        void flush_tasks();
+
+        render_function                     m_render{};
+        std::thread                         m_thread{};
+        std::mutex                          m_mutex{};
+        std::condition_variable             m_packet_submitted{};
+        std::condition_variable             m_packet_completed{};
+        util::task_queue<TASK_CAPACITY>     m_tasks{};                                      // consumed by the render thread, by the caller of submit() while not running
+        std::array<u64, PACKET_COUNT>       m_task_marks{};                                 // push position of [m_tasks] when the packet of each slot was submitted
+        std::atomic<std::thread::id>        m_consumer{ std::this_thread::get_id() };       // thread running [m_tasks]: the render thread, the owner while not running
+        u64                                 m_submitted = 0;
+        u64                                 m_completed = 0;
+        bool                                m_running = false;
+        bool                                m_stop = false;
+        bool                                m_flush_requested = false;                      // a producer found [m_tasks] full
+    };
+
+}
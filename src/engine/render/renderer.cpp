@@ -0,0 +1,80 @@
+#include "util/pch.h"
+
+#include "renderer.h"
+
+
+namespace GLT::render {
+
+    static f32 milliseconds_since(const std::chrono::steady_clock::time_point start) { return std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - start).count(); }
+
+
+    void renderer::start_render_thread() {
+
+        if (m_render_thread.get_running())
+            return;
+
+        set_context_current(false);
+        m_render_thread.start(
+            [this] { set_context_current(true); },
+            [this](const u32 slot) { render_frame(m_packets[slot]); },
+            [this] { set_context_current(false); });
+    }
+
+
+    void renderer::stop_render_thread() {
+
+        if (!m_render_thread.get_running())
+            return;
+
+        m_render_thread.stop();
+        set_context_current(true);
+    }
+
+
+    void renderer::begin_frame() {
+
+        const auto wait_start = std::chrono::steady_clock::now();
+        m_packet = &m_packets[m_render_thread.begin_frame()];
+        const f32 wait_time = milliseconds_since(wait_start);
+        m_frame_start = std::chrono::steady_clock::now();
+
+        // results of the frame this packet was drawn with last time
+        if (m_packet->frame_number != 0) {
+
+            m_general_performance_metrik = m_packet->metrik;
+            m_shader_reload = m_packet->shader_reload;
+            if (m_packet->traversal_stats_failed)
+                m_traversal_stats.enabled = false;
+        }
+        m_general_performance_metrik.CPU_simulation_time = m_simulation_time;
+        m_general_performance_metrik.CPU_UI_time = m_UI_time;
+        m_general_performance_metrik.CPU_wait_time = wait_time;
+    }
+
+
+    void renderer::draw_frame(const f32 delta_time) {
+
+        VALIDATE(m_packet, return, "", "draw_frame() without begin_frame()");
+
+        m_simulation_time = milliseconds_since(m_frame_start);
+        const auto draw_start = std::chrono::steady_clock::now();
+
+        frame_packet& packet = *m_packet;
+        packet.frame_number = ++m_frame_number;
+        packet.delta_time = delta_time;
+        build_frame(packet);
+
+        // after the UI, changes show up in this frame
+        packet.settings.temporal_reuse = m_temporal_reuse;
+        packet.settings.hybrid_rendering = m_hybrid_rendering;
+        packet.settings.time_slicing = m_time_slicing;
+        packet.settings.soft_shadows = m_soft_shadows;
+        packet.settings.traversal_stats = m_traversal_stats;
+        packet.settings.upscale = m_upscale;
+
+        m_UI_time = milliseconds_since(draw_start);
+        m_packet = nullptr;
+        m_render_thread.submit();
+    }
+
+}
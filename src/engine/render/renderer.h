@@ -3,6 +3,12 @@
 
 #include "engine/platform/window.h"
 #include "engine/render/buffer.h"
+#include "engine/render/dynamic_resolution.h"
+#include "engine/render/traversal_heatmap.h"
+#include "engine/render/render_thread.h"
+#include "engine/render/ui_draw_snapshot.h"
+#include "geometry/ray_query.h"
+#include "util/math/sampling.h"
 
 namespace GLT {
     class layer_stack;
@@ -18,13 +24,23 @@ namespace GLT::render {
 
         u32 meshes = 0, draw_calls = 0;
         u64 vertices = 0;
+        u64 mesh_GPU_memory = 0;                                    // bytes of the traced mesh in the mesh pool, the render thread owns its [GPU_range]
         f32 sleep_time = 0.f, work_time = 0.f;
         u32 material_binding_count = 0, pipline_binding_count = 0;
+        u32 traced_pixels = 0, reused_pixels = 0;                   // primary rays, read back without waiting so a few frames old, see [temporal_reuse_settings]
+        u32 slice_index = 0, slice_count = 1;                       // see [time_slicing_settings]
+        geometry::traversal_stats traversal{};                      // BVH work, read back without waiting so a few frames old, only while [traversal_stats_settings] is enabled
+        f32 GPU_trace_time = 0.f, GPU_upscale_time = 0.f, GPU_UI_time = 0.f, GPU_present_time = 0.f;      // in ms, read back without waiting so a few frames old
+        f32 CPU_simulation_time = 0.f, CPU_UI_time = 0.f, CPU_wait_time = 0.f;    // in ms, main thread: events and layer updates, building the UI and the packet, waiting for the render thread
+        f32 CPU_render_time = 0.f, CPU_present_time = 0.f;                        // in ms, render thread: recording the frame, swapping buffers
 
         #define GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE       200
         f32 renderer_draw_time[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};
         f32 draw_geometry_time[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};
         f32 waiting_idle_time[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};
+        f32 traced_rays[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};          // in thousands
+        f32 nodes_per_ray[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};
+        f32 triangles_per_ray[GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE] = {};
         u16 current_index = 0;
 
         void next_iteration() {
@@ -34,7 +50,111 @@ namespace GLT::render {
             material_binding_count = pipline_binding_count = draw_calls = meshes = 0;
             vertices = 0;
             sleep_time = work_time = 0.f;
+            traversal = {};
         }
+
+        // @brief Sum of the GPU zones in ms, 0 until the first timer query finished
+        f32 get_GPU_frame_time() const { return GPU_trace_time + GPU_upscale_time + GPU_UI_time + GPU_present_time; }
+
+        void set_traversal_stats(const geometry::traversal_stats& stats) {
+
+            traversal = stats;
+            const f32 rays = static_cast<f32>(math::max<u64>(stats.rays, 1));
+            traced_rays[current_index] = stats.rays / 1000.f;
+            nodes_per_ray[current_index] = stats.nodes_visited / rays;
+            triangles_per_ray[current_index] = stats.triangles_tested / rays;
+        }
+    };
+
+    // @brief Reuse of last frame's primary hits while the camera moves, pixels nobody reprojects onto are traced again
+    struct temporal_reuse_settings {
+        bool enabled = true;
+        u32 refresh_period = 16;                                    // every pixel is re-traced at least once per [refresh_period] frames
+    };
+
+    // @brief Rasterizes the mesh for primary visibility instead of tracing a ray per pixel, the ray tracer starts at the rasterized surface
+    //        and only traces the rays of secondary effects. Geometry outside the near / far clipping planes of the camera is not visible
+    struct hybrid_rendering_settings {
+        bool enabled = false;
+    };
+
+    // @brief Spreads the primary rays of a frame over several UI frames so big meshes at high resolution keep the editor responsive.
+    //        Every frame traces an interleaved set of scanlines, the others keep their last color
+    struct time_slicing_settings {
+        bool enabled = false;
+        u32 ray_budget = 1 << 16;                                   // primary rays per UI frame, rounded down to whole scanlines
+    };
+
+    // @brief Disk shaped light, more than one shadow ray per pixel gives soft shadows
+    struct soft_shadow_settings {
+        f32 light_angle = 0.f;                                      // angular radius in degrees, 0 => hard shadows from a single ray
+        u32 samples = 4;                                            // shadow rays per lit pixel and frame
+        math::sampling::pattern pattern = math::sampling::pattern::blue_noise;
+        bool any_hit = true;                                        // shadow rays stop at the first occluder, off traces them to the closest hit (reference)
+    };
+
+    // @brief Instrumentation mode of the ray tracer: counts rays, visited BVH nodes and tested triangles of every frame
+    //        and keeps the cost of every pixel so pathological BVH regions can be found. Slows tracing down, off by default
+    struct traversal_stats_settings {
+        bool enabled = false;
+        bool show_heatmap = false;                                  // replaces the shading with the cost of every pixel
+        u32 heatmap_max = 256;                                      // cost (nodes + triangles) shown as the hottest color
+    };
+
+    // @brief Last pass of the ray traced image, scales the render extent (see [dynamic_resolution]) to the window. The UI is drawn after it at window resolution
+    struct upscale_settings {
+        enum class filter : u8 { bilinear, sharpen };
+        filter mode = filter::sharpen;                              // sharpen brings back edges lost when upscaling, bilinear is a plain resample
+        f32 sharpness = .5f;                                        // 0 - 1
+    };
+
+    // @brief Result of the last reload_fragment_shader(), programs compile in the background and the previous one is shown until the new one linked
+    struct shader_reload_status {
+        std::filesystem::path file{};
+        bool pending = false;
+        bool succeeded = true;
+        std::string output{};                                       // compiler and linker messages if it failed
+    };
+
+    // @brief Copy of the renderer settings a frame is drawn with, the UI changes the originals on the main thread
+    struct frame_settings {
+        temporal_reuse_settings temporal_reuse{};
+        hybrid_rendering_settings hybrid_rendering{};
+        time_slicing_settings time_slicing{};
+        soft_shadow_settings soft_shadows{};
+        traversal_stats_settings traversal_stats{};
+        upscale_settings upscale{};
+    };
+
+    // @brief Everything the render thread needs of one frame, the main thread fills it while the render thread draws the previous one.
+    //        [mesh] is the only data shared with the main thread, its contents only change after renderer::wait_idle()
+    struct frame_packet {
+
+        u64 frame_number = 0;
+        f32 delta_time = 0.f;
+
+        // -------- camera and window --------
+        glm::mat4 inv_proj{1.f};
+        glm::mat4 inv_view{1.f};
+        glm::vec3 camera_position{0.f};
+        glm::uvec2 window_extent{0};
+        glm::uvec2 render_extent{0};                                // ray traced resolution, see [dynamic_resolution], can be bigger than the window
+        f32 render_scale = 1.f;
+        glm::vec2 mouse{0.f};                                       // window coordinates, y points down
+
+        // -------- mesh --------
+        ref<geometry::static_mesh> mesh{};
+        int bvh_viz_max_depth = 0;
+        bool bvh_show_leaves = false;
+        glm::vec4 bvh_viz_color{0.f};
+
+        frame_settings settings{};
+        ui_draw_snapshot UI{};
+
+        // -------- written by the render thread, read by the main thread before it fills the packet again --------
+        general_performance_metrik metrik{};
+        shader_reload_status shader_reload{};
+        bool traversal_stats_failed = false;                        // the instrumented program could not be built
     };
 
     class renderer {
@@ -45,14 +165,49 @@ namespace GLT::render {
         virtual ~renderer() = default;
     
 		DEFAULT_GETTERS(general_performance_metrik,	        general_performance_metrik)
+        DEFAULT_GETTER_REF(temporal_reuse_settings,         temporal_reuse)
+        DEFAULT_GETTER_REF(dynamic_resolution,              dynamic_resolution)
+        DEFAULT_GETTER_REF(time_slicing_settings,           time_slicing)
+        DEFAULT_GETTER_REF(hybrid_rendering_settings,       hybrid_rendering)
+        DEFAULT_GETTER_REF(soft_shadow_settings,            soft_shadows)
+        DEFAULT_GETTER_REF(traversal_stats_settings,        traversal_stats)
+        DEFAULT_GETTER_REF(upscale_settings,                upscale)
+        DEFAULT_GETTER_REF(shader_reload_status,            shader_reload)
+
+        // -------- main thread --------
+        // @brief Moves drawing to its own thread, the graphics context goes with it. Before this and after stop_render_thread() frames are drawn by draw_frame()
+        void start_render_thread();
+        void stop_render_thread();
+
+        // @brief Start of a frame of the main thread, waits until the render thread started the last frame so input is at most one frame ahead of the image
+        void begin_frame();
+
+        // @brief Builds the UI, fills the frame packet and hands it to the render thread
+        void draw_frame(const f32 delta_time);
+
+        // @brief Waits until every submitted frame is drawn, needed before the main thread changes data the render thread reads (mesh contents)
+        FORCEINLINE void wait_idle()                                { m_render_thread.wait_idle(); }
+
+        // @brief Any thread: runs [task] on the render thread before it draws the next frame, graphics work of other threads goes here
+        template<typename task_type>
+        FORCEINLINE void enqueue(task_type&& task)                  { m_render_thread.enqueue(std::forward<task_type>(task)); }
 
-        virtual void draw_frame(float delta_time) = 0;
         virtual void set_size(const u32 width, const u32 height) = 0;
 
+        // @brief Builds the BVH of [mesh] if it has none yet and uploads it with the next frame
         virtual void upload_static_mesh(ref<GLT::geometry::static_mesh> mesh) = 0;
+
+        // @brief Frees the GPU memory of [mesh] with the next frame, waits until the render thread no longer reads it so its contents may change afterwards
         virtual void remove_static_mesh(ref<GLT::geometry::static_mesh> mesh) = 0;
+
+        // -------- render thread (see enqueue()) --------
+        // @brief Starts building a program of [frag_file], the outcome ends up in [shader_reload_status]
+        // @return False if the shader files could not be read, [output] describes the error
         virtual bool reload_fragment_shader(const std::filesystem::path& frag_file, std::string& output) = 0;
 
+        // @brief Writes the traversal cost of the last frame as an image, needs [traversal_stats_settings::enabled]
+        virtual bool export_traversal_heatmap(const std::filesystem::path& file) = 0;
+
         // -------- ImGui --------
         virtual void imgui_init() = 0;
         virtual void imgui_shutdown() = 0;
@@ -64,12 +219,36 @@ namespace GLT::render {
 
     protected:
 
+        // @brief Main thread: builds the UI and fills everything of [packet] the main thread owns
+        virtual void build_frame(frame_packet& packet) = 0;
+
+        // @brief Render thread: draws [packet] and writes its results
+        virtual void render_frame(frame_packet& packet) = 0;
+
+        // @brief Makes the graphics context current on the calling thread, or releases it
+        virtual void set_context_current(const bool current) = 0;
+
         ref<GLT::window>                    m_window;
         ref<GLT::layer_stack>               m_layer_stack;
         system_state                        m_system_state = system_state::inactive;
         general_performance_metrik          m_general_performance_metrik{};
+        temporal_reuse_settings             m_temporal_reuse{};
+        dynamic_resolution                  m_dynamic_resolution{};
+        time_slicing_settings               m_time_slicing{};
+        hybrid_rendering_settings           m_hybrid_rendering{};
+        soft_shadow_settings                m_soft_shadows{};
+        traversal_stats_settings            m_traversal_stats{};
+        upscale_settings                    m_upscale{};
+        shader_reload_status                m_shader_reload{};
         ref<camera>                         m_active_camera;
-    
+
+        render_thread                       m_render_thread{};
+        std::array<frame_packet, render_thread::PACKET_COUNT> m_packets{};
+        frame_packet*                       m_packet = nullptr;                 // filled by the main thread between begin_frame() and submit_frame()
+        u64                                 m_frame_number = 0;
+        std::chrono::steady_clock::time_point m_frame_start{};                  // after the wait of begin_frame()
+        f32                                 m_simulation_time = 0.f;            // in ms, last frame of the main thread
+        f32                                 m_UI_time = 0.f;
     };
 
 }
@@ -0,0 +1,42 @@
+#include "util/pch.h"
+
+#include "traversal_heatmap.h"
+
+
+namespace GLT::render {
+
+    glm::vec3 heatmap_color(const u32 cost, const u32 max_cost) {
+
+        if (cost > max_cost)
+            return glm::vec3(1.f);
+
+        const f32 x = static_cast<f32>(cost) / static_cast<f32>(math::max(max_cost, 1u));
+        return glm::clamp(glm::vec3(1.5f) - glm::abs(glm::vec3(4.f * x - 3.f, 4.f * x - 2.f, 4.f * x - 1.f)), 0.f, 1.f);
+    }
+
+
+    u32 traversal_heatmap::get_max_cost() const {
+
+        u32 max_cost = 0;
+        for (const u32 value : cost)
+            max_cost = math::max(max_cost, value);
+        return max_cost;
+    }
+
+
+    io::image traversal_heatmap::to_image(const u32 max_cost) const {
+
+        const u32 loc_max_cost = max_cost ? max_cost : get_max_cost();
+        io::image image{};
+        image.resize(width, height);
+        for (u64 x = 0; x < cost.size(); x++) {
+
+            const glm::vec3 color = heatmap_color(cost[x], loc_max_cost);
+            image.pixels[x * 3 + 0] = static_cast<u8>(color.r * 255.f + .5f);
+            image.pixels[x * 3 + 1] = static_cast<u8>(color.g * 255.f + .5f);
+            image.pixels[x * 3 + 2] = static_cast<u8>(color.b * 255.f + .5f);
+        }
+        return image;
+    }
+
+}
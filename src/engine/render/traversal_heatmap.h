@@ -0,0 +1,27 @@
+#pragma once
+
+#include "util/io/image_writer.h"
+
+
+namespace GLT::render {
+
+    // @brief BVH work (nodes visited + triangles tested, primary and shadow rays) of every pixel of one frame.
+    //        Rows are stored top to bottom like [io::image], written by the CPU tracer or read back from the GL tracer
+    struct traversal_heatmap {
+
+        u32                                 width = 0;
+        u32                                 height = 0;
+        std::vector<u32>                    cost{};
+
+        void resize(const u32 new_width, const u32 new_height) { width = new_width; height = new_height; cost.assign(static_cast<size_t>(width) * height, 0); }
+
+        u32 get_max_cost() const;
+
+        // @brief Maps every cost to [heatmap_color()], the gradient ends at [max_cost] (0 => largest cost in the map)
+        io::image to_image(const u32 max_cost = 0) const;
+    };
+
+    // @brief Blue over green to red for costs up to [max_cost], white above it. Twin of heatmap_color() in [shaders/include/traversal_stats.glsl]
+    glm::vec3 heatmap_color(const u32 cost, const u32 max_cost);
+
+}
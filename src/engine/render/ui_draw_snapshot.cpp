@@ -0,0 +1,65 @@
+#include "util/pch.h"
+
+#include <imgui.h>
+
+#include "ui_draw_snapshot.h"
+
+
+namespace GLT::render {
+
+    // resize() keeps the capacity of an ImVector, assigning one would free and allocate again
+    template<typename T>
+    static void copy_buffer(ImVector<T>& destination, const ImVector<T>& source) {
+
+        destination.resize(source.Size);
+        if (source.Size > 0)
+            std::memcpy(destination.Data, source.Data, static_cast<size_t>(source.Size) * sizeof(T));
+    }
+
+
+    ui_draw_snapshot::ui_draw_snapshot()
+        : m_draw_data(IM_NEW(ImDrawData)()) {}
+
+
+    ui_draw_snapshot::~ui_draw_snapshot() {
+
+        for (ImDrawList* list : m_lists)
+            IM_DELETE(list);
+        IM_DELETE(m_draw_data);
+    }
+
+
+    void ui_draw_snapshot::capture(const ImDrawData* draw_data) {
+
+        m_valid = (draw_data && draw_data->Valid);
+        if (!m_valid)
+            return;
+
+        // only the buffers are used for drawing, the lists do not need the shared data of the ImGui context
+        while (m_lists.size() < static_cast<size_t>(draw_data->CmdListsCount))
+            m_lists.push_back(IM_NEW(ImDrawList)(nullptr));
+
+        m_draw_data->Clear();
+        for (int x = 0; x < draw_data->CmdListsCount; x++) {
+
+            const ImDrawList* source = draw_data->CmdLists[x];
+            ImDrawList* list = m_lists[x];
+            copy_buffer(list->CmdBuffer, source->CmdBuffer);
+            copy_buffer(list->IdxBuffer, source->IdxBuffer);
+            copy_buffer(list->VtxBuffer, source->VtxBuffer);
+            list->Flags = source->Flags;
+            m_draw_data->CmdLists.push_back(list);
+        }
+        m_draw_data->Valid = true;
+        m_draw_data->CmdListsCount = draw_data->CmdListsCount;
+        m_draw_data->TotalIdxCount = draw_data->TotalIdxCount;
+        m_draw_data->TotalVtxCount = draw_data->TotalVtxCount;
+        m_draw_data->DisplayPos = draw_data->DisplayPos;
+        m_draw_data->DisplaySize = draw_data->DisplaySize;
+        m_draw_data->FramebufferScale = draw_data->FramebufferScale;
+    }
+
+
+    ImDrawData* ui_draw_snapshot::get_draw_data() const { return m_valid ? m_draw_data : nullptr; }
+
+}
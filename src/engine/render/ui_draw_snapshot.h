@@ -0,0 +1,32 @@
+#pragma once
+
+struct ImDrawData;
+struct ImDrawList;
+
+
+namespace GLT::render {
+
+    // @brief Copy of the ImGui draw data of one frame. The main thread builds the next UI into the draw lists of ImGui
+    //        while the render thread draws this copy. Lists and their buffers are kept, once they are big enough capturing does not allocate
+    class ui_draw_snapshot {
+    public:
+
+        ui_draw_snapshot();
+        ~ui_draw_snapshot();
+
+        DELETE_COPY_CONSTRUCTOR(ui_draw_snapshot);
+
+        // @brief Copies the output of ImGui::Render()
+        void capture(const ImDrawData* draw_data);
+
+        // @brief Draw data pointing to the copied lists, nullptr if nothing was captured
+        ImDrawData* get_draw_data() const;
+
+    private:
+
+        std::vector<ImDrawList*>            m_lists{};
+        ImDrawData*                         m_draw_data = nullptr;
+        bool                                m_valid = false;
+    };
+
+}
@@ -8,5 +8,5 @@ int main(int argc, char* argv[]) {
     GLT::application app = GLT::application(argc, argv);
     app.run();
     
-    return EXIT_SUCCESS;
+    return app.get_exit_code();
 }
@@ -79,6 +79,8 @@ namespace GLT::factory::geometry {
         
         out_mesh->vertices.clear();
         out_mesh->indices.clear();
+        out_mesh->BVH_nodes.clear();                        // a BVH of the previous contents would be uploaded as is
+        out_mesh->triIdx.clear();
 
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(file_path.string(),
@@ -142,4 +144,15 @@ namespace GLT::factory::geometry {
         return true;
     }
 
+
+    jobs::task<ref<GLT::geometry::static_mesh>> load_mesh(const std::filesystem::path file_path) {
+
+        co_await jobs::on_worker();
+
+        ref<GLT::geometry::static_mesh> mesh = create_ref<GLT::geometry::static_mesh>();
+        VALIDATE(load_static_mesh(file_path, mesh), co_return nullptr, "", "Failed to import mesh [" << file_path.generic_string() << "]");
+        mesh->build_BVH(16);
+        co_return mesh;
+    }
+
 }
\ No newline at end of file
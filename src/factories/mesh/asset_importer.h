@@ -1,6 +1,7 @@
 #pragma once
 
 #include "geometry/static_mesh.h"
+#include "util/jobs/task.h"
 
 
 namespace GLT::factory::geometry {
@@ -9,4 +10,9 @@ namespace GLT::factory::geometry {
 
     bool load_static_mesh(const std::filesystem::path& file_path, ref<GLT::geometry::static_mesh> out_mesh);
 
+    // @brief Reads, imports, optimizes and builds the BVH of a new mesh on a worker of the job system, ready for upload_static_mesh().
+    //        The awaiting coroutine continues on that worker, co_await jobs::on_main_thread() before handing the mesh to the renderer
+    // @return The mesh, nullptr if the import failed
+    jobs::task<ref<GLT::geometry::static_mesh>> load_mesh(const std::filesystem::path file_path);
+
 }
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <bit>
+#include <smmintrin.h>
+
+#include "static_mesh.h"
+#include "intersection.h"
+
+
+// Packet BVH traversal kernels used by [ray_query.cpp] and the benchmarks.
+// A kernel is selected at compile time from three policies:
+//   query   - what to search for (closest hit, any hit, occlusion) and how to order children
+//   leaf    - how the rays of a packet are tested against one triangle
+//   stats   - optional counters, [no_stats] compiles away completely
+// Every combination is its own instantiation, so the inner loop contains no runtime branches on the query kind.
+namespace GLT::geometry::traversal {
+
+    constexpr u32 PACKET_SIZE = 4;
+    constexpr u32 MAX_STACK_DEPTH = 64;
+
+    // 4 rays in SoA layout, lanes without a ray have [t_max] < [t_min] and never hit anything
+    // [t_max] shrinks to the closest hit found so far
+    struct ray_packet : intersection::ray_block<math::simd::SSE> {
+        __m128  u;
+        __m128  v;
+        __m128i triangle_id;
+        int     active_mask;                // bit per lane still searching
+    };
+
+    // ==================================================== query policies ====================================================
+
+    enum class child_order : u8 {
+        entry_distance,                     // test both children, visit the one the packet enters first (best for closest hit)
+        ray_direction,                      // project the child center offset onto the packet direction, no extra box tests
+    };
+
+    struct closest_hit {
+        static constexpr bool               record_hit = true;
+        static constexpr bool               terminate_on_hit = false;
+        static constexpr child_order        order = child_order::entry_distance;
+    };
+
+    struct any_hit {
+        static constexpr bool               record_hit = true;
+        static constexpr bool               terminate_on_hit = true;
+        static constexpr child_order        order = child_order::entry_distance;
+    };
+
+    struct occlusion {
+        static constexpr bool               record_hit = false;
+        static constexpr bool               terminate_on_hit = true;
+        static constexpr child_order        order = child_order::ray_direction;
+    };
+
+    template<typename T>
+    concept query_policy = requires {
+        { T::record_hit } -> std::convertible_to<bool>;
+        { T::terminate_on_hit } -> std::convertible_to<bool>;
+        { T::order } -> std::convertible_to<child_order>;
+    };
+
+    // ==================================================== leaf strategies ====================================================
+    // Any triangle kernel from [intersection.h] instantiated with [math::simd::SSE], see the [intersection_kernels] benchmark for the comparison.
+    // [watertight] is the default: as fast as Möller-Trumbore in SSE, but rays through shared edges/vertices never slip between two triangles.
+
+    // ==================================================== statistics ====================================================
+
+    // Every worker thread counts into its own collector made by fork(), the caller merge()s them when the batch is done
+
+    // @brief Default collector, every call is empty and removed by the optimizer
+    struct no_stats {
+        FORCEINLINE void begin_packet(const u64 /*first_ray*/) {}
+        FORCEINLINE void node_visited(const int /*lane_mask*/) {}
+        FORCEINLINE void triangle_tested(const int /*lane_mask*/) {}
+        FORCEINLINE no_stats fork() const { return {}; }
+        FORCEINLINE void merge(const no_stats& /*other*/) {}
+    };
+
+    // @brief Counts per ray (not per packet) how many nodes and triangles were tested
+    struct counting_stats {
+        u64                                 nodes_visited = 0;
+        u64                                 triangles_tested = 0;
+
+        FORCEINLINE void begin_packet(const u64 /*first_ray*/) {}
+        FORCEINLINE void node_visited(const int lane_mask)      { nodes_visited += std::popcount(static_cast<u32>(lane_mask)); }
+        FORCEINLINE void triangle_tested(const int lane_mask)   { triangles_tested += std::popcount(static_cast<u32>(lane_mask)); }
+        FORCEINLINE counting_stats fork() const { return {}; }
+        FORCEINLINE void merge(const counting_stats& other)     { nodes_visited += other.nodes_visited; triangles_tested += other.triangles_tested; }
+    };
+
+    // @brief [counting_stats] that also adds the work of every lane to the cost of its ray (heatmaps), workers write disjoint entries of [ray_cost]
+    struct per_ray_stats : counting_stats {
+        std::span<u32>                      ray_cost{};
+        u64                                 first_ray = 0;
+
+        FORCEINLINE void begin_packet(const u64 first)          { first_ray = first; }
+        FORCEINLINE void node_visited(const int lane_mask)      { counting_stats::node_visited(lane_mask); add_cost(lane_mask); }
+        FORCEINLINE void triangle_tested(const int lane_mask)   { counting_stats::triangle_tested(lane_mask); add_cost(lane_mask); }
+        FORCEINLINE per_ray_stats fork() const { return per_ray_stats{ {}, ray_cost, 0 }; }
+        FORCEINLINE void merge(const per_ray_stats& other)      { counting_stats::merge(other); }
+
+        FORCEINLINE void add_cost(const int lane_mask) {
+            for (u32 lane = 0; lane < PACKET_SIZE; lane++)
+                if (lane_mask & (1 << lane))                    // only lanes holding a ray are ever active
+                    ray_cost[first_ray + lane]++;
+        }
+    };
+
+    // ==================================================== kernel ====================================================
+
+    // @brief Slab test of all 4 rays against one AABB (precomputed inverse direction, the fastest exact variant in the [intersection_kernels] benchmark)
+    // @return lane mask of active rays entering the box before their current [t_max], [entry] receives the entry distances
+    static FORCEINLINE int intersect_AABB(const ray_packet& packet, const BVH_node& node, __m128& entry) {
+
+        return _mm_movemask_ps(intersection::slab_min_max<math::simd::SSE>(packet, node.AABB_min, node.AABB_max, entry)) & packet.active_mask;
+    }
+
+    // @brief intersect_AABB() counted as one visited node of every active lane, kernels test every box through it so [nodes_visited] means the same for all queries
+    template<typename stats>
+    static FORCEINLINE int visit_node(const ray_packet& packet, const BVH_node& node, __m128& entry, stats& collector) {
+
+        collector.node_visited(packet.active_mask);
+        return intersect_AABB(packet, node, entry);
+    }
+
+    static FORCEINLINE f32 nearest_active_entry(const __m128 entry, const int mask) {
+
+        alignas(16) f32 values[PACKET_SIZE];
+        _mm_store_ps(values, entry);
+        f32 nearest = 1e30f;
+        for (u32 lane = 0; lane < PACKET_SIZE; lane++)
+            if (mask & (1 << lane))
+                nearest = math::min(nearest, values[lane]);
+        return nearest;
+    }
+
+    // @brief Traverses the BVH of [mesh] with one packet
+    // @param [packet_dir] Sum of the packet directions, only used with [child_order::ray_direction]
+    // @return lane mask of rays that hit anything
+    template<query_policy query, typename leaf = intersection::watertight<math::simd::SSE>, typename stats = no_stats>
+    int traverse(const static_mesh& mesh, ray_packet& packet, const glm::vec3& packet_dir, stats& collector) {
+
+        const int valid_mask = packet.active_mask;
+        int hit_lanes = 0;
+        __m128 entry;
+        const int root_lanes = visit_node(packet, mesh.BVH_nodes[0], entry, collector);
+        if (!root_lanes)
+            return 0;
+
+        // every box is tested once, before it is pushed. entry_distance keeps the lanes that entered it and their entry distance next to the node,
+        // so a pop only compares them against [t_max] which may have shrunk since the push
+        const typename leaf::prepared prepared = leaf::prepare(packet);
+        u32 stack[MAX_STACK_DEPTH];
+        __m128 stack_entry[MAX_STACK_DEPTH];
+        int stack_lanes[MAX_STACK_DEPTH];
+        u32 ptr = 0;
+        stack_entry[ptr] = entry;
+        stack_lanes[ptr] = root_lanes;
+        stack[ptr++] = 0;
+        while (ptr > 0) {
+
+            const BVH_node& node = mesh.BVH_nodes[stack[--ptr]];
+            if constexpr (query::order == child_order::entry_distance) {
+
+                if (!(_mm_movemask_ps(_mm_cmple_ps(stack_entry[ptr], packet.t_max)) & stack_lanes[ptr] & packet.active_mask))
+                    continue;
+            }
+
+            if (node.is_leaf()) {
+
+                for (u32 i = 0; i < node.tri_count; i++) {
+
+                    const u32 triangle_id = mesh.triIdx[node.first_tri_index + i];
+                    __m128 t, u, v;
+                    collector.triangle_tested(packet.active_mask);
+                    const __m128 mask = leaf::intersect(prepared, packet,
+                        mesh.vertices[mesh.indices[triangle_id * 3]].position,
+                        mesh.vertices[mesh.indices[triangle_id * 3 + 1]].position,
+                        mesh.vertices[mesh.indices[triangle_id * 3 + 2]].position, t, u, v);
+
+                    const int hit_mask = _mm_movemask_ps(mask) & packet.active_mask;
+                    if (!hit_mask)
+                        continue;
+
+                    hit_lanes |= hit_mask;
+                    if constexpr (query::record_hit) {
+                        packet.t_max = _mm_blendv_ps(packet.t_max, t, mask);
+                        packet.u = _mm_blendv_ps(packet.u, u, mask);
+                        packet.v = _mm_blendv_ps(packet.v, v, mask);
+                        packet.triangle_id = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(packet.triangle_id), _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(triangle_id))), mask));
+                    }
+
+                    if constexpr (query::terminate_on_hit) {
+                        packet.active_mask &= ~hit_mask;                        // lane is done, keep its hit
+                        if (!packet.active_mask)
+                            return valid_mask;
+                    }
+                }
+                continue;
+            }
+
+            // both children may be pushed, a degenerate BVH deeper than the stack ends the packet instead of overflowing it
+            VALIDATE_S(ptr + 2 <= MAX_STACK_DEPTH, return hit_lanes & valid_mask);
+
+            if constexpr (query::order == child_order::entry_distance) {
+
+                // visit the child the packet enters first, push the other one below it
+                const auto push = [&](const u32 child, const __m128 child_entry, const int child_lanes) {
+                    stack_entry[ptr] = child_entry;
+                    stack_lanes[ptr] = child_lanes;
+                    stack[ptr++] = child;
+                };
+                __m128 entry_left, entry_right;
+                const int mask_left = visit_node(packet, mesh.BVH_nodes[node.left_node], entry_left, collector);
+                const int mask_right = visit_node(packet, mesh.BVH_nodes[node.left_node + 1], entry_right, collector);
+                if (mask_left && mask_right) {
+
+                    if (nearest_active_entry(entry_left, mask_left) <= nearest_active_entry(entry_right, mask_right)) {
+                        push(node.left_node + 1, entry_right, mask_right);
+                        push(node.left_node, entry_left, mask_left);
+                    } else {
+                        push(node.left_node, entry_left, mask_left);
+                        push(node.left_node + 1, entry_right, mask_right);
+                    }
+
+                } else if (mask_left)
+                    push(node.left_node, entry_left, mask_left);
+                else if (mask_right)
+                    push(node.left_node + 1, entry_right, mask_right);
+
+            } else {
+
+                // children are tested once before being pushed, the far one goes below the near one
+                const BVH_node& left = mesh.BVH_nodes[node.left_node];
+                const BVH_node& right = mesh.BVH_nodes[node.left_node + 1];
+                const bool left_first = glm::dot((right.AABB_min + right.AABB_max) - (left.AABB_min + left.AABB_max), packet_dir) >= 0.f;
+                const u32 near_child = left_first ? node.left_node : node.left_node + 1;
+                const u32 far_child = left_first ? node.left_node + 1 : node.left_node;
+                if (visit_node(packet, mesh.BVH_nodes[far_child], entry, collector))
+                    stack[ptr++] = far_child;
+                if (visit_node(packet, mesh.BVH_nodes[near_child], entry, collector))
+                    stack[ptr++] = near_child;
+            }
+        }
+        return hit_lanes & valid_mask;
+    }
+
+}
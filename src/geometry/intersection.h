@@ -0,0 +1,272 @@
+#pragma once
+
+#include "util/math/simd.h"
+
+
+// Ray-triangle and ray-AABB kernels, written once against the traits in [util/math/simd.h].
+// [S::width] rays (SoA in a ray_block) are tested against one triangle/box, which matches the packet traversal in [BVH_traversal.h].
+// The same templates compile to scalar float, scalar double (used as reference by the benchmark), SSE4.1 and AVX2.
+// Triangle kernels share one interface so they can be used as leaf strategy:
+//      prepared prepare(const ray_block<S>&)                       once per ray block
+//      mask intersect(prepared, block, p0, p1, p2, t, u, v)        [u]/[v] are the weights of p1/p2, result is inside (t_min, t_max)
+namespace GLT::geometry::intersection {
+
+    template<typename S>
+    using vec3 = glm::vec<3, typename S::scalar_type>;
+
+    template<typename S>
+    struct ray_block {
+        typename S::type                    origin[3];
+        typename S::type                    dir[3];
+        typename S::type                    inv_dir[3];             // precomputed once, the AABB tests only multiply
+        typename S::mask                    dir_negative[3];        // precomputed sign, selects the near/far slab without min/max
+        typename S::type                    t_min;
+        typename S::type                    t_max;
+    };
+
+    // @brief Fills the precomputed members from origin/dir
+    template<typename S>
+    FORCEINLINE void finalize(ray_block<S>& block) {
+
+        for (u32 axis = 0; axis < 3; axis++) {
+            block.inv_dir[axis] = S::div(S::set1(1), block.dir[axis]);
+            block.dir_negative[axis] = S::lt(block.dir[axis], S::zero());
+        }
+    }
+
+    template<typename S>
+    FORCEINLINE typename S::type dot(const typename S::type a[3], const typename S::type b[3]) { return S::add(S::add(S::mul(a[0], b[0]), S::mul(a[1], b[1])), S::mul(a[2], b[2])); }
+
+    template<typename S>
+    FORCEINLINE void cross(const typename S::type a[3], const typename S::type b[3], typename S::type result[3]) {
+
+        result[0] = S::sub(S::mul(a[1], b[2]), S::mul(a[2], b[1]));
+        result[1] = S::sub(S::mul(a[2], b[0]), S::mul(a[0], b[2]));
+        result[2] = S::sub(S::mul(a[0], b[1]), S::mul(a[1], b[0]));
+    }
+
+    template<typename S>
+    FORCEINLINE void broadcast(const vec3<S>& value, typename S::type result[3]) {
+
+        result[0] = S::set1(value.x);
+        result[1] = S::set1(value.y);
+        result[2] = S::set1(value.z);
+    }
+
+    // ==================================================== triangle kernels ====================================================
+
+    // @brief Möller-Trumbore, same math and epsilon as the fragment ray tracer
+    template<typename S>
+    struct moller_trumbore {
+
+        struct prepared {};
+        static FORCEINLINE prepared prepare(const ray_block<S>&) { return {}; }
+
+        static FORCEINLINE typename S::mask intersect(const prepared&, const ray_block<S>& block, const vec3<S>& p0, const vec3<S>& p1, const vec3<S>& p2, typename S::type& t, typename S::type& u, typename S::type& v) {
+
+            using type = typename S::type;
+            type e1[3], e2[3], v0[3], h[3], s[3], q[3];
+            broadcast<S>(p1 - p0, e1);
+            broadcast<S>(p2 - p0, e2);
+            broadcast<S>(p0, v0);
+
+            cross<S>(block.dir, e2, h);
+            const type a = dot<S>(e1, h);
+            const type f = S::div(S::set1(1), a);
+            for (u32 axis = 0; axis < 3; axis++)
+                s[axis] = S::sub(block.origin[axis], v0[axis]);
+
+            u = S::mul(f, dot<S>(s, h));
+            cross<S>(s, e1, q);
+            v = S::mul(f, dot<S>(block.dir, q));
+            t = S::mul(f, dot<S>(e2, q));
+
+            typename S::mask mask = S::ge(S::abs(a), S::set1(static_cast<typename S::scalar_type>(1e-4)));
+            mask = S::mask_and(mask, S::ge(u, S::zero()));
+            mask = S::mask_and(mask, S::ge(v, S::zero()));
+            mask = S::mask_and(mask, S::le(S::add(u, v), S::set1(1)));
+            mask = S::mask_and(mask, S::gt(t, block.t_min));
+            return S::mask_and(mask, S::lt(t, block.t_max));
+        }
+    };
+
+    // @brief Signed volumes (Plücker inner products) of the ray against the three edges, hit if all have the same sign
+    template<typename S>
+    struct plucker {
+
+        struct prepared {};
+        static FORCEINLINE prepared prepare(const ray_block<S>&) { return {}; }
+
+        static FORCEINLINE typename S::mask intersect(const prepared&, const ray_block<S>& block, const vec3<S>& p0, const vec3<S>& p1, const vec3<S>& p2, typename S::type& t, typename S::type& u, typename S::type& v) {
+
+            using type = typename S::type;
+            type a[3], b[3], c[3], n[3], tmp[3];
+            broadcast<S>(p0, a);
+            broadcast<S>(p1, b);
+            broadcast<S>(p2, c);
+            broadcast<S>(glm::cross(p1 - p0, p2 - p0), n);
+            for (u32 axis = 0; axis < 3; axis++) {
+                a[axis] = S::sub(a[axis], block.origin[axis]);
+                b[axis] = S::sub(b[axis], block.origin[axis]);
+                c[axis] = S::sub(c[axis], block.origin[axis]);
+            }
+
+            cross<S>(c, b, tmp);
+            const type w0 = dot<S>(block.dir, tmp);                            // weight of p0
+            cross<S>(a, c, tmp);
+            const type w1 = dot<S>(block.dir, tmp);                            // weight of p1
+            cross<S>(b, a, tmp);
+            const type w2 = dot<S>(block.dir, tmp);                            // weight of p2
+
+            const type zero = S::zero();
+            const typename S::mask all_positive = S::mask_and(S::mask_and(S::ge(w0, zero), S::ge(w1, zero)), S::ge(w2, zero));
+            const typename S::mask all_negative = S::mask_and(S::mask_and(S::le(w0, zero), S::le(w1, zero)), S::le(w2, zero));
+            const type det = S::add(S::add(w0, w1), w2);
+            const type inv_det = S::div(S::set1(1), det);
+            u = S::mul(w1, inv_det);
+            v = S::mul(w2, inv_det);
+            t = S::div(dot<S>(n, a), dot<S>(n, block.dir));
+
+            typename S::mask mask = S::mask_and(S::mask_or(all_positive, all_negative), S::neq(det, zero));
+            mask = S::mask_and(mask, S::gt(t, block.t_min));
+            return S::mask_and(mask, S::lt(t, block.t_max));
+        }
+    };
+
+    // @brief Watertight test (Woop, Benthin, Wald 2013): vertices are sheared into ray space, edges shared by two triangles never leak
+    template<typename S>
+    struct watertight {
+
+        using type = typename S::type;
+        using mask = typename S::mask;
+
+        // per lane axis permutation (kz = dominant direction axis) and shear constants
+        struct prepared {
+            mask                            kx_is_x, kx_is_y;
+            mask                            ky_is_x, ky_is_y;
+            mask                            kz_is_x, kz_is_y;
+            type                            shear_x, shear_y, shear_z;
+            type                            origin_kx, origin_ky, origin_kz;
+        };
+
+        static FORCEINLINE type pick(const type values[3], const mask is_x, const mask is_y) { return S::select(S::select(values[2], values[1], is_y), values[0], is_x); }
+
+        static FORCEINLINE prepared prepare(const ray_block<S>& block) {
+
+            prepared result{};
+            const type abs_x = S::abs(block.dir[0]);
+            const type abs_y = S::abs(block.dir[1]);
+            const type abs_z = S::abs(block.dir[2]);
+            result.kz_is_x = S::mask_and(S::ge(abs_x, abs_y), S::ge(abs_x, abs_z));
+            result.kz_is_y = S::mask_and(S::mask_not(result.kz_is_x), S::ge(abs_y, abs_z));
+            const mask kz_is_z = S::mask_not(S::mask_or(result.kz_is_x, result.kz_is_y));
+
+            // kx = kz + 1, ky = kx + 1 (mod 3), swapped if the ray points along negative kz to keep the winding
+            mask kx_is_x = kz_is_z, kx_is_y = result.kz_is_x;
+            mask ky_is_x = result.kz_is_y, ky_is_y = kz_is_z;
+            const mask swap = S::lt(pick(block.dir, result.kz_is_x, result.kz_is_y), S::zero());
+            result.kx_is_x = S::mask_select(kx_is_x, ky_is_x, swap);
+            result.kx_is_y = S::mask_select(kx_is_y, ky_is_y, swap);
+            result.ky_is_x = S::mask_select(ky_is_x, kx_is_x, swap);
+            result.ky_is_y = S::mask_select(ky_is_y, kx_is_y, swap);
+
+            const type dir_kz = pick(block.dir, result.kz_is_x, result.kz_is_y);
+            result.shear_x = S::div(pick(block.dir, result.kx_is_x, result.kx_is_y), dir_kz);
+            result.shear_y = S::div(pick(block.dir, result.ky_is_x, result.ky_is_y), dir_kz);
+            result.shear_z = S::div(S::set1(1), dir_kz);
+            result.origin_kx = pick(block.origin, result.kx_is_x, result.kx_is_y);
+            result.origin_ky = pick(block.origin, result.ky_is_x, result.ky_is_y);
+            result.origin_kz = pick(block.origin, result.kz_is_x, result.kz_is_y);
+            return result;
+        }
+
+        // vertex relative to the ray origin, sheared so the ray points along +z
+        static FORCEINLINE void transform(const prepared& ray, const vec3<S>& point, type& x, type& y, type& z) {
+
+            const type p[3] = { S::set1(point.x), S::set1(point.y), S::set1(point.z) };
+            const type p_kz = S::sub(pick(p, ray.kz_is_x, ray.kz_is_y), ray.origin_kz);
+            x = S::sub(S::sub(pick(p, ray.kx_is_x, ray.kx_is_y), ray.origin_kx), S::mul(ray.shear_x, p_kz));
+            y = S::sub(S::sub(pick(p, ray.ky_is_x, ray.ky_is_y), ray.origin_ky), S::mul(ray.shear_y, p_kz));
+            z = S::mul(ray.shear_z, p_kz);
+        }
+
+        static FORCEINLINE mask intersect(const prepared& ray, const ray_block<S>& block, const vec3<S>& p0, const vec3<S>& p1, const vec3<S>& p2, type& t, type& u, type& v) {
+
+            type ax, ay, az, bx, by, bz, cx, cy, cz;
+            transform(ray, p0, ax, ay, az);
+            transform(ray, p1, bx, by, bz);
+            transform(ray, p2, cx, cy, cz);
+
+            const type w0 = S::sub(S::mul(cx, by), S::mul(cy, bx));          // weight of p0
+            const type w1 = S::sub(S::mul(ax, cy), S::mul(ay, cx));          // weight of p1
+            const type w2 = S::sub(S::mul(bx, ay), S::mul(by, ax));          // weight of p2
+
+            const type zero = S::zero();
+            const mask all_positive = S::mask_and(S::mask_and(S::ge(w0, zero), S::ge(w1, zero)), S::ge(w2, zero));
+            const mask all_negative = S::mask_and(S::mask_and(S::le(w0, zero), S::le(w1, zero)), S::le(w2, zero));
+            const type det = S::add(S::add(w0, w1), w2);
+            const type inv_det = S::div(S::set1(1), det);
+            u = S::mul(w1, inv_det);
+            v = S::mul(w2, inv_det);
+            t = S::mul(S::add(S::add(S::mul(w0, az), S::mul(w1, bz)), S::mul(w2, cz)), inv_det);
+
+            mask result = S::mask_and(S::mask_or(all_positive, all_negative), S::neq(det, zero));
+            result = S::mask_and(result, S::gt(t, block.t_min));
+            return S::mask_and(result, S::lt(t, block.t_max));
+        }
+    };
+
+    // ==================================================== AABB kernels ====================================================
+    // All return the lanes whose [t_min, t_max] interval overlaps the box, [entry] receives the entry distance
+
+    // @brief Reference slab test, divides by the direction for every box (what the fragment shader does)
+    template<typename S>
+    FORCEINLINE typename S::mask slab_divide(const ray_block<S>& block, const vec3<S>& aabb_min, const vec3<S>& aabb_max, typename S::type& entry) {
+
+        typename S::type t_near = block.t_min, t_far = block.t_max;
+        for (u32 axis = 0; axis < 3; axis++) {
+
+            const typename S::type t0 = S::div(S::sub(S::set1(aabb_min[axis]), block.origin[axis]), block.dir[axis]);
+            const typename S::type t1 = S::div(S::sub(S::set1(aabb_max[axis]), block.origin[axis]), block.dir[axis]);
+            t_near = S::max(t_near, S::min(t0, t1));
+            t_far = S::min(t_far, S::max(t0, t1));
+        }
+        entry = t_near;
+        return S::le(t_near, t_far);
+    }
+
+    // @brief Slab test with precomputed inverse direction, near/far per axis via min/max
+    template<typename S>
+    FORCEINLINE typename S::mask slab_min_max(const ray_block<S>& block, const vec3<S>& aabb_min, const vec3<S>& aabb_max, typename S::type& entry) {
+
+        typename S::type t_near = block.t_min, t_far = block.t_max;
+        for (u32 axis = 0; axis < 3; axis++) {
+
+            const typename S::type t0 = S::mul(S::sub(S::set1(aabb_min[axis]), block.origin[axis]), block.inv_dir[axis]);
+            const typename S::type t1 = S::mul(S::sub(S::set1(aabb_max[axis]), block.origin[axis]), block.inv_dir[axis]);
+            t_near = S::max(t_near, S::min(t0, t1));
+            t_far = S::min(t_far, S::max(t0, t1));
+        }
+        entry = t_near;
+        return S::le(t_near, t_far);
+    }
+
+    // @brief Slab test with precomputed inverse direction and sign, the near plane is selected instead of sorted
+    template<typename S>
+    FORCEINLINE typename S::mask slab_sign(const ray_block<S>& block, const vec3<S>& aabb_min, const vec3<S>& aabb_max, typename S::type& entry) {
+
+        typename S::type t_near = block.t_min, t_far = block.t_max;
+        for (u32 axis = 0; axis < 3; axis++) {
+
+            const typename S::type low = S::set1(aabb_min[axis]);
+            const typename S::type high = S::set1(aabb_max[axis]);
+            const typename S::type near_plane = S::select(low, high, block.dir_negative[axis]);
+            const typename S::type far_plane = S::select(high, low, block.dir_negative[axis]);
+            t_near = S::max(t_near, S::mul(S::sub(near_plane, block.origin[axis]), block.inv_dir[axis]));
+            t_far = S::min(t_far, S::mul(S::sub(far_plane, block.origin[axis]), block.inv_dir[axis]));
+        }
+        entry = t_near;
+        return S::le(t_near, t_far);
+    }
+
+}
@@ -0,0 +1,214 @@
+
+#include "util/pch.h"
+
+#include "util/jobs/job_system.h"
+
+#include "static_mesh.h"
+#include "BVH_traversal.h"
+
+#include "ray_query.h"
+
+
+namespace GLT::geometry {
+
+    using namespace traversal;
+
+    constexpr u32 PACKETS_PER_TASK = 64;
+
+    static ray_packet load_packet(std::span<const ray> rays, const u64 first) {
+
+        alignas(16) f32 o[3][PACKET_SIZE], d[3][PACKET_SIZE], t_min[PACKET_SIZE], t_max[PACKET_SIZE];
+        int active_mask = 0;
+        for (u32 lane = 0; lane < PACKET_SIZE; lane++) {
+
+            const bool valid = (first + lane) < rays.size();
+            const ray& r = valid ? rays[first + lane] : rays[first];
+            for (u32 axis = 0; axis < 3; axis++) {
+                o[axis][lane] = r.origin[axis];
+                d[axis][lane] = r.direction[axis];
+            }
+            t_min[lane] = r.t_min;
+            t_max[lane] = valid ? r.t_max : -1.f;
+            active_mask |= valid ? (1 << lane) : 0;
+        }
+
+        ray_packet packet{};
+        for (u32 axis = 0; axis < 3; axis++) {
+            packet.origin[axis] = _mm_load_ps(o[axis]);
+            packet.dir[axis] = _mm_load_ps(d[axis]);
+        }
+        packet.t_min = _mm_load_ps(t_min);
+        packet.t_max = _mm_load_ps(t_max);
+        intersection::finalize(packet);
+        packet.u = _mm_setzero_ps();
+        packet.v = _mm_setzero_ps();
+        packet.triangle_id = _mm_set1_epi32(static_cast<int>(INVALID_TRIANGLE_ID));
+        packet.active_mask = active_mask;
+        return packet;
+    }
+
+    static void store_packet(const ray_packet& packet, std::span<ray_hit> hits, const u64 first) {
+
+        alignas(16) f32 t[PACKET_SIZE], u[PACKET_SIZE], v[PACKET_SIZE];
+        alignas(16) u32 id[PACKET_SIZE];
+        _mm_store_ps(t, packet.t_max);
+        _mm_store_ps(u, packet.u);
+        _mm_store_ps(v, packet.v);
+        _mm_store_si128(reinterpret_cast<__m128i*>(id), packet.triangle_id);
+        for (u32 lane = 0; lane < PACKET_SIZE && (first + lane) < hits.size(); lane++) {
+
+            ray_hit& hit = hits[first + lane];
+            hit.triangle_id = id[lane];
+            hit.t = hit.is_hit() ? t[lane] : 1e30f;
+            hit.barycentrics = hit.is_hit() ? glm::vec2(u[lane], v[lane]) : glm::vec2(0.f);
+        }
+    }
+
+    static glm::vec3 sum_directions(std::span<const ray> rays, const u64 first) {
+
+        glm::vec3 packet_dir{0.f};
+        for (u64 x = first; x < first + PACKET_SIZE && x < rays.size(); x++)
+            packet_dir += rays[x].direction;
+        return packet_dir;
+    }
+
+    template<query_policy query, typename stats>
+    static void intersect_packets(const static_mesh& mesh, std::span<const ray> rays, std::span<ray_hit> hits, const u64 first_packet, const u64 end_packet, stats& collector) {
+
+        for (u64 x = first_packet; x < end_packet; x++) {
+
+            ray_packet packet = load_packet(rays, x * PACKET_SIZE);
+            collector.begin_packet(x * PACKET_SIZE);
+            traverse<query>(mesh, packet, glm::vec3(0.f), collector);
+            store_packet(packet, hits, x * PACKET_SIZE);
+        }
+    }
+
+    template<typename stats>
+    static void occluded_packets(const static_mesh& mesh, std::span<const ray> rays, std::span<u8> occluded, const u64 first_packet, const u64 end_packet, stats& collector) {
+
+        for (u64 x = first_packet; x < end_packet; x++) {
+
+            const u64 first = x * PACKET_SIZE;
+            ray_packet packet = load_packet(rays, first);
+            collector.begin_packet(first);
+            const int occluded_mask = traverse<occlusion>(mesh, packet, sum_directions(rays, first), collector);
+            for (u32 lane = 0; lane < PACKET_SIZE && (first + lane) < occluded.size(); lane++)
+                occluded[first + lane] = (occluded_mask >> lane) & 1;
+        }
+    }
+
+    // @brief Calls [process(first_packet, end_packet, collector)] for all packets of a batch, small batches stay on the calling thread.
+    //        Every thread counts into its own collector, they are merged into [result] at the end.
+    template<typename stats, typename func>
+    static void for_each_packet(const u64 ray_count, stats& result, func&& process) {
+
+        const u64 packet_count = (ray_count + PACKET_SIZE - 1) / PACKET_SIZE;
+        const u32 thread_count = jobs::get_thread_count();
+        if (ray_count < PARALLEL_QUERY_THRESHOLD || thread_count == 1) {
+            process(0, packet_count, result);
+            return;
+        }
+
+        std::atomic<u64> next_packet = 0;
+        std::mutex result_mutex{};
+        const auto worker = [&]() {
+
+            stats collector = result.fork();
+            for (u64 first = next_packet.fetch_add(PACKETS_PER_TASK); first < packet_count; first = next_packet.fetch_add(PACKETS_PER_TASK))
+                process(first, math::min(first + PACKETS_PER_TASK, packet_count), collector);
+
+            if constexpr (!std::is_same_v<stats, no_stats>) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result.merge(collector);
+            }
+        };
+
+        // one job per thread of the job system, the calling thread helps
+        jobs::parallel_for(thread_count, 1, [&](const u64 first, const u64 end) {
+            for (u64 x = first; x < end; x++)
+                worker();
+        });
+    }
+
+    // @brief Picks the counting statistics collector if [stats] is requested, without them the kernels are instantiated with [no_stats] and count nothing
+    template<typename func>
+    static void dispatch_stats(const u64 ray_count, traversal_stats* stats, func&& run) {
+
+        if (stats) {
+
+            const auto collect = [&]<typename stats_type>(stats_type collector) {
+                run(collector);
+                stats->rays += ray_count;
+                stats->nodes_visited += collector.nodes_visited;
+                stats->triangles_tested += collector.triangles_tested;
+            };
+            if (stats->ray_cost.empty())
+                collect(counting_stats{});
+            else
+                collect(per_ray_stats{ {}, stats->ray_cost, 0 });
+            return;
+        }
+        no_stats collector{};
+        run(collector);
+    }
+
+    // ================================================== public ==================================================
+
+    void intersect(const static_mesh& mesh, std::span<const ray> rays, std::span<ray_hit> hits, const query_type type, traversal_stats* stats) {
+
+        PROFILE_FUNCTION();
+
+        VALIDATE(rays.size() == hits.size(), return, "", "Ray count [" << rays.size() << "] does not match hit count [" << hits.size() << "]");
+        VALIDATE(!stats || stats->ray_cost.empty() || stats->ray_cost.size() == rays.size(), return, "", "Ray count [" << rays.size() << "] does not match ray cost count [" << stats->ray_cost.size() << "]");
+        if (rays.empty())
+            return;
+
+        if (mesh.BVH_nodes.empty()) {
+            std::fill(hits.begin(), hits.end(), ray_hit{});
+            return;
+        }
+
+        dispatch_stats(rays.size(), stats, [&]<typename stats_type>(stats_type& collector) {
+
+            if (type == query_type::any_hit)
+                for_each_packet(rays.size(), collector, [&](const u64 first, const u64 end, stats_type& local) { intersect_packets<any_hit>(mesh, rays, hits, first, end, local); });
+            else
+                for_each_packet(rays.size(), collector, [&](const u64 first, const u64 end, stats_type& local) { intersect_packets<closest_hit>(mesh, rays, hits, first, end, local); });
+        });
+    }
+
+    ray_hit intersect(const static_mesh& mesh, const ray& query_ray, const query_type type) {
+
+        ray_hit hit{};
+        intersect(mesh, std::span<const ray>(&query_ray, 1), std::span<ray_hit>(&hit, 1), type);
+        return hit;
+    }
+
+    void occluded(const static_mesh& mesh, std::span<const ray> rays, std::span<u8> occluded, traversal_stats* stats) {
+
+        PROFILE_FUNCTION();
+
+        VALIDATE(rays.size() == occluded.size(), return, "", "Ray count [" << rays.size() << "] does not match result count [" << occluded.size() << "]");
+        VALIDATE(!stats || stats->ray_cost.empty() || stats->ray_cost.size() == rays.size(), return, "", "Ray count [" << rays.size() << "] does not match ray cost count [" << stats->ray_cost.size() << "]");
+        if (rays.empty())
+            return;
+
+        if (mesh.BVH_nodes.empty()) {
+            std::fill(occluded.begin(), occluded.end(), 0);
+            return;
+        }
+
+        dispatch_stats(rays.size(), stats, [&]<typename stats_type>(stats_type& collector) {
+            for_each_packet(rays.size(), collector, [&](const u64 first, const u64 end, stats_type& local) { occluded_packets(mesh, rays, occluded, first, end, local); });
+        });
+    }
+
+    bool occluded(const static_mesh& mesh, const ray& query_ray) {
+
+        u8 result = 0;
+        occluded(mesh, std::span<const ray>(&query_ray, 1), std::span<u8>(&result, 1));
+        return result != 0;
+    }
+
+}
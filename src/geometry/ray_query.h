@@ -0,0 +1,64 @@
+#pragma once
+
+
+namespace GLT::geometry {
+
+    struct static_mesh;
+
+    constexpr u32 INVALID_TRIANGLE_ID = std::numeric_limits<u32>::max();
+
+    struct ray {
+        glm::vec3   origin{0.f};
+        f32         t_min = 1e-4f;          // same epsilon as the fragment ray tracer to avoid self intersections
+        glm::vec3   direction{0.f, 0.f, 1.f};
+        f32         t_max = 1e30f;
+    };
+
+    struct ray_hit {
+        f32         t = 1e30f;
+        u32         triangle_id = INVALID_TRIANGLE_ID;     // index of the triangle in [static_mesh::indices] (vertices at [id * 3 + 0..2])
+        glm::vec2   barycentrics{0.f};                      // weights of vertex 1 and 2, vertex 0 has (1 - x - y)
+
+        FORCEINLINE bool is_hit() const { return triangle_id != INVALID_TRIANGLE_ID; }
+    };
+
+    // @brief Work done by a batch of queries, only counted for queries that get one
+    struct traversal_stats {
+        u64         rays = 0;
+        u64         nodes_visited = 0;              // AABB tests, counted per ray
+        u64         triangles_tested = 0;           // triangle tests, counted per ray
+        std::span<u32> ray_cost{};                  // optional, one entry per ray of the next batch, nodes + triangles of that ray are added to it (heatmaps)
+    };
+
+    enum class query_type : u8 {
+        closest_hit = 0,                    // nearest intersection in [t_min, t_max]
+        any_hit,                            // first intersection found in [t_min, t_max], t and barycentrics belong to that one
+    };
+
+    // @brief Intersects a batch of rays with the BVH of [mesh] (build_BVH() must have been called).
+    //        Rays are traced in SSE packets of 4, so neighbouring rays in [rays] should be coherent (same origin, similar direction) for best performance.
+    //        Batches with at least [PARALLEL_QUERY_THRESHOLD] rays are split over all hardware threads.
+    // @param [mesh] Mesh with an already built BVH
+    // @param [rays] Rays to trace, directions do not need to be normalized (t is measured in units of the direction)
+    // @param [hits] Receives one result per ray, must have the same size as [rays]
+    // @param [type] Search for the closest hit or stop at the first hit
+    // @param [stats] Optional, receives the accumulated traversal work
+    void intersect(const static_mesh& mesh, std::span<const ray> rays, std::span<ray_hit> hits, const query_type type = query_type::closest_hit, traversal_stats* stats = nullptr);
+
+    // @brief Convenience wrapper for a single ray, see intersect()
+    ray_hit intersect(const static_mesh& mesh, const ray& query_ray, const query_type type = query_type::closest_hit);
+
+    // @brief Occlusion query for shadow/visibility rays. Cheaper than intersect() with [query_type::any_hit]:
+    //        traversal stops at the first triangle in [t_min, t_max], no hit data is recorded and children are visited in ray-direction order.
+    // @param [mesh] Mesh with an already built BVH
+    // @param [rays] Rays to test, same packet/threading behaviour as intersect()
+    // @param [occluded] Receives 1 if something lies on the ray segment, 0 otherwise, must have the same size as [rays]
+    // @param [stats] Optional, receives the accumulated traversal work
+    void occluded(const static_mesh& mesh, std::span<const ray> rays, std::span<u8> occluded, traversal_stats* stats = nullptr);
+
+    // @brief Convenience wrapper for a single ray, see occluded()
+    bool occluded(const static_mesh& mesh, const ray& query_ray);
+
+    constexpr u64 PARALLEL_QUERY_THRESHOLD = 16384;
+
+}
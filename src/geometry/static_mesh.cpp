@@ -9,7 +9,7 @@ namespace GLT::geometry {
     struct TriAABB {
         glm::vec3 min, max;
     };
-    std::vector<TriAABB> triAABBs; // Cache triangle bounds
+    static thread_local std::vector<TriAABB> triAABBs; // Cache triangle bounds, per thread so meshes can be built on several workers at once
 
 
     void static_mesh::build_BVH(const u32 target_tri_count) {
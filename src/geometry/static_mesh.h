@@ -1,6 +1,5 @@
 #pragma once
 
-#include "engine/render/buffer.h"
 #include "BVH.h"
 
 
@@ -15,6 +14,15 @@ namespace GLT::geometry {
     };
     #pragma pack(pop)
 
+    // @brief Where a mesh lives in the shared buffers of the renderer's mesh pool (open_GL/mesh_pool.h), in elements of each array
+    struct GPU_mesh_range {
+        u32                         first_vertex = 0;
+        u32                         first_index = 0;
+        u32                         first_node = 0;
+        u32                         first_tri = 0;
+        bool                        resident = false;
+    };
+
     struct static_mesh {
         std::vector<vertex>         vertices{};
         std::vector<u32>            indices{};
@@ -24,13 +32,15 @@ namespace GLT::geometry {
         std::vector<BVH_node>       BVH_nodes;
         std::vector<u32>            triIdx;
 
-        GLT::render::buffer         vertex_buffer{GLT::render::buffer::type::VERTEX, GLT::render::buffer::usage::STATIC};
-        GLT::render::buffer         index_buffer{GLT::render::buffer::type::INDEX, GLT::render::buffer::usage::STATIC};
-        u32                         vao = 0;
-        u32                         vertex_ssbo = 0;
-        u32                         index_ssbo = 0;
-        u32                         bvh_ssbo = 0;
-        u32                         triidx_ssbo = 0;
+        // set by the mesh pool while the arrays are uploaded, the pool moves the ranges when it defragments
+        GPU_mesh_range              GPU_range{};
+
+        // @brief Bytes this mesh occupies in the shared GPU buffers
+        FORCEINLINE size_t get_GPU_memory_size() const {
+            if (!GPU_range.resident)
+                return 0;
+            return vertices.size() * sizeof(vertex) + indices.size() * sizeof(u32) + BVH_nodes.size() * sizeof(BVH_node) + triIdx.size() * sizeof(u32);
+        }
     
 #ifdef DEBUG
         // BVH Visualization parameters
@@ -15,11 +15,11 @@
 #include "layer/world_layer.h"
 #include "game_object/camera.h"
 #include "engine/render/renderer.h"
+#include "factories/mesh/asset_importer.h"
 
 #ifdef DEBUG
 	#include "geometry/BVH.h"
 	#include "geometry/static_mesh.h"
-	#include "factories/mesh/asset_importer.h"
 #endif
 
 #include "imgui_layer.h"
@@ -57,6 +57,20 @@ namespace GLT::UI {
 		return ImVec4{ vec_0.x * vec_1.x, vec_0.y * vec_1.y, vec_0.z * vec_1.z, vec_0.w * vec_1.w };
 	}
 
+	// import and BVH build run on a worker, the old mesh stays visible until the new one is swapped in on the main thread
+	static jobs::task<> replace_render_mesh(const std::filesystem::path mesh_path) {
+
+		ref<GLT::geometry::static_mesh> mesh = co_await GLT::factory::geometry::load_mesh(mesh_path);
+		co_await jobs::on_main_thread();
+		if (!mesh)
+			co_return;
+
+		application::get().get_renderer()->remove_static_mesh(application::get().get_world_layer()->GET_RENDER_MESH());
+		application::get().get_world_layer()->SET_RENDER_MESH(mesh);
+		application::get().get_renderer()->upload_static_mesh(mesh);
+		LOG(Trace, "Render mesh replaced with [" << mesh_path.generic_string() << "]")
+	}
+
 	void set_UI_theme_selection(theme_selection theme_selection) { UI_theme = theme_selection; }
 
 	//void save_UI_theme_data() {
@@ -218,8 +232,6 @@ namespace GLT::UI {
 		PROFILE_FUNCTION();
 		ImGui::SetCurrentContext(m_context);
 
-		static bool compile_result = true;
-		static std::string output{};
 		UI::set_next_window_pos(window_pos::top_left, 4.f);
 		ImGui::SetNextWindowBgAlpha(0.5f);
 		ImGui::Begin("Test", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize); {
@@ -227,13 +239,21 @@ namespace GLT::UI {
 			if (ImGui::CollapsingHeader("select shader to display")) {
 						
 				std::filesystem::path base_path = GLT::util::get_executable_path().parent_path() / "shaders";
-				show_directory_tree(base_path, ".frag", true, [this](const std::filesystem::path& shader_path) { compile_result = application::get().get_renderer()->reload_fragment_shader(shader_path, output); });
-				if (!compile_result) {
+				show_directory_tree(base_path, ".frag", true, [this](const std::filesystem::path& shader_path) {
+
+					auto renderer = application::get().get_renderer();
+					renderer->enqueue([renderer, shader_path] { std::string output{}; renderer->reload_fragment_shader(shader_path, output); });
+				});
+				const auto& shader_reload = application::get().get_renderer()->get_shader_reload_ref();
+				if (shader_reload.pending)
+					ImGui::TextDisabled("compiling [%s] ...", shader_reload.file.filename().string().c_str());
+
+				else if (!shader_reload.succeeded) {
 
 					ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.f, .2f, .2f, 1.f));
 					ImGui::SeparatorText("Compiler Error");
 					ImGui::PopStyleColor();
-					ImGui::Text("%s", output.c_str());
+					ImGui::Text("%s", shader_reload.output.c_str());
 				}
 			}
 
@@ -250,6 +270,68 @@ namespace GLT::UI {
 				}
 			}
 
+			if (ImGui::CollapsingHeader("Render resolution", ImGuiTreeNodeFlags_DefaultOpen)) {
+
+				auto& resolution_settings = application::get().get_renderer()->get_dynamic_resolution_ref().get_settings_ref();
+				auto& upscale = application::get().get_renderer()->get_upscale_ref();
+				if (UI::begin_table("render_resolution_settings", false, ImVec2(280.f, 0))) {
+
+					if (!resolution_settings.enabled)			// dynamic resolution picks the scale itself
+						UI::table_row_slider<f32>("render scale", resolution_settings.scale, render::dynamic_resolution::LOWEST_SCALE, render::dynamic_resolution::HIGHEST_SCALE);
+					if (upscale.mode == render::upscale_settings::filter::sharpen)
+						UI::table_row_slider<f32>("sharpness", upscale.sharpness, 0.f, 1.f);
+					UI::end_table();
+				}
+				static const char* filter_names[] = { "Bilinear", "Sharpen" };
+				int filter = static_cast<int>(upscale.mode);
+				if (ImGui::Combo("upscale filter", &filter, filter_names, IM_ARRAYSIZE(filter_names)))
+					upscale.mode = static_cast<render::upscale_settings::filter>(filter);
+			}
+
+			if (ImGui::CollapsingHeader("Hybrid rendering", ImGuiTreeNodeFlags_DefaultOpen)) {
+
+				auto& hybrid_rendering = application::get().get_renderer()->get_hybrid_rendering_ref();
+				ImGui::Checkbox("rasterize primary visibility", &hybrid_rendering.enabled);
+			}
+
+			if (ImGui::CollapsingHeader("Temporal reuse", ImGuiTreeNodeFlags_DefaultOpen)) {
+
+				auto& temporal_reuse = application::get().get_renderer()->get_temporal_reuse_ref();
+				ImGui::Checkbox("reuse last frame's hits", &temporal_reuse.enabled);
+				if (UI::begin_table("temporal_reuse_settings", false, ImVec2(280.f, 0))) {
+
+					UI::table_row_drag_scalar<u32>("refresh period", temporal_reuse.refresh_period, "%u frames", 1, 256);
+					UI::end_table();
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Soft shadows", ImGuiTreeNodeFlags_DefaultOpen)) {
+
+				auto& soft_shadows = application::get().get_renderer()->get_soft_shadows_ref();
+				if (UI::begin_table("soft_shadow_settings", false, ImVec2(280.f, 0))) {
+
+					UI::table_row_slider<f32>("light angle", soft_shadows.light_angle, 0.f, 45.f);
+					UI::table_row_drag_scalar<u32>("samples", soft_shadows.samples, "%u rays/pixel", 1, 256);
+					UI::end_table();
+				}
+				static const char* pattern_names[] = { "Owen-scrambled Sobol", "Blue noise" };
+				int pattern = static_cast<int>(soft_shadows.pattern);
+				if (ImGui::Combo("sample pattern", &pattern, pattern_names, IM_ARRAYSIZE(pattern_names)))
+					soft_shadows.pattern = static_cast<math::sampling::pattern>(pattern);
+				ImGui::Checkbox("any-hit shadow rays", &soft_shadows.any_hit);
+			}
+
+			if (ImGui::CollapsingHeader("Time slicing", ImGuiTreeNodeFlags_DefaultOpen)) {
+
+				auto& time_slicing = application::get().get_renderer()->get_time_slicing_ref();
+				ImGui::Checkbox("spread frames over several UI frames", &time_slicing.enabled);
+				if (UI::begin_table("time_slicing_settings", false, ImVec2(280.f, 0))) {
+
+					UI::table_row_drag_scalar<u32>("ray budget", time_slicing.ray_budget, "%u rays/frame", 1024, 1 << 24);
+					UI::end_table();
+				}
+			}
+
 			if (ImGui::CollapsingHeader("BVH data", ImGuiTreeNodeFlags_DefaultOpen)) {
 			
 				if (UI::begin_table("BVH Statistics", false, ImVec2(280.f, 0))) {
@@ -260,6 +342,7 @@ namespace GLT::UI {
 					UI::table_row_text("Leaf Nodes", "%d", mesh->bvh_leaf_count);
 					UI::table_row_text("Max Depth", "%d", mesh->bvh_max_depth);
 					UI::table_row_text("build time", "%f ms", mesh->BVH_build_time / 1000.f);
+					UI::table_row_text("GPU memory", "%.2f MiB", application::get().get_renderer()->get_general_performance_metrik_pointer()->mesh_GPU_memory / (1024.f * 1024.f));
 					UI::end_table();
 				}
 			}
@@ -267,15 +350,7 @@ namespace GLT::UI {
 			if (ImGui::CollapsingHeader("Select mesh", ImGuiTreeNodeFlags_DefaultOpen)) {
 			
 				std::filesystem::path base_path = GLT::util::get_executable_path().parent_path() / "assets" / "meshes";
-				show_directory_tree(base_path, ".glb", true, [this](const std::filesystem::path& mesh_path) { 
-					
-					ref<GLT::geometry::static_mesh> mesh = application::get().get_world_layer()->GET_RENDER_MESH();
-					application::get().get_renderer()->remove_static_mesh(mesh);
-
-					ASSERT(GLT::factory::geometry::load_static_mesh( mesh_path, mesh), "test mesh imported successfully", "Failed to import test mesh");
-					application::get().get_renderer()->upload_static_mesh(mesh);
-
-				});
+				show_directory_tree(base_path, ".glb", true, [](const std::filesystem::path& mesh_path) { jobs::spawn(replace_render_mesh(mesh_path)); });
 			}
 
 			if (ImGui::CollapsingHeader("BVH data", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -288,6 +363,7 @@ namespace GLT::UI {
 					UI::table_row_text("Leaf Nodes", "%d", mesh->bvh_leaf_count);
 					UI::table_row_text("Max Depth", "%d", mesh->bvh_max_depth);
 					UI::table_row_text("build time", "%f ms", mesh->BVH_build_time / 1000.f);
+					UI::table_row_text("GPU memory", "%.2f MiB", application::get().get_renderer()->get_general_performance_metrik_pointer()->mesh_GPU_memory / (1024.f * 1024.f));
 					UI::end_table();
 				}
 			}
@@ -300,7 +376,6 @@ namespace GLT::UI {
 
 	void imgui_layer::show_renderer_metrik() {
 
-#ifdef DEBUG								// renderer metrik is only collected in debug mode
 		if (!m_show_renderer_metrik)
 			return;
 
@@ -365,6 +440,10 @@ namespace GLT::UI {
 
 				UI::table_row_text("FPS", formatted_text);
 
+				const auto& resolution = application::get().get_renderer()->get_dynamic_resolution_ref();
+				if (resolution.get_settings().enabled || resolution.get_scale() != 1.f)
+					UI::table_row_text("render scale", "%3.0f %%", resolution.get_scale() * 100.f);
+
 				if (show_progress_bars) {
 					snprintf(formatted_text, sizeof(formatted_text), "%5.2f ms", m_work_time);
 					UI::table_row_progressbar("work time:", formatted_text, work_percent);
@@ -433,10 +512,64 @@ namespace GLT::UI {
 				// UI::table_row_text("pipline binding count", "%d", metrik->pipline_binding_count);
 				// UI::table_row_text("draw calls", "%d", metrik->draw_calls);
 				UI::table_row_text("vertices", "%d", metrik->vertices);
+				UI::table_row_text("traced pixels", "%u", metrik->traced_pixels);
+				UI::table_row_text("reused pixels", "%u", metrik->reused_pixels);
+				if (metrik->slice_count > 1)
+					UI::table_row_text("time slice", "%u / %u", metrik->slice_index + 1, metrik->slice_count);
+				UI::table_row_text("GPU trace", "%5.2f ms", metrik->GPU_trace_time);
+				UI::table_row_text("GPU upscale", "%5.2f ms", metrik->GPU_upscale_time);
+				UI::table_row_text("GPU UI", "%5.2f ms", metrik->GPU_UI_time);
+				UI::table_row_text("GPU present", "%5.2f ms", metrik->GPU_present_time);
 				
 				UI::end_table();
 			}
 
+			const auto& traversal_settings = application::get().get_renderer()->get_traversal_stats_ref();
+			if (traversal_settings.enabled) {
+
+				ImGui::SeparatorText("BVH Traversal");
+				if (UI::begin_table("Traversal Display", false, ImVec2(table_width, 0))) {
+
+					UI::table_row_text("rays", "%llu", static_cast<unsigned long long>(metrik->traversal.rays));
+					UI::table_row_text("nodes visited", "%llu", static_cast<unsigned long long>(metrik->traversal.nodes_visited));
+					UI::table_row_text("triangles tested", "%llu", static_cast<unsigned long long>(metrik->traversal.triangles_tested));
+					UI::end_table();
+				}
+
+				if (show_graphs) {
+
+					static const auto traced_rays_plot_col = ImVec4(1.f, 0.8f, 0.f, 1.00f);
+					static const auto nodes_plot_col = ImVec4(0.f, 0.9f, 1.f, 1.00f);
+					static const auto triangles_plot_col = ImVec4(1.f, 0.3f, 0.3f, 1.00f);
+
+					ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
+					ImGui::PushStyleColor(ImGuiCol_FrameBg, vector_multi(ImGui::GetStyleColorVec4(ImGuiCol_WindowBg), ImVec4{ 0, 0, 0, 0 }));
+
+					// rays get their own scale, the work per ray shares one
+					ImGui::PushStyleColor(ImGuiCol_PlotLines, traced_rays_plot_col);
+					ImGui::PlotLines("##metrik_traced_rays", metrik->traced_rays, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE, metrik->current_index, (const char*)0, 0.0f, math::max(1.f, math::calc_array_max(metrik->traced_rays, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE)), ImVec2(280, 50));
+					ImGui::PopStyleColor();
+
+					const f32 per_ray_max = math::max(1.f, math::max(math::calc_array_max(metrik->nodes_per_ray, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE), math::calc_array_max(metrik->triangles_per_ray, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE)));
+					const ImVec2 cursor_pos = ImGui::GetCursorPos();
+					ImGui::PushStyleColor(ImGuiCol_PlotLines, nodes_plot_col);
+					ImGui::PlotLines("##metrik_nodes_per_ray", metrik->nodes_per_ray, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE, metrik->current_index, (const char*)0, 0.0f, per_ray_max, ImVec2(280, 80));
+					ImGui::PopStyleColor();
+
+					ImGui::SetCursorPos(cursor_pos);
+					ImGui::PushStyleColor(ImGuiCol_PlotLines, triangles_plot_col);
+					ImGui::PlotLines("##metrik_triangles_per_ray", metrik->triangles_per_ray, GENERAL_PERFORMANCE_METRIK_ARRAY_SIZE, metrik->current_index, (const char*)0, 0.0f, per_ray_max, ImVec2(280, 80));
+					ImGui::PopStyleColor();
+
+					ImGui::PopStyleColor();
+					ImGui::PopStyleVar();
+
+					ImGui::TextColored(traced_rays_plot_col, "rays %8.1f k", metrik->traced_rays[metrik->current_index]);
+					ImGui::TextColored(nodes_plot_col, "nodes / ray %6.1f   (max %.1f)", metrik->nodes_per_ray[metrik->current_index], per_ray_max);
+					ImGui::TextColored(triangles_plot_col, "triangles / ray %6.1f", metrik->triangles_per_ray[metrik->current_index]);
+				}
+			}
+
 			if (show_graphs) {
 
 				UI::shift_cursor_pos(0, 10);
@@ -536,18 +669,45 @@ namespace GLT::UI {
 
 					UI::end_table();
 				}
+
+				auto& resolution_settings = application::get().get_renderer()->get_dynamic_resolution_ref().get_settings_ref();
+				ImGui::Checkbox("dynamic resolution", &resolution_settings.enabled);
+				if (resolution_settings.enabled && UI::begin_table("dynamic_resolution_settings", false, ImVec2(200.0f, 0))) {
+
+					UI::table_row_slider<f32>("min scale", resolution_settings.min_scale, render::dynamic_resolution::LOWEST_SCALE, render::dynamic_resolution::HIGHEST_SCALE);
+					UI::table_row_slider<f32>("max scale", resolution_settings.max_scale, render::dynamic_resolution::LOWEST_SCALE, render::dynamic_resolution::HIGHEST_SCALE);
+					UI::end_table();
+				}
 				ImGui::Checkbox("show progress bars", &show_progress_bars);
 				ImGui::Checkbox("show FPS graph", &show_graph);
 
 				ImGui::SeparatorText("Renderer Performance");
 				ImGui::Checkbox("show timing graphs", &show_graphs);
+
+				auto& traversal_stats = application::get().get_renderer()->get_traversal_stats_ref();
+				ImGui::Checkbox("traversal statistics", &traversal_stats.enabled);
+				if (traversal_stats.enabled) {
+
+					ImGui::Checkbox("show heatmap", &traversal_stats.show_heatmap);
+					if (UI::begin_table("traversal_stats_settings", false, ImVec2(200.0f, 0))) {
+
+						UI::table_row_drag_scalar<u32>("heatmap max", traversal_stats.heatmap_max, "%u", 1, 10000);
+						UI::end_table();
+					}
+					if (ImGui::Button("export heatmap")) {
+
+						const system_time time = util::get_system_time();
+						const std::string file_name = std::format("traversal_heatmap_{}-{:02}-{:02}_{:02}-{:02}-{:02}.png", time.year, time.month, time.day, time.hour, time.minute, time.secund);
+						auto renderer = application::get().get_renderer();
+						renderer->enqueue([renderer, file = util::get_executable_path().parent_path() / "captures" / file_name] { renderer->export_traversal_heatmap(file); });
+					}
+				}
 				UI::next_window_position_selector(renderer_metrik_window_location, m_show_renderer_metrik);
 
 				ImGui::EndPopup();
 			}
 		}
 		ImGui::End();
-#endif
 	}
 
 
@@ -610,6 +770,10 @@ namespace GLT::UI {
 
 				UI::table_row_text("FPS", formatted_text);
 
+				const auto& resolution = application::get().get_renderer()->get_dynamic_resolution_ref();
+				if (resolution.get_settings().enabled || resolution.get_scale() != 1.f)
+					UI::table_row_text("render scale", "%3.0f %%", resolution.get_scale() * 100.f);
+
 				if (show_progress_bars) {
 					snprintf(formatted_text, sizeof(formatted_text), "%5.2f ms", m_work_time);
 					UI::table_row_progressbar("work time:", formatted_text, work_percent);
@@ -618,6 +782,13 @@ namespace GLT::UI {
 					UI::table_row_progressbar("sleep time:", formatted_text, sleep_percent);
 				}
 
+				// the main thread builds the next frame while the render thread draws this one, the slower of both sets the frame rate
+				const auto* metrik = application::get().get_renderer()->get_general_performance_metrik_pointer();
+				UI::table_row_text("simulation", "%5.2f ms", metrik->CPU_simulation_time);
+				UI::table_row_text("UI", "%5.2f ms", metrik->CPU_UI_time);
+				UI::table_row_text("wait for render", "%5.2f ms", metrik->CPU_wait_time);
+				UI::table_row_text("render thread", "%5.2f ms", metrik->CPU_render_time);
+				UI::table_row_text("present", "%5.2f ms", metrik->CPU_present_time);
 
 				UI::end_table();
 			}
@@ -679,6 +850,15 @@ namespace GLT::UI {
 					UI::end_table();
 				}
 
+				auto& resolution_settings = application::get().get_renderer()->get_dynamic_resolution_ref().get_settings_ref();
+				ImGui::Checkbox("dynamic resolution", &resolution_settings.enabled);
+				if (resolution_settings.enabled && UI::begin_table("dynamic_resolution_settings", false, ImVec2(200.0f, 0))) {
+
+					UI::table_row_slider<f32>("min scale", resolution_settings.min_scale, render::dynamic_resolution::LOWEST_SCALE, render::dynamic_resolution::HIGHEST_SCALE);
+					UI::table_row_slider<f32>("max scale", resolution_settings.max_scale, render::dynamic_resolution::LOWEST_SCALE, render::dynamic_resolution::HIGHEST_SCALE);
+					UI::end_table();
+				}
+
 				ImGui::Checkbox("show progress bars", &show_progress_bars);
 				ImGui::Checkbox("show FPS graph", &show_graph);
 
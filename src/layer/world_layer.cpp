@@ -27,6 +27,7 @@ namespace GLT {
 	// ============= DEV-ONLY =============
 	static ref<GLT::geometry::static_mesh> MAIN_RENDER_MESH = create_ref<GLT::geometry::static_mesh>();
 	ref<GLT::geometry::static_mesh> world_layer::GET_RENDER_MESH() { return MAIN_RENDER_MESH; }
+	void world_layer::SET_RENDER_MESH(ref<GLT::geometry::static_mesh> mesh) { MAIN_RENDER_MESH = mesh; }
 	// ============= DEV-ONLY =============
 	
 	// ============= TODO: move to editor layer =============
@@ -53,6 +53,7 @@ namespace GLT {
 
 		// ============= DEV-ONLY =============
 		ref<GLT::geometry::static_mesh> GET_RENDER_MESH();
+		void SET_RENDER_MESH(ref<GLT::geometry::static_mesh> mesh);
 		void serialize(const serializer::option option);
 		// ============= DEV-ONLY =============
 
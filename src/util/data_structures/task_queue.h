@@ -0,0 +1,107 @@
+#pragma once
+
+
+namespace GLT::util {
+
+    // @brief Lock-free queue of small tasks, any thread pushes and one thread runs them at a fixed point of its frame (multi producer, single consumer).
+    //        Bounded ring of [CAPACITY] cells with a sequence number per cell (Vyukov), producers claim a cell with one CAS and publish it
+    //        with a release store, the consumer needs no atomic read-modify-write at all.
+    //        Tasks are constructed in place in the preallocated storage of their cell, unlike std::function nothing is allocated on push.
+    //        Captures bigger than [TASK_SIZE] do not compile, capture a pointer to bigger data instead
+    template<u32 CAPACITY, u32 TASK_SIZE = 64>
+    class task_queue {
+    public:
+
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity has to be a power of two");
+
+        task_queue() {
+
+            for (u64 x = 0; x < CAPACITY; x++)
+                m_cells[x].sequence.store(x, std::memory_order_relaxed);
+        }
+
+        ~task_queue() { consume(false, std::numeric_limits<u64>::max()); }         // tasks nobody ran are destroyed
+
+        DELETE_COPY_CONSTRUCTOR(task_queue);
+
+        // @brief Any thread: adds [task], a callable without arguments
+        // @return False if the queue is full, [task] is dropped
+        template<typename task_type>
+        [[nodiscard]] bool push(task_type&& task) {
+
+            using stored_type = std::decay_t<task_type>;
+            static_assert(sizeof(stored_type) <= TASK_SIZE, "captures of the task are too big for the preallocated storage");
+            static_assert(alignof(stored_type) <= alignof(std::max_align_t), "task needs a stronger alignment than the storage has");
+
+            cell* target = nullptr;
+            u64 position = m_push_position.load(std::memory_order_relaxed);
+            while (true) {
+
+                target = &m_cells[position & (CAPACITY - 1)];
+                const u64 sequence = target->sequence.load(std::memory_order_acquire);
+                const int64 difference = static_cast<int64>(sequence) - static_cast<int64>(position);
+                if (difference == 0) {
+                    if (m_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;                                                      // cell claimed
+                } else if (difference < 0)
+                    return false;                                                   // the consumer did not free this cell yet
+                else
+                    position = m_push_position.load(std::memory_order_relaxed);     // another producer claimed it
+            }
+
+            new (target->storage) stored_type(std::forward<task_type>(task));
+            target->invoke = [](void* storage, const bool run) {
+
+                stored_type* stored = static_cast<stored_type*>(storage);
+                if (run)
+                    (*stored)();
+                stored->~stored_type();
+            };
+            target->sequence.store(position + 1, std::memory_order_release);       // publish
+            return true;
+        }
+
+        // @brief Consumer thread: runs the tasks pushed before this call in the order they were claimed.
+        //        Tasks pushed by the tasks themselves wait for the next drain() so a frame cannot be starved, a running task may call drain() itself
+        // @return Number of tasks that ran
+        u32 drain() { return drain(get_push_position()); }
+
+        // @brief Consumer thread: runs the tasks claimed before get_push_position() returned [end], used to tie tasks to a later point
+        // @return Number of tasks that ran
+        u32 drain(const u64 end) { return consume(true, end); }
+
+        // @brief Any thread: position after the last claimed task
+        u64 get_push_position() const { return m_push_position.load(std::memory_order_acquire); }
+
+    private:
+
+        struct cell {
+            std::atomic<u64>                sequence{0};                            // == position: free, == position + 1: holds the task of [position]
+            void                            (*invoke)(void* storage, const bool run) = nullptr;
+            alignas(std::max_align_t) std::byte storage[TASK_SIZE];
+        };
+
+        u32 consume(const bool run, const u64 end) {
+
+            u32 count = 0;
+            while (m_pop_position < end) {
+
+                const u64 position = m_pop_position;
+                cell& target = m_cells[position & (CAPACITY - 1)];
+                if (target.sequence.load(std::memory_order_acquire) != position + 1)
+                    break;                                                          // empty, or claimed and not published yet
+
+                m_pop_position++;                                                   // before running, the task may drain the following ones itself
+                target.invoke(target.storage, run);
+                target.sequence.store(position + CAPACITY, std::memory_order_release);           // free for the next round of the ring
+                count++;
+            }
+            return count;
+        }
+
+        std::array<cell, CAPACITY>          m_cells{};
+        alignas(64) std::atomic<u64>        m_push_position{0};                     // own cache line, producers contend on it
+        alignas(64) u64                     m_pop_position = 0;                     // consumer only
+    };
+
+}
@@ -0,0 +1,152 @@
+
+#include "util/pch.h"
+
+#include "image_writer.h"
+
+namespace GLT::io {
+
+	// ================================================== helpers ==================================================
+
+	static u32 crc_table[256];
+	static std::once_flag crc_table_flag;
+
+	static void build_crc_table() {
+
+		for (u32 n = 0; n < 256; n++) {
+
+			u32 c = n;
+			for (u32 k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			crc_table[n] = c;
+		}
+	}
+
+	static u32 update_crc(u32 crc, const u8* data, const size_t length) {
+
+		for (size_t x = 0; x < length; x++)
+			crc = crc_table[(crc ^ data[x]) & 0xFF] ^ (crc >> 8);
+		return crc;
+	}
+
+	static void push_u32_big_endian(std::vector<u8>& buffer, const u32 value) {
+
+		buffer.push_back(static_cast<u8>(value >> 24));
+		buffer.push_back(static_cast<u8>(value >> 16));
+		buffer.push_back(static_cast<u8>(value >> 8));
+		buffer.push_back(static_cast<u8>(value));
+	}
+
+	static void write_chunk(std::ofstream& file, const char* type, const std::vector<u8>& data) {
+
+		std::vector<u8> header{};
+		push_u32_big_endian(header, static_cast<u32>(data.size()));
+		header.insert(header.end(), type, type + 4);
+		file.write(reinterpret_cast<const char*>(header.data()), header.size());
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		u32 crc = update_crc(0xFFFFFFFFu, reinterpret_cast<const u8*>(type), 4);
+		crc = update_crc(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+		std::vector<u8> footer{};
+		push_u32_big_endian(footer, crc);
+		file.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+	}
+
+	// ================================================== public ==================================================
+
+	image_format image_format_from_string(const std::string& format) {
+
+		std::string lower = format;
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (lower == "ppm" || lower == ".ppm")
+			return image_format::PPM;
+
+		if (lower != "png" && lower != ".png")
+			LOG(Warn, "Unknown image format [" << format << "], falling back to PNG");
+
+		return image_format::PNG;
+	}
+
+	const char* image_format_extension(const image_format format) {
+
+		switch (format) {
+			case image_format::PPM:     return ".ppm";
+			default:
+			case image_format::PNG:     return ".png";
+		}
+	}
+
+	bool write_PPM(const std::filesystem::path& file_path, const image& image) {
+
+		std::ofstream file{ file_path, std::ios::binary };
+		VALIDATE(file.is_open(), return false, "", "Failed to open file for writing at: " << file_path.generic_string());
+
+		file << "P6\n" << image.width << " " << image.height << "\n255\n";
+		file.write(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size());
+		return file.good();
+	}
+
+	bool write_PNG(const std::filesystem::path& file_path, const image& image) {
+
+		std::call_once(crc_table_flag, build_crc_table);
+
+		std::ofstream file{ file_path, std::ios::binary };
+		VALIDATE(file.is_open(), return false, "", "Failed to open file for writing at: " << file_path.generic_string());
+
+		static const u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+		std::vector<u8> header{};
+		push_u32_big_endian(header, image.width);
+		push_u32_big_endian(header, image.height);
+		header.insert(header.end(), { 8, 2, 0, 0, 0 });					// bit depth 8, color type RGB, default compression/filter, no interlace
+		write_chunk(file, "IHDR", header);
+
+		// raw scanlines, each prefixed with filter type 0 (none)
+		const size_t row_size = static_cast<size_t>(image.width) * 3;
+		std::vector<u8> raw{};
+		raw.reserve((row_size + 1) * image.height);
+		for (u32 y = 0; y < image.height; y++) {
+
+			raw.push_back(0);
+			raw.insert(raw.end(), image.pixels.begin() + y * row_size, image.pixels.begin() + (y + 1) * row_size);
+		}
+
+		// zlib stream made of stored deflate blocks
+		std::vector<u8> compressed{};
+		compressed.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+		compressed.insert(compressed.end(), { 0x78, 0x01 });
+		u32 adler_a = 1, adler_b = 0;
+		size_t offset = 0;
+		do {
+			const u16 block_size = static_cast<u16>(std::min<size_t>(raw.size() - offset, 65535));
+			const bool last_block = (offset + block_size) == raw.size();
+			compressed.push_back(last_block ? 1 : 0);
+			compressed.push_back(static_cast<u8>(block_size));
+			compressed.push_back(static_cast<u8>(block_size >> 8));
+			compressed.push_back(static_cast<u8>(~block_size));
+			compressed.push_back(static_cast<u8>(~block_size >> 8));
+			compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + block_size);
+
+			for (size_t x = offset; x < offset + block_size; x++) {
+				adler_a = (adler_a + raw[x]) % 65521;
+				adler_b = (adler_b + adler_a) % 65521;
+			}
+			offset += block_size;
+		} while (offset < raw.size());
+		push_u32_big_endian(compressed, (adler_b << 16) | adler_a);
+		write_chunk(file, "IDAT", compressed);
+
+		write_chunk(file, "IEND", {});
+		return file.good();
+	}
+
+	bool write_image(const std::filesystem::path& file_path, const image& image, const image_format format) {
+
+		switch (format) {
+			case image_format::PPM:     return write_PPM(file_path, image);
+			default:
+			case image_format::PNG:     return write_PNG(file_path, image);
+		}
+	}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+
+namespace GLT::io {
+
+	enum class image_format : u8 {
+		PNG,
+		PPM,
+	};
+
+	// @brief Simple 8-bit RGB image, rows are stored top to bottom without padding
+	struct image {
+
+		u32					width = 0;
+		u32					height = 0;
+		std::vector<u8>		pixels{};					// width * height * 3 bytes
+
+		void resize(const u32 new_width, const u32 new_height) { width = new_width; height = new_height; pixels.resize(static_cast<size_t>(width) * height * 3); }
+	};
+
+	// @brief Converts a string like "png" or "PPM" into an [image_format], unknown strings fall back to PNG
+	image_format image_format_from_string(const std::string& format);
+
+	// @brief Returns the file extension (including the dot) that matches the [format]
+	const char* image_format_extension(const image_format format);
+
+	// @brief Writes the image as binary PPM (P6), no compression but trivial to diff in regression tests
+	// @param [file_path] The path to the file to be written.
+	// @param [image] The image to write.
+	// @return [bool] true if the file is successfully written, false otherwise.
+	bool write_PPM(const std::filesystem::path& file_path, const image& image);
+
+	// @brief Writes the image as PNG, uses stored (uncompressed) deflate blocks to avoid a zlib dependency
+	// @param [file_path] The path to the file to be written.
+	// @param [image] The image to write.
+	// @return [bool] true if the file is successfully written, false otherwise.
+	bool write_PNG(const std::filesystem::path& file_path, const image& image);
+
+	// @brief Writes the image in the requested [format]
+	bool write_image(const std::filesystem::path& file_path, const image& image, const image_format format);
+
+}
@@ -0,0 +1,327 @@
+#include "util/pch.h"
+
+#include <bit>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <Windows.h>
+#elif defined(PLATFORM_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include "job_system.h"
+
+
+namespace GLT::jobs {
+
+    constexpr u32 DEQUE_CAPACITY = 4096;            // per thread, a full deque runs new jobs right away
+    constexpr u64 BATCHES_PER_THREAD = 4;           // parallel_for() batches, leaves room for uneven batch costs
+
+    // @brief Chase-Lev deque with a fixed ring (Lê, Pop, Cohen, Zappa Nardelli 2013). The owner pushes and pops at the bottom,
+    //        any thread steals at the top, only the last element needs a CAS between the owner and thieves
+    class work_stealing_deque {
+    public:
+
+        bool push(job* new_job) {
+
+            const int64 bottom = m_bottom.load(std::memory_order_relaxed);
+            const int64 top = m_top.load(std::memory_order_acquire);
+            if (bottom - top >= static_cast<int64>(DEQUE_CAPACITY))
+                return false;
+
+            m_jobs[bottom & (DEQUE_CAPACITY - 1)].store(new_job, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_release);         // publishes the job to thieves
+            return true;
+        }
+
+        job* pop() {
+
+            const int64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64 top = m_top.load(std::memory_order_relaxed);
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);     // empty
+                return nullptr;
+            }
+
+            job* found = m_jobs[bottom & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (top == bottom) {                                            // last one, a thief may take it at the same time
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    found = nullptr;
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return found;
+        }
+
+        job* steal() {
+
+            int64 top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64 bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+                return nullptr;
+
+            job* found = m_jobs[top & (DEQUE_CAPACITY - 1)].load(std::memory_order_acquire);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;                                             // lost against the owner or another thief
+            return found;
+        }
+
+    private:
+
+        alignas(64) std::atomic<int64>      m_top{0};
+        alignas(64) std::atomic<int64>      m_bottom{0};
+        std::array<std::atomic<job*>, DEQUE_CAPACITY> m_jobs{};
+    };
+
+    // the thread calling init() owns deque 0, worker x owns deque x + 1
+    static std::vector<std::unique_ptr<work_stealing_deque>>    s_deques{};
+    static std::vector<std::thread>                             s_workers{};
+    static std::mutex                                           s_shared_mutex{};
+    static std::deque<job*>                                     s_shared_jobs{};        // submitted by threads without a deque
+    static std::atomic<u32>                                     s_shared_job_count{0};  // size of [s_shared_jobs], looked at without the lock
+    static std::atomic<u32>                                     s_work_signal{0};       // changes whenever a job is queued, idle workers wait on it
+    static std::atomic<bool>                                    s_running = false;
+    static std::atomic<bool>                                    s_stop = false;
+    static std::thread::id                                      s_main_thread{};        // kept after shutdown(), posted tasks still belong to it
+    static util::task_queue<MAIN_THREAD_TASK_CAPACITY>          s_main_thread_tasks{};
+    static thread_local work_stealing_deque*                    t_deque = nullptr;
+    static thread_local u32                                     t_thread_index = 0;
+
+
+    static void set_affinity(const u64 core_mask) {
+
+        if (core_mask == 0)
+            return;
+
+#if defined(PLATFORM_WINDOWS)
+        VALIDATE(SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(core_mask)) != 0, , "", "Could not set the affinity of a job worker");
+#elif defined(PLATFORM_LINUX)
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        for (u32 x = 0; x < 64; x++)
+            if (core_mask & (u64(1) << x))
+                CPU_SET(x, &cores);
+        VALIDATE(pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) == 0, , "", "Could not set the affinity of a job worker");
+#endif
+    }
+
+    // @brief [index]th set bit of [core_mask], wrapping around
+    static u64 get_core(const u64 core_mask, const u32 index) {
+
+        const u32 core_count = static_cast<u32>(std::popcount(core_mask));
+        u32 remaining = index % core_count;
+        for (u32 x = 0; x < 64; x++) {
+            if (!(core_mask & (u64(1) << x)))
+                continue;
+            if (remaining-- == 0)
+                return u64(1) << x;
+        }
+        return core_mask;
+    }
+
+    static job* find_job() {
+
+        if (t_deque)
+            if (job* found = t_deque->pop())
+                return found;
+
+        if (s_shared_job_count.load(std::memory_order_acquire) > 0) {
+
+            std::lock_guard<std::mutex> lock(s_shared_mutex);
+            if (!s_shared_jobs.empty()) {
+                job* found = s_shared_jobs.front();
+                s_shared_jobs.pop_front();
+                s_shared_job_count.fetch_sub(1, std::memory_order_relaxed);
+                return found;
+            }
+        }
+
+        // start after the own deque so thieves spread over the victims
+        const u32 deque_count = static_cast<u32>(s_deques.size());
+        for (u32 x = 1; x <= deque_count; x++) {
+
+            work_stealing_deque* victim = s_deques[(t_thread_index + x) % deque_count].get();
+            if (victim == t_deque)
+                continue;
+            if (job* found = victim->steal())
+                return found;
+        }
+        return nullptr;
+    }
+
+    static void worker_loop(const u32 index, const u64 core_mask) {
+
+        t_thread_index = index;
+        t_deque = s_deques[index].get();
+        set_affinity(core_mask);
+        logger::register_label_for_thread("job worker " + std::to_string(index));
+
+        while (true) {
+
+            if (job* found = find_job()) {
+                found->execute();
+                continue;
+            }
+
+            // read the signal before looking again, a job queued after the last look changes it and wait() returns immediately
+            const u32 signal = s_work_signal.load(std::memory_order_acquire);
+            if (job* found = find_job()) {
+                found->execute();
+                continue;
+            }
+            if (s_stop.load(std::memory_order_acquire))
+                break;
+            s_work_signal.wait(signal, std::memory_order_acquire);
+        }
+
+        logger::unregister_label_for_thread();
+    }
+
+
+    void init(const settings& new_settings) {
+
+        VALIDATE(!s_running, return, "", "Job system is already running");
+
+        const u32 hardware_threads = math::max(std::thread::hardware_concurrency(), 1u);
+        const u32 worker_count = new_settings.worker_count ? new_settings.worker_count : hardware_threads - 1;
+        const u64 core_mask = new_settings.core_mask ? new_settings.core_mask : (hardware_threads >= 64 ? ~u64(0) : (u64(1) << hardware_threads) - 1);
+
+        s_stop = false;
+        s_deques.clear();
+        for (u32 x = 0; x <= worker_count; x++)
+            s_deques.emplace_back(std::make_unique<work_stealing_deque>());
+        t_deque = s_deques[0].get();
+        t_thread_index = 0;
+        s_main_thread = std::this_thread::get_id();
+
+        s_workers.reserve(worker_count);
+        for (u32 x = 0; x < worker_count; x++)
+            s_workers.emplace_back(&worker_loop, x + 1, new_settings.pin_workers ? get_core(core_mask, x + 1) : new_settings.core_mask);
+
+        s_running = true;
+        LOG(Trace, "Job system started with [" << worker_count << "] workers" << (new_settings.pin_workers ? ", pinned to one core each" : ""))
+    }
+
+
+    void shutdown() {
+
+        if (!s_running)
+            return;
+
+        s_stop = true;
+        s_work_signal.fetch_add(1, std::memory_order_release);
+        s_work_signal.notify_all();
+        for (std::thread& worker : s_workers)
+            worker.join();
+        s_workers.clear();
+
+        // jobs nobody picked up run here, they may still queue more
+        while (job* found = find_job())
+            found->execute();
+
+        s_running = false;
+        t_deque = nullptr;
+        s_deques.clear();
+        LOG(Trace, "Job system stopped")
+    }
+
+
+    bool is_running() { return s_running.load(std::memory_order_acquire); }
+
+
+    u32 get_thread_count() { return is_running() ? static_cast<u32>(s_deques.size()) : 1; }
+
+
+    u64 get_batch_size(const u64 count, const u64 min_batch) {
+
+        const u64 batch_count = static_cast<u64>(get_thread_count()) * BATCHES_PER_THREAD;
+        return math::max((count + batch_count - 1) / batch_count, math::max(min_batch, u64(1)));
+    }
+
+
+    void submit(job* new_job, counter* dependency) {
+
+        if (dependency) {
+
+            std::lock_guard<std::mutex> lock(dependency->m_mutex);
+            if (!dependency->is_done()) {
+                dependency->m_continuations.push_back(new_job);            // queued by the last signal()
+                return;
+            }
+        }
+
+        if (!is_running()) {
+            new_job->execute();
+            return;
+        }
+
+        if (t_deque) {
+            if (!t_deque->push(new_job)) {
+                new_job->execute();                                         // deque is full, running it now keeps the memory bounded
+                return;
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(s_shared_mutex);
+            s_shared_jobs.push_back(new_job);
+            s_shared_job_count.fetch_add(1, std::memory_order_release);
+        }
+
+        s_work_signal.fetch_add(1, std::memory_order_release);
+        s_work_signal.notify_one();
+    }
+
+
+    void wait(counter& done) {
+
+        while (!done.is_done()) {
+
+            if (job* found = is_running() ? find_job() : nullptr)
+                found->execute();
+            else
+                std::this_thread::yield();                                  // the remaining jobs run on other threads
+        }
+
+        // the last signal() may still be queuing continuations, [done] can go out of scope once it released the lock
+        std::lock_guard<std::mutex> lock(done.m_mutex);
+    }
+
+
+    bool is_main_thread() { return s_main_thread == std::thread::id() || s_main_thread == std::this_thread::get_id(); }
+
+
+    u32 run_main_thread_tasks() { return s_main_thread_tasks.drain(); }
+
+
+    util::task_queue<MAIN_THREAD_TASK_CAPACITY>& get_main_thread_queue() { return s_main_thread_tasks; }
+
+
+    void counter::signal() {
+
+        std::vector<job*> continuations{};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            continuations.swap(m_continuations);
+        }
+
+        for (job* continuation : continuations)
+            submit(continuation);
+    }
+
+
+    void job::execute() {
+
+        m_invoke(m_storage, true);
+        m_invoke = nullptr;
+
+        counter* signal = m_signal;
+        if (m_owned)
+            delete this;
+        if (signal)
+            signal->signal();
+    }
+
+}
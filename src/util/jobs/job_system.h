@@ -0,0 +1,186 @@
+#pragma once
+
+#include "util/data_structures/task_queue.h"
+
+
+// Worker threads shared by every subsystem, heavy work is split into jobs instead of starting threads per call.
+// Every worker owns a work-stealing deque: it pushes and pops its own jobs at the bottom (newest first, cache warm),
+// idle workers steal the oldest jobs from the top of the others. The thread calling init() owns a deque as well,
+// other threads submit through a shared queue. Threads waiting for jobs run other jobs meanwhile (wait()), so jobs
+// may wait for jobs they started without blocking a core.
+// Until init() and after shutdown() everything runs on the calling thread.
+// Work that has to happen on the main thread (window, renderer calls) is posted to it and runs in run_main_thread_tasks() once per frame.
+namespace GLT::jobs {
+
+    constexpr u32 MAIN_THREAD_TASK_CAPACITY = 1024;
+
+    class counter;
+    class job;
+
+    struct settings {
+        u32 worker_count = 0;                                       // 0 => one per hardware thread, except the one of the calling thread
+        u64 core_mask = 0;                                          // cores the workers may run on, 0 => all
+        bool pin_workers = false;                                   // every worker only runs on one core of [core_mask], the first core is left to the main thread
+    };
+
+    // @brief Starts the workers, call once from the main thread
+    void init(const settings& new_settings = {});
+    // @brief Runs the jobs still queued and joins the workers
+    void shutdown();
+
+    bool is_running();
+
+    // @brief Threads working on a parallel_for(): the workers and the calling thread
+    u32 get_thread_count();
+
+    // @brief Queues [new_job] once [dependency] (if given) is done. Jobs of a worker go to its own deque
+    void submit(job* new_job, counter* dependency = nullptr);
+
+    // @brief Runs other jobs until [done] reached zero, the calling thread never sleeps on work it could do itself
+    void wait(counter& done);
+
+    // @brief The thread that called init(), before init() any thread counts as main thread
+    bool is_main_thread();
+
+    // @brief Main thread: runs the tasks posted before this call, called once per frame by the application
+    // @return Number of tasks that ran
+    u32 run_main_thread_tasks();
+
+    util::task_queue<MAIN_THREAD_TASK_CAPACITY>& get_main_thread_queue();
+
+    // @brief Any thread: runs [task] on the main thread in its next run_main_thread_tasks().
+    //        Waits for room if the queue is full, on the main thread itself the queued tasks run first
+    template<typename func>
+    void post_to_main_thread(func&& task) {
+
+        while (!get_main_thread_queue().push(std::forward<func>(task))) {  // a failed push leaves [task] untouched
+            if (is_main_thread())
+                run_main_thread_tasks();
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    // @brief Number of unfinished jobs signaling it. Jobs waiting on a counter (dependencies) are queued when it reaches zero.
+    //        Has to outlive its jobs, wait() for it before it goes out of scope
+    class counter {
+    public:
+
+        counter() = default;
+        ~counter() = default;
+
+        DELETE_COPY_CONSTRUCTOR(counter);
+
+        FORCEINLINE bool is_done() const                                    { return m_value.load(std::memory_order_acquire) == 0; }
+
+        // @brief Announces [count] more jobs signaling this counter, done by run() for the job it starts
+        FORCEINLINE void add(const u32 count = 1)                           { m_value.fetch_add(count, std::memory_order_relaxed); }
+
+        // @brief One of the jobs finished, queues the dependent jobs once it was the last
+        void signal();
+
+    private:
+
+        friend void submit(job* new_job, counter* dependency);
+        friend void wait(counter& done);
+
+        std::atomic<u32>                    m_value{0};
+        std::mutex                          m_mutex{};                          // guards [m_continuations] and the last signal()
+        std::vector<job*>                   m_continuations{};
+    };
+
+    // @brief A callable without arguments stored in place (no allocation besides the job itself), optionally signaling a counter when it finished
+    class job {
+    public:
+
+        static constexpr u32                STORAGE_SIZE = 64;
+
+        template<typename func>
+        job(func&& function, counter* signal, const bool owned)
+            : m_signal(signal), m_owned(owned) {
+
+            using stored_type = std::decay_t<func>;
+            static_assert(sizeof(stored_type) <= STORAGE_SIZE, "captures of the job are too big for its storage, capture a pointer to them instead");
+            static_assert(alignof(stored_type) <= alignof(std::max_align_t), "job needs a stronger alignment than its storage has");
+
+            new (m_storage) stored_type(std::forward<func>(function));
+            m_invoke = [](void* storage, const bool run) {
+
+                stored_type* stored = static_cast<stored_type*>(storage);
+                if (run)
+                    (*stored)();
+                stored->~stored_type();
+            };
+        }
+
+        ~job() { if (m_invoke) m_invoke(m_storage, false); }
+
+        DELETE_COPY_CONSTRUCTOR(job);
+
+        // @brief Runs the callable, deletes an owned job and signals the counter. The job must not be touched afterwards
+        void execute();
+
+    private:
+
+        void                                (*m_invoke)(void* storage, const bool run) = nullptr;
+        counter*                            m_signal = nullptr;
+        bool                                m_owned = false;                    // created by run(), deleted after it ran
+        alignas(std::max_align_t) std::byte m_storage[STORAGE_SIZE];
+    };
+
+    // @brief Runs [function] on any thread once [dependency] (if given) is done, [signal] (if given) is done when it returned
+    template<typename func>
+    void run(func&& function, counter* signal = nullptr, counter* dependency = nullptr) {
+
+        if (signal)
+            signal->add();
+        submit(new job(std::forward<func>(function), signal, true), dependency);
+    }
+
+    // @brief Number of elements per batch for [count] elements, enough batches for every thread to steal some but none smaller than [min_batch]
+    u64 get_batch_size(const u64 count, const u64 min_batch);
+
+    // @brief Calls [body(first, end)] for batches of [0, count) on all threads and returns when every batch is done, the calling thread helps
+    template<typename func>
+    void parallel_for(const u64 count, const u64 min_batch, func&& body) {
+
+        if (count == 0)
+            return;
+
+        const u64 batch_size = get_batch_size(count, min_batch);
+        if (batch_size >= count || !is_running()) {
+            body(0, count);
+            return;
+        }
+
+        counter done{};
+        for (u64 first = batch_size; first < count; first += batch_size)
+            run([&body, first, end = math::min(first + batch_size, count)] { body(first, end); }, &done);
+
+        body(0, batch_size);                                            // first batch on the calling thread, the others are stolen meanwhile
+        wait(done);
+    }
+
+    // @brief [map(first, end)] for batches of [0, count) on all threads, the results are combined with [reduce(a, b)] in batch order,
+    //        so the result does not depend on the thread count for a fixed batch size
+    template<typename T, typename map_func, typename reduce_func>
+    T parallel_reduce(const u64 count, const u64 min_batch, const T& identity, map_func&& map, reduce_func&& reduce) {
+
+        if (count == 0)
+            return identity;
+
+        const u64 batch_size = get_batch_size(count, min_batch);
+        std::vector<T> results((count + batch_size - 1) / batch_size, identity);
+        parallel_for(count, batch_size, [&](const u64 first, const u64 end) {
+
+            for (u64 batch_first = first; batch_first < end; batch_first += batch_size)     // parallel_for may merge batches if it is not running
+                results[batch_first / batch_size] = map(batch_first, math::min(batch_first + batch_size, end));
+        });
+
+        T result = identity;
+        for (const T& batch_result : results)
+            result = reduce(result, batch_result);
+        return result;
+    }
+
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+
+#include "job_system.h"
+
+
+// Coroutines on top of the job system, multi step work is written as one function that moves between threads:
+//
+//     jobs::task<ref<mesh>> load(path) {
+//         co_await jobs::on_worker();              // read and decode on any worker
+//         ...
+//         co_return mesh;
+//     }
+//     jobs::task<> replace(path) {
+//         ref<mesh> loaded = co_await load(path);  // resumes when [load] returned, on the thread that finished it
+//         co_await jobs::on_main_thread();         // next run_main_thread_tasks() of the application
+//         ...
+//     }
+//     jobs::spawn(replace(path));
+//
+// A task starts when it is awaited (or spawned) and runs on the awaiting thread until it awaits something itself.
+namespace GLT::jobs {
+
+    template<typename T = void>
+    class task;
+
+    namespace detail {
+
+        struct promise_base {
+
+            // the awaiting coroutine continues on the thread that finished this one, without going through a queue
+            struct final_awaiter {
+                bool await_ready() const noexcept { return false; }
+
+                template<typename promise_type>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+
+                    const std::coroutine_handle<> continuation = handle.promise().m_continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            final_awaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+            std::coroutine_handle<>         m_continuation{};
+            std::exception_ptr              m_exception{};
+        };
+
+        template<typename T>
+        struct promise : promise_base {
+
+            task<T> get_return_object() noexcept;
+
+            template<typename value_type>
+            void return_value(value_type&& value) { m_value.emplace(std::forward<value_type>(value)); }
+
+            T get_result() {
+
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+                return std::move(*m_value);
+            }
+
+            std::optional<T>                m_value{};
+        };
+
+        template<>
+        struct promise<void> : promise_base {
+
+            task<void> get_return_object() noexcept;
+
+            void return_void() const noexcept {}
+
+            void get_result() {
+
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+            }
+        };
+
+        // @brief Fire and forget coroutine behind spawn(), frees itself when it finished
+        struct detached_task {
+            struct promise_type {
+                detached_task get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+
+                void unhandled_exception() const noexcept {
+
+                    try {
+                        throw;
+                    } catch (const std::exception& exception) {
+                        LOG(Error, "Spawned task failed: " << exception.what())
+                    } catch (...) {
+                        LOG(Error, "Spawned task failed with an unknown exception")
+                    }
+                }
+            };
+        };
+
+    }
+
+    // @brief Lazily started coroutine producing a [T], await it with co_await from another coroutine or start it with spawn().
+    //        Exceptions leaving the coroutine are rethrown at the co_await
+    template<typename T>
+    class [[nodiscard]] task {
+    public:
+
+        using promise_type = detail::promise<T>;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        task() = default;
+        explicit task(const handle_type handle)
+            : m_handle(handle) {}
+
+        task(task&& other) noexcept
+            : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+        task& operator=(task&& other) noexcept {
+
+            if (this != &other) {
+                if (m_handle)
+                    m_handle.destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~task() {
+
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        DELETE_COPY_CONSTRUCTOR(task);
+
+        // an empty (default constructed or moved from) task has no result to resume with
+        bool await_ready() const {
+
+            ASSERT_S(m_handle);
+            return m_handle.done();
+        }
+
+        // starts the task on this thread, the awaiting coroutine is resumed when it finished
+        std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept {
+
+            m_handle.promise().m_continuation = awaiting;
+            return m_handle;
+        }
+
+        T await_resume() { return m_handle.promise().get_result(); }
+
+    private:
+
+        handle_type                         m_handle{};
+    };
+
+    template<typename T>
+    task<T> detail::promise<T>::get_return_object() noexcept { return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this)); }
+
+    inline task<void> detail::promise<void>::get_return_object() noexcept { return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this)); }
+
+    namespace detail {
+
+        inline detached_task run_detached(task<void> work) { co_await work; }
+
+    }
+
+    // @brief Starts [work] on the calling thread and lets it finish on its own, exceptions are logged
+    inline void spawn(task<void>&& work) { detail::run_detached(std::move(work)); }
+
+    // @brief co_await continues the coroutine as a job on any thread of the job system
+    inline auto on_worker() {
+
+        struct awaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(const std::coroutine_handle<> handle) const { run([handle] { handle.resume(); }); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{};
+    }
+
+    // @brief co_await continues the coroutine on the main thread in its next run_main_thread_tasks(), right away if it already is on it
+    inline auto on_main_thread() {
+
+        struct awaiter {
+            bool await_ready() const noexcept { return is_main_thread(); }
+            void await_suspend(const std::coroutine_handle<> handle) const { post_to_main_thread([handle] { handle.resume(); }); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{};
+    }
+
+}
@@ -0,0 +1,229 @@
+#include "util/pch.h"
+
+#include "sampling.h"
+
+
+namespace GLT::math::sampling {
+
+    // ================================================== Sobol ==================================================
+
+    using direction_numbers = std::array<std::array<u32, 32>, SOBOL_DIMENSIONS>;
+
+    // Joe-Kuo primitive polynomials (degree, coefficients, initial direction numbers), dimension 0 is van der Corput
+    static constexpr direction_numbers generate_direction_numbers() {
+
+        struct polynomial { u32 degree, coefficients, initial[3]; };
+        constexpr polynomial polynomials[SOBOL_DIMENSIONS - 1] = {
+            { 1, 0, { 1, 0, 0 } },
+            { 2, 1, { 1, 3, 0 } },
+            { 3, 1, { 1, 3, 1 } },
+        };
+
+        direction_numbers result{};
+        for (u32 bit = 0; bit < 32; bit++)
+            result[0][bit] = 1u << (31 - bit);
+
+        for (u32 dimension = 1; dimension < SOBOL_DIMENSIONS; dimension++) {
+
+            const polynomial& poly = polynomials[dimension - 1];
+            std::array<u32, 32>& v = result[dimension];
+            for (u32 bit = 0; bit < poly.degree; bit++)
+                v[bit] = poly.initial[bit] << (31 - bit);
+
+            for (u32 bit = poly.degree; bit < 32; bit++) {
+
+                v[bit] = v[bit - poly.degree] ^ (v[bit - poly.degree] >> poly.degree);
+                for (u32 k = 1; k < poly.degree; k++)
+                    v[bit] ^= ((poly.coefficients >> (poly.degree - 1 - k)) & 1u) * v[bit - k];
+            }
+        }
+        return result;
+    }
+
+    static constexpr direction_numbers s_direction_numbers = generate_direction_numbers();
+    static_assert(s_direction_numbers[2][3] == 0x90000000u && s_direction_numbers[3][31] == 0x50050093u, "Sobol direction numbers differ from the table in the shader");
+
+
+    u32 sobol(u32 index, const u32 dimension) {
+
+        u32 result = 0;
+        for (u32 bit = 0; index != 0; index >>= 1, bit++)
+            if (index & 1u)
+                result ^= s_direction_numbers[dimension][bit];
+        return result;
+    }
+
+
+    glm::vec4 sobol_owen(const u32 index, const u32 seed) {
+
+        const u32 shuffled_index = nested_uniform_scramble(index, seed);
+        glm::vec4 result{};
+        for (u32 dimension = 0; dimension < SOBOL_DIMENSIONS; dimension++)
+            result[dimension] = to_unit_float(nested_uniform_scramble(sobol(shuffled_index, dimension), hash_combine(seed, dimension)));
+        return result;
+    }
+
+
+    glm::vec2 sobol_owen_2D(const u32 index, const u32 seed) {
+
+        const u32 shuffled_index = nested_uniform_scramble(index, seed);
+        return glm::vec2(
+            to_unit_float(nested_uniform_scramble(sobol(shuffled_index, 0), hash_combine(seed, 0))),
+            to_unit_float(nested_uniform_scramble(sobol(shuffled_index, 1), hash_combine(seed, 1))));
+    }
+
+    // ================================================== blue noise ==================================================
+
+    constexpr u32 TILE_PIXELS = BLUE_NOISE_TILE_SIZE * BLUE_NOISE_TILE_SIZE;
+    constexpr f32 VOID_AND_CLUSTER_SIGMA = 1.9f;
+    constexpr f32 INITIAL_DENSITY = .1f;
+
+    // Energy of every pixel is the sum of a toroidal gaussian over all set pixels, clusters have high energy and voids low
+    class void_and_cluster {
+    public:
+
+        void_and_cluster() {
+
+            for (u32 y = 0; y < BLUE_NOISE_TILE_SIZE; y++) {
+                for (u32 x = 0; x < BLUE_NOISE_TILE_SIZE; x++) {
+
+                    const f32 dx = static_cast<f32>(math::min(x, BLUE_NOISE_TILE_SIZE - x));
+                    const f32 dy = static_cast<f32>(math::min(y, BLUE_NOISE_TILE_SIZE - y));
+                    m_kernel[y * BLUE_NOISE_TILE_SIZE + x] = std::exp(-(dx * dx + dy * dy) / (2.f * VOID_AND_CLUSTER_SIGMA * VOID_AND_CLUSTER_SIGMA));
+                }
+            }
+        }
+
+        void set(const u32 pixel, const bool value) {
+
+            m_pattern[pixel] = value;
+            const f32 sign = value ? 1.f : -1.f;
+            const u32 px = pixel % BLUE_NOISE_TILE_SIZE, py = pixel / BLUE_NOISE_TILE_SIZE;
+            for (u32 y = 0; y < BLUE_NOISE_TILE_SIZE; y++) {
+
+                const u32 kernel_row = ((y - py) & (BLUE_NOISE_TILE_SIZE - 1)) * BLUE_NOISE_TILE_SIZE;
+                for (u32 x = 0; x < BLUE_NOISE_TILE_SIZE; x++)
+                    m_energy[y * BLUE_NOISE_TILE_SIZE + x] += sign * m_kernel[kernel_row + ((x - px) & (BLUE_NOISE_TILE_SIZE - 1))];
+            }
+        }
+
+        u32 tightest_cluster() const { return find(true, [](const f32 a, const f32 b) { return a > b; }); }
+        u32 largest_void() const { return find(false, [](const f32 a, const f32 b) { return a < b; }); }
+        bool get(const u32 pixel) const { return m_pattern[pixel]; }
+
+    private:
+
+        template<typename compare>
+        u32 find(const bool value, compare&& better) const {
+
+            u32 best = TILE_PIXELS;
+            for (u32 pixel = 0; pixel < TILE_PIXELS; pixel++)
+                if (m_pattern[pixel] == value && (best == TILE_PIXELS || better(m_energy[pixel], m_energy[best])))
+                    best = pixel;
+            return best;
+        }
+
+        std::array<f32, TILE_PIXELS>        m_kernel{};
+        std::array<f32, TILE_PIXELS>        m_energy{};
+        std::array<bool, TILE_PIXELS>       m_pattern{};
+    };
+
+    static_assert((BLUE_NOISE_TILE_SIZE & (BLUE_NOISE_TILE_SIZE - 1)) == 0, "tile wraps with a bit mask");
+
+    static std::array<f32, TILE_PIXELS> generate_blue_noise_tile() {
+
+        // initial pattern: random points relaxed until the tightest cluster is also the largest void
+        void_and_cluster initial{};
+        std::mt19937 generator(1993);
+        const u32 initial_count = static_cast<u32>(TILE_PIXELS * INITIAL_DENSITY);
+        for (u32 count = 0; count < initial_count; ) {
+
+            const u32 pixel = generator() % TILE_PIXELS;
+            if (!initial.get(pixel)) {
+                initial.set(pixel, true);
+                count++;
+            }
+        }
+        for (u32 iteration = 0; iteration < TILE_PIXELS; iteration++) {
+
+            const u32 cluster = initial.tightest_cluster();
+            initial.set(cluster, false);
+            const u32 void_pixel = initial.largest_void();
+            initial.set(void_pixel, true);
+            if (void_pixel == cluster)
+                break;
+        }
+
+        std::array<u32, TILE_PIXELS> rank{};
+
+        // phase 1: ranks below the initial count, removing the tightest clusters
+        void_and_cluster pattern = initial;
+        for (u32 r = initial_count; r-- > 0; ) {
+
+            const u32 pixel = pattern.tightest_cluster();
+            pattern.set(pixel, false);
+            rank[pixel] = r;
+        }
+
+        // phase 2 and 3: filling the largest voids (with a symmetric kernel the largest void of the ones is the tightest cluster of the zeros)
+        pattern = initial;
+        for (u32 r = initial_count; r < TILE_PIXELS; r++) {
+
+            const u32 pixel = pattern.largest_void();
+            pattern.set(pixel, true);
+            rank[pixel] = r;
+        }
+
+        std::array<f32, TILE_PIXELS> tile{};
+        for (u32 pixel = 0; pixel < TILE_PIXELS; pixel++)
+            tile[pixel] = (static_cast<f32>(rank[pixel]) + .5f) / TILE_PIXELS;
+        return tile;
+    }
+
+
+    const std::array<f32, BLUE_NOISE_TILE_SIZE * BLUE_NOISE_TILE_SIZE>& get_blue_noise_tile() {
+
+        static const std::array<f32, TILE_PIXELS> s_tile = generate_blue_noise_tile();
+        return s_tile;
+    }
+
+
+    // golden ratio Weyl sequence in 32 bit fixed point, exact for any frame index and identical on the GPU
+    static FORCEINLINE f32 frame_offset(const u32 frame_index) { return to_unit_float(frame_index * 2654435769u); }
+
+    static FORCEINLINE f32 tile_value(const u32 x, const u32 y) { return get_blue_noise_tile()[(y % BLUE_NOISE_TILE_SIZE) * BLUE_NOISE_TILE_SIZE + (x % BLUE_NOISE_TILE_SIZE)]; }
+
+
+    f32 blue_noise(const u32 x, const u32 y, const u32 frame_index) {
+
+        const f32 value = tile_value(x, y) + frame_offset(frame_index);
+        return value - std::floor(value);
+    }
+
+
+    glm::vec2 blue_noise_2D(const u32 x, const u32 y, const u32 index) {
+
+        constexpr u32 HALF_TILE = BLUE_NOISE_TILE_SIZE / 2;
+        const glm::vec2 value = glm::vec2(tile_value(x, y), tile_value(x + HALF_TILE, y + HALF_TILE)) + glm::vec2(to_unit_float(sobol(index, 0)), to_unit_float(sobol(index, 1)));
+        return value - glm::floor(value);
+    }
+
+
+    glm::vec2 concentric_disk(const glm::vec2 sample) {
+
+        const glm::vec2 offset = sample * 2.f - 1.f;
+        if (offset.x == 0.f && offset.y == 0.f)
+            return glm::vec2(0.f);
+
+        f32 radius, theta;
+        if (std::abs(offset.x) > std::abs(offset.y)) {
+            radius = offset.x;
+            theta = glm::quarter_pi<f32>() * (offset.y / offset.x);
+        } else {
+            radius = offset.y;
+            theta = glm::half_pi<f32>() - glm::quarter_pi<f32>() * (offset.x / offset.y);
+        }
+        return radius * glm::vec2(std::cos(theta), std::sin(theta));
+    }
+
+}
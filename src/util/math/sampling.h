@@ -0,0 +1,81 @@
+#pragma once
+
+
+// Deterministic low-discrepancy samples for stochastic rendering (soft shadows, anti-aliasing, ...).
+// Every function has a twin with the same name and math in [shaders/include/sampling.glsl] so CPU and GPU images agree.
+//   Sobol:      4 dimensional Sobol sequence with hash based Owen scrambling and index shuffling (Burley 2020, "Practical Hash-based Owen Scrambling"),
+//               seeded per pixel, the sample index counts samples over all frames of a progressive render.
+//   Blue noise: 64x64 rank tile made by void-and-cluster (Ulichney 1993). Used as per pixel rotation of the Sobol sequence the error of
+//               neighbouring pixels is spread as high frequency noise, which is the least visible at low sample counts.
+namespace GLT::math::sampling {
+
+    constexpr u32 SOBOL_DIMENSIONS = 4;
+    constexpr u32 BLUE_NOISE_TILE_SIZE = 64;
+
+    // @brief Which generator stochastic effects draw from, values match SAMPLE_PATTERN_* in the shader
+    enum class pattern : u32 {
+        sobol_owen = 0,
+        blue_noise = 1,
+    };
+
+    // @brief Point in [0, 1) of dimension [dimension] (< SOBOL_DIMENSIONS) of the unscrambled Sobol sequence, as 32 bit fixed point
+    u32 sobol(const u32 index, const u32 dimension);
+
+    FORCEINLINE u32 reverse_bits(u32 value) {
+
+        value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+        value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+        value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+        value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+        return (value >> 16) | (value << 16);
+    }
+
+    // @brief Owen scrambling of a 32 bit fixed point value, every bit is flipped depending on all higher bits and [seed]
+    FORCEINLINE u32 nested_uniform_scramble(u32 value, const u32 seed) {
+
+        value = reverse_bits(value);
+        value += seed;                              // Laine-Karras permutation with Burley's improved constants
+        value ^= value * 0x6c50b47cu;
+        value ^= value * 0xb82f1e52u;
+        value ^= value * 0xc7afe638u;
+        value ^= value * 0x8d22f6e6u;
+        return reverse_bits(value);
+    }
+
+    FORCEINLINE u32 hash_combine(const u32 seed, const u32 value) { return seed ^ (value + (seed << 6) + (seed >> 2)); }
+
+    // @brief Well distributed 32 bit hash (PCG output function)
+    FORCEINLINE u32 hash(u32 value) {
+
+        value = value * 747796405u + 2891336453u;
+        value = ((value >> ((value >> 28u) + 4u)) ^ value) * 277803737u;
+        return (value >> 22u) ^ value;
+    }
+
+    FORCEINLINE u32 pixel_seed(const u32 x, const u32 y) { return hash(hash_combine(hash(x), y)); }
+
+    FORCEINLINE f32 to_unit_float(const u32 value) { return static_cast<f32>(value >> 8) * (1.f / 16777216.f); }      // 24 bits, never rounds up to 1
+
+    // @brief Owen-scrambled, shuffled Sobol point of sample [index] for the stream [seed] (usually pixel_seed())
+    glm::vec4 sobol_owen(const u32 index, const u32 seed);
+
+    // @brief 2D version of sobol_owen(), dimension 0 and 1
+    glm::vec2 sobol_owen_2D(const u32 index, const u32 seed);
+
+    // @brief Ranks of the void-and-cluster tile as values in (0, 1), row major, built once on first use (~40ms)
+    const std::array<f32, BLUE_NOISE_TILE_SIZE * BLUE_NOISE_TILE_SIZE>& get_blue_noise_tile();
+
+    // @brief Blue noise value of pixel [x, y] for frame [frame_index], the tile value shifted by frame_index * golden ratio
+    f32 blue_noise(const u32 x, const u32 y, const u32 frame_index);
+
+    // @brief Sobol point [index] (dimension 0 and 1) rotated by two blue noise values of pixel [x, y] (Cranley-Patterson rotation),
+    //        the second value reads the tile shifted by half its size
+    glm::vec2 blue_noise_2D(const u32 x, const u32 y, const u32 index);
+
+    // @brief Point of the unit square for [index] of pixel [x, y] from the selected generator
+    FORCEINLINE glm::vec2 sample_2D(const pattern sample_pattern, const u32 x, const u32 y, const u32 index) { return (sample_pattern == pattern::blue_noise) ? blue_noise_2D(x, y, index) : sobol_owen_2D(index, pixel_seed(x, y)); }
+
+    // @brief Maps a point of the unit square to the unit disk keeping its stratification (Shirley-Chiu concentric mapping)
+    glm::vec2 concentric_disk(const glm::vec2 sample);
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <smmintrin.h>
+#include <immintrin.h>
+
+// Thin traits over scalar/SSE4.1/AVX2 registers so a kernel can be written once as a template and instantiated per instruction set.
+// Every trait provides the same static functions, masks are [mask] (bool for scalar, all-bits-set lanes for vector types).
+// The AVX2 trait is compiled for AVX2/FMA per function, so it can only be used from code that is too (#pragma GCC target("avx2,fma"), see
+// benchmark/intersection_kernels_AVX2.cpp), check [cpu_supports_AVX2()] before calling into it.
+namespace GLT::math::simd {
+
+    template<typename T>
+    struct scalar {
+
+        using scalar_type = T;
+        using type = T;
+        using mask = bool;
+        static constexpr u32 width = 1;
+
+        static FORCEINLINE type set1(const T value)                         { return value; }
+        static FORCEINLINE type load(const T* values)                       { return *values; }
+        static FORCEINLINE void store(T* values, const type a)              { *values = a; }
+        static FORCEINLINE type zero()                                      { return T(0); }
+        static FORCEINLINE type add(const type a, const type b)             { return a + b; }
+        static FORCEINLINE type sub(const type a, const type b)             { return a - b; }
+        static FORCEINLINE type mul(const type a, const type b)             { return a * b; }
+        static FORCEINLINE type div(const type a, const type b)             { return a / b; }
+        static FORCEINLINE type min(const type a, const type b)             { return a < b ? a : b; }
+        static FORCEINLINE type max(const type a, const type b)             { return a > b ? a : b; }
+        static FORCEINLINE type abs(const type a)                           { return a < T(0) ? -a : a; }
+        static FORCEINLINE type select(const type a, const type b, const mask m)    { return m ? b : a; }       // m ? b : a
+        static FORCEINLINE mask lt(const type a, const type b)              { return a < b; }
+        static FORCEINLINE mask le(const type a, const type b)              { return a <= b; }
+        static FORCEINLINE mask gt(const type a, const type b)              { return a > b; }
+        static FORCEINLINE mask ge(const type a, const type b)              { return a >= b; }
+        static FORCEINLINE mask neq(const type a, const type b)             { return a != b; }
+        static FORCEINLINE mask mask_and(const mask a, const mask b)        { return a && b; }
+        static FORCEINLINE mask mask_or(const mask a, const mask b)         { return a || b; }
+        static FORCEINLINE mask mask_not(const mask a)                      { return !a; }
+        static FORCEINLINE mask mask_select(const mask a, const mask b, const mask m)   { return m ? b : a; }
+        static FORCEINLINE int  movemask(const mask m)                      { return m ? 1 : 0; }
+    };
+
+    struct SSE {
+
+        using scalar_type = f32;
+        using type = __m128;
+        using mask = __m128;
+        static constexpr u32 width = 4;
+
+        static FORCEINLINE type set1(const f32 value)                       { return _mm_set1_ps(value); }
+        static FORCEINLINE type load(const f32* values)                     { return _mm_loadu_ps(values); }
+        static FORCEINLINE void store(f32* values, const type a)            { _mm_storeu_ps(values, a); }
+        static FORCEINLINE type zero()                                      { return _mm_setzero_ps(); }
+        static FORCEINLINE type add(const type a, const type b)             { return _mm_add_ps(a, b); }
+        static FORCEINLINE type sub(const type a, const type b)             { return _mm_sub_ps(a, b); }
+        static FORCEINLINE type mul(const type a, const type b)             { return _mm_mul_ps(a, b); }
+        static FORCEINLINE type div(const type a, const type b)             { return _mm_div_ps(a, b); }
+        static FORCEINLINE type min(const type a, const type b)             { return _mm_min_ps(a, b); }
+        static FORCEINLINE type max(const type a, const type b)             { return _mm_max_ps(a, b); }
+        static FORCEINLINE type abs(const type a)                           { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+        static FORCEINLINE type select(const type a, const type b, const mask m)    { return _mm_blendv_ps(a, b, m); }
+        static FORCEINLINE mask lt(const type a, const type b)              { return _mm_cmplt_ps(a, b); }
+        static FORCEINLINE mask le(const type a, const type b)              { return _mm_cmple_ps(a, b); }
+        static FORCEINLINE mask gt(const type a, const type b)              { return _mm_cmpgt_ps(a, b); }
+        static FORCEINLINE mask ge(const type a, const type b)              { return _mm_cmpge_ps(a, b); }
+        static FORCEINLINE mask neq(const type a, const type b)             { return _mm_cmpneq_ps(a, b); }
+        static FORCEINLINE mask mask_and(const mask a, const mask b)        { return _mm_and_ps(a, b); }
+        static FORCEINLINE mask mask_or(const mask a, const mask b)         { return _mm_or_ps(a, b); }
+        static FORCEINLINE mask mask_not(const mask a)                      { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+        static FORCEINLINE mask mask_select(const mask a, const mask b, const mask m)   { return _mm_blendv_ps(a, b, m); }
+        static FORCEINLINE int  movemask(const mask m)                      { return _mm_movemask_ps(m); }
+    };
+
+    #define AVX2_TARGET                                                 __attribute__((target("avx2,fma")))
+
+    struct AVX2 {
+
+        using scalar_type = f32;
+        using type = __m256;
+        using mask = __m256;
+        static constexpr u32 width = 8;
+
+        static FORCEINLINE AVX2_TARGET type set1(const f32 value)                                    { return _mm256_set1_ps(value); }
+        static FORCEINLINE AVX2_TARGET type load(const f32* values)                                  { return _mm256_loadu_ps(values); }
+        static FORCEINLINE AVX2_TARGET void store(f32* values, const type a)                         { _mm256_storeu_ps(values, a); }
+        static FORCEINLINE AVX2_TARGET type zero()                                                   { return _mm256_setzero_ps(); }
+        static FORCEINLINE AVX2_TARGET type add(const type a, const type b)                          { return _mm256_add_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type sub(const type a, const type b)                          { return _mm256_sub_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type mul(const type a, const type b)                          { return _mm256_mul_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type div(const type a, const type b)                          { return _mm256_div_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type min(const type a, const type b)                          { return _mm256_min_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type max(const type a, const type b)                          { return _mm256_max_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET type abs(const type a)                                        { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+        static FORCEINLINE AVX2_TARGET type select(const type a, const type b, const mask m)         { return _mm256_blendv_ps(a, b, m); }
+        static FORCEINLINE AVX2_TARGET mask lt(const type a, const type b)                           { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static FORCEINLINE AVX2_TARGET mask le(const type a, const type b)                           { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static FORCEINLINE AVX2_TARGET mask gt(const type a, const type b)                           { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static FORCEINLINE AVX2_TARGET mask ge(const type a, const type b)                           { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        static FORCEINLINE AVX2_TARGET mask neq(const type a, const type b)                          { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+        static FORCEINLINE AVX2_TARGET mask mask_and(const mask a, const mask b)                     { return _mm256_and_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET mask mask_or(const mask a, const mask b)                      { return _mm256_or_ps(a, b); }
+        static FORCEINLINE AVX2_TARGET mask mask_not(const mask a)                                   { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+        static FORCEINLINE AVX2_TARGET mask mask_select(const mask a, const mask b, const mask m)    { return _mm256_blendv_ps(a, b, m); }
+        static FORCEINLINE AVX2_TARGET int  movemask(const mask m)                                   { return _mm256_movemask_ps(m); }
+    };
+
+    // @brief Runtime check before dispatching to code compiled for AVX2
+    FORCEINLINE bool cpu_supports_AVX2() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+
+}